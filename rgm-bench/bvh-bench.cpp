@@ -0,0 +1,206 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+
+#include "rbench.h"
+#include <rgm/rgm.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+// Building, refitting and querying a BVH over COUNT boxes, and for
+// comparison the ray casts done by testing every box.
+
+namespace
+{
+    const unsigned int COUNT = 20000;
+    const unsigned int RAYS  = 64;
+
+    template <typename T>
+    T random()
+    {
+        return (T)std::rand() / (T)RAND_MAX;
+    }
+
+    template <typename T>
+    struct scene
+    {
+        std::vector<rgm::vector<T, 3>> lower;
+        std::vector<rgm::vector<T, 3>> upper;
+        std::vector<rgm::vector<T, 3>> moved_lower;
+        std::vector<rgm::vector<T, 3>> moved_upper;
+        std::vector<rgm::ray<T>>       rays;
+        rgm::bvh<T>                    tree;
+
+        scene()
+        : lower(COUNT), upper(COUNT), moved_lower(COUNT), moved_upper(COUNT), rays(RAYS)
+        {
+            std::srand(0);
+            for (unsigned int i = 0; i < COUNT; i++)
+            {
+                rgm::vector3<T> c(random<T>() * 1000, random<T>() * 1000, random<T>() * 100);
+                rgm::vector3<T> e(random<T>() * 2, random<T>() * 2, random<T>() * 2);
+                rgm::vector3<T> d(random<T>(), random<T>(), random<T>());
+                lower[i]       = c - e;
+                upper[i]       = c + e;
+                moved_lower[i] = lower[i] + d;
+                moved_upper[i] = upper[i] + d;
+            }
+            for (unsigned int i = 0; i < RAYS; i++)
+            {
+                rgm::vector3<T> o(random<T>() * 1000, random<T>() * 1000, (T)200);
+                rgm::vector3<T> d(random<T>() - (T)0.5, random<T>() - (T)0.5, (T)-1);
+                rays[i] = rgm::ray<T>(o, d);
+            }
+            tree.build(&lower[0], &upper[0], COUNT);
+        }
+    };
+
+    template <typename T>
+    const scene<T>& sample()
+    {
+        static scene<T> s;
+        return s;
+    }
+
+    template <typename T>
+    T hit_box(const rgm::ray<T>& r, const rgm::vector<T, 3>& lower, const rgm::vector<T, 3>& upper, T t)
+    {
+        T t0 = 0;
+        T t1 = t;
+        for (unsigned int j = 0; j < 3; j++)
+        {
+            T a = (lower[j] - r.origin[j]) / r.direction[j];
+            T b = (upper[j] - r.origin[j]) / r.direction[j];
+            t0  = std::max(t0, std::min(a, b));
+            t1  = std::min(t1, std::max(a, b));
+        }
+        return t0 <= t1 ? t0 : t;
+    }
+
+    template <typename T>
+    void build(unsigned int iterations)
+    {
+        const scene<T>& s = sample<T>();
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            rgm::bvh<T> tree(&s.lower[0], &s.upper[0], COUNT);
+            rbench::keep(tree.nodes()[0].lower[0]);
+        }
+    }
+
+    template <typename T>
+    void build_parallel(unsigned int iterations)
+    {
+        static rgm::thread_pool pool;
+        const scene<T>& s = sample<T>();
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            rgm::bvh<T> tree(pool, &s.lower[0], &s.upper[0], COUNT);
+            rbench::keep(tree.nodes()[0].lower[0]);
+        }
+    }
+
+    template <typename T>
+    void refit(unsigned int iterations)
+    {
+        const scene<T>& s = sample<T>();
+        rgm::bvh<T> tree = s.tree;
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            if (i % 2 == 0)
+            {
+                tree.refit(&s.moved_lower[0], &s.moved_upper[0]);
+            }
+            else
+            {
+                tree.refit(&s.lower[0], &s.upper[0]);
+            }
+            rbench::keep(tree.nodes()[0].lower[0]);
+        }
+    }
+
+    template <typename T>
+    void raycast(unsigned int iterations)
+    {
+        const scene<T>& s = sample<T>();
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            const rgm::ray<T>& r = s.rays[i % RAYS];
+            T t = std::numeric_limits<T>::max();
+            size_t hit = s.tree.raycast(r, t, [&] (unsigned int p, T tmax) { return hit_box(r, s.lower[p], s.upper[p], tmax); });
+            rbench::keep(hit);
+        }
+    }
+
+    template <typename T>
+    void raycast_brute_force(unsigned int iterations)
+    {
+        const scene<T>& s = sample<T>();
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            const rgm::ray<T>& r = s.rays[i % RAYS];
+            T t = std::numeric_limits<T>::max();
+            size_t hit = rgm::bvh<T>::NONE;
+            for (unsigned int p = 0; p < COUNT; p++)
+            {
+                T d = hit_box(r, s.lower[p], s.upper[p], t);
+                if (d < t)
+                {
+                    t   = d;
+                    hit = p;
+                }
+            }
+            rbench::keep(hit);
+        }
+    }
+
+    template <typename T>
+    void overlap(unsigned int iterations)
+    {
+        const scene<T>& s = sample<T>();
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            rgm::vector<T, 3> lower = s.lower[i % COUNT] - rgm::vector<T, 3>((T)10);
+            rgm::vector<T, 3> upper = s.upper[i % COUNT] + rgm::vector<T, 3>((T)10);
+            size_t n = 0;
+            s.tree.overlap(lower, upper, [&] (unsigned int) { n++; });
+            rbench::keep(n);
+        }
+    }
+}
+
+#define BVH_BENCHMARKS(P, T)                                                         \
+    BENCHMARK(P ## _build)                { build<T>(iterations); }                   \
+    BENCHMARK(P ## _build_parallel)       { build_parallel<T>(iterations); }          \
+    BENCHMARK(P ## _refit)                { refit<T>(iterations); }                   \
+    BENCHMARK(P ## _raycast)              { raycast<T>(iterations); }                 \
+    BENCHMARK(P ## _raycast_brute_force)  { raycast_brute_force<T>(iterations); }     \
+    BENCHMARK(P ## _overlap)              { overlap<T>(iterations); }
+
+BVH_BENCHMARKS(bvh, float)
+BVH_BENCHMARKS(dbvh, double)
@@ -0,0 +1,105 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "rbench.h"
+#include <rgm/rgm.h>
+
+#include <algorithm>
+#include <vector>
+
+// Bulk copies of transform and vertex arrays; with trivially copyable
+// types these are memcpy and memmove.
+
+namespace
+{
+    const unsigned int COUNT = 4096;
+
+    struct vertex
+    {
+        rgm::vec3 position;
+        rgm::vec3 normal;
+        rgm::vec2 uv;
+    };
+
+    template <typename V>
+    const std::vector<V>& values()
+    {
+        static std::vector<V> r(COUNT);
+        return r;
+    }
+
+    template <typename V>
+    void assign(unsigned int iterations)
+    {
+        const std::vector<V>& a = values<V>();
+        std::vector<V> r(COUNT);
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            r = a;
+            rbench::keep(r[i % COUNT]);
+        }
+    }
+
+    template <typename V>
+    void copy(unsigned int iterations)
+    {
+        const std::vector<V>& a = values<V>();
+        std::vector<V> r(COUNT);
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            std::copy(a.begin(), a.end(), r.begin());
+            rbench::keep(r[i % COUNT]);
+        }
+    }
+
+    // push_back without reserve, so the array is reallocated and moved
+    // log2(COUNT) times.
+    template <typename V>
+    void grow(unsigned int iterations)
+    {
+        const std::vector<V>& a = values<V>();
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            std::vector<V> r;
+            for (unsigned int j = 0; j < COUNT; j++)
+            {
+                r.push_back(a[j]);
+            }
+            rbench::keep(r[i % COUNT]);
+        }
+    }
+}
+
+BENCHMARK(mat4_array_assign)   { assign<rgm::mat4>(iterations); }
+BENCHMARK(mat4_array_copy)     { copy<rgm::mat4>(iterations); }
+BENCHMARK(mat4_array_grow)     { grow<rgm::mat4>(iterations); }
+BENCHMARK(dmat4_array_assign)  { assign<rgm::dmat4>(iterations); }
+BENCHMARK(dmat4_array_copy)    { copy<rgm::dmat4>(iterations); }
+BENCHMARK(vec4_array_assign)   { assign<rgm::vec4>(iterations); }
+BENCHMARK(vec4_array_copy)     { copy<rgm::vec4>(iterations); }
+BENCHMARK(vec4_array_grow)     { grow<rgm::vec4>(iterations); }
+BENCHMARK(vertex_array_assign) { assign<vertex>(iterations); }
+BENCHMARK(vertex_array_copy)   { copy<vertex>(iterations); }
+BENCHMARK(vertex_array_grow)   { grow<vertex>(iterations); }
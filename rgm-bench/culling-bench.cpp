@@ -0,0 +1,183 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+
+#include "rbench.h"
+#include <rgm/rgm.h>
+
+#include <vector>
+#include <cstdlib>
+
+// Frustum culling of COUNT bounding spheres and boxes, with the scalar
+// tests in a loop and with the batch kernels.
+
+namespace
+{
+    const unsigned int COUNT = 16384;
+
+    template <typename T>
+    T random()
+    {
+        return (T)std::rand() / (T)RAND_MAX;
+    }
+
+    template <typename T>
+    struct scene
+    {
+        rgm::frustum_planes<T>         frustum;
+        rgm::vector_stream<T, 4>       spheres;
+        rgm::vector_stream<T, 3>       lower;
+        rgm::vector_stream<T, 3>       upper;
+        std::vector<rgm::vector<T, 4>> aos_spheres;
+        std::vector<rgm::vector<T, 3>> aos_lower;
+        std::vector<rgm::vector<T, 3>> aos_upper;
+
+        // objects all around the camera, so that about a sixth is visible
+        scene()
+        : frustum(rgm::perspective((T)60, (T)1.5, (T)1, (T)500)),
+          spheres(COUNT), lower(COUNT), upper(COUNT),
+          aos_spheres(COUNT), aos_lower(COUNT), aos_upper(COUNT)
+        {
+            std::srand(0);
+            for (unsigned int i = 0; i < COUNT; i++)
+            {
+                rgm::vector3<T> c(random<T>() * 400 - 200, random<T>() * 400 - 200, random<T>() * 400 - 200);
+                rgm::vector3<T> e(random<T>() * 5, random<T>() * 5, random<T>() * 5);
+                aos_spheres[i] = rgm::vector4<T>(c, rgm::length(e));
+                aos_lower[i]   = c - e;
+                aos_upper[i]   = c + e;
+            }
+            spheres.load(&aos_spheres[0], COUNT);
+            lower.load(&aos_lower[0], COUNT);
+            upper.load(&aos_upper[0], COUNT);
+        }
+    };
+
+    template <typename T>
+    const scene<T>& sample()
+    {
+        static scene<T> s;
+        return s;
+    }
+
+    template <typename T>
+    void spheres_scalar(unsigned int iterations)
+    {
+        const scene<T>& s = sample<T>();
+        std::vector<unsigned int> r;
+        r.reserve(COUNT);
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            r.clear();
+            for (unsigned int j = 0; j < COUNT; j++)
+            {
+                if (rgm::visible(s.frustum, rgm::vector3<T>(s.aos_spheres[j]), s.aos_spheres[j][3]))
+                {
+                    r.push_back(j);
+                }
+            }
+            rbench::keep(r[i % r.size()]);
+        }
+    }
+
+    template <typename T>
+    void boxes_scalar(unsigned int iterations)
+    {
+        const scene<T>& s = sample<T>();
+        std::vector<unsigned int> r;
+        r.reserve(COUNT);
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            r.clear();
+            for (unsigned int j = 0; j < COUNT; j++)
+            {
+                if (rgm::visible(s.frustum, s.aos_lower[j], s.aos_upper[j]))
+                {
+                    r.push_back(j);
+                }
+            }
+            rbench::keep(r[i % r.size()]);
+        }
+    }
+
+    template <typename T>
+    void spheres_mask(unsigned int iterations)
+    {
+        const scene<T>& s = sample<T>();
+        std::vector<unsigned int> r;
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            rgm::visible_mask(s.frustum, s.spheres, r);
+            rbench::keep(r[i % r.size()]);
+        }
+    }
+
+    template <typename T>
+    void spheres_indices(unsigned int iterations)
+    {
+        const scene<T>& s = sample<T>();
+        std::vector<unsigned int> r;
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            rgm::visible_indices(s.frustum, s.spheres, r);
+            rbench::keep(r[i % r.size()]);
+        }
+    }
+
+    template <typename T>
+    void boxes_mask(unsigned int iterations)
+    {
+        const scene<T>& s = sample<T>();
+        std::vector<unsigned int> r;
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            rgm::visible_mask(s.frustum, s.lower, s.upper, r);
+            rbench::keep(r[i % r.size()]);
+        }
+    }
+
+    template <typename T>
+    void boxes_indices(unsigned int iterations)
+    {
+        const scene<T>& s = sample<T>();
+        std::vector<unsigned int> r;
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            rgm::visible_indices(s.frustum, s.lower, s.upper, r);
+            rbench::keep(r[i % r.size()]);
+        }
+    }
+}
+
+#define CULLING_BENCHMARKS(P, T)                                                         \
+    BENCHMARK(P ## _cull_spheres_scalar)  { spheres_scalar<T>(iterations); }               \
+    BENCHMARK(P ## _cull_spheres_mask)    { spheres_mask<T>(iterations); }                 \
+    BENCHMARK(P ## _cull_spheres_indices) { spheres_indices<T>(iterations); }              \
+    BENCHMARK(P ## _cull_boxes_scalar)    { boxes_scalar<T>(iterations); }                 \
+    BENCHMARK(P ## _cull_boxes_mask)      { boxes_mask<T>(iterations); }                   \
+    BENCHMARK(P ## _cull_boxes_indices)   { boxes_indices<T>(iterations); }
+
+CULLING_BENCHMARKS(float, float)
+CULLING_BENCHMARKS(double, double)
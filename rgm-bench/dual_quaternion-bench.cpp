@@ -0,0 +1,176 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "rbench.h"
+#include <rgm/rgm.h>
+
+#include <vector>
+#include <cstdlib>
+
+// Skinning of COUNT vertices with 4 influences from a palette of BONES
+// bones, as dual quaternions (AoS and stream) and as matrices, for
+// comparison with matrix palette skinning.
+
+namespace
+{
+    const unsigned int COUNT = 1024;
+    const unsigned int BONES = 64;
+
+    template <typename T>
+    T random()
+    {
+        return (T)std::rand() / (T)RAND_MAX;
+    }
+
+    template <typename T>
+    struct skeleton
+    {
+        std::vector<rgm::dual_quaternion<T>>   bones;
+        std::vector<rgm::matrix<T, 4>>         palette;
+        rgm::vector_stream<unsigned int, 4>    indices;
+        rgm::vector_stream<T, 4>               weights;
+        rgm::vector_stream<T, 3>               positions;
+        std::vector<rgm::vector<unsigned int, 4>> aos_indices;
+        std::vector<rgm::vector<T, 4>>         aos_weights;
+        std::vector<rgm::vector<T, 3>>         aos_positions;
+
+        skeleton()
+        : bones(BONES), palette(BONES), indices(COUNT), weights(COUNT), positions(COUNT),
+          aos_indices(COUNT), aos_weights(COUNT), aos_positions(COUNT)
+        {
+            std::srand(0);
+            for (unsigned int i = 0; i < BONES; i++)
+            {
+                rgm::vector3<T> axis(random<T>(), random<T>(), random<T>());
+                rgm::vector3<T> t(random<T>(), random<T>(), random<T>());
+                bones[i]   = rgm::dual_quaternion<T>(rgm::axis_angle(axis, random<T>() * 180), t);
+                palette[i] = rgm::dualquat2mat4(bones[i]);
+            }
+            for (unsigned int i = 0; i < COUNT; i++)
+            {
+                aos_indices[i]   = rgm::vector4<unsigned int>(std::rand() % BONES, std::rand() % BONES, std::rand() % BONES, std::rand() % BONES);
+                aos_weights[i]   = rgm::vector4<T>(random<T>(), random<T>(), random<T>(), random<T>());
+                aos_weights[i]   = aos_weights[i] / (aos_weights[i][0] + aos_weights[i][1] + aos_weights[i][2] + aos_weights[i][3]);
+                aos_positions[i] = rgm::vector3<T>(random<T>(), random<T>(), random<T>());
+            }
+            indices.load(&aos_indices[0], COUNT);
+            weights.load(&aos_weights[0], COUNT);
+            positions.load(&aos_positions[0], COUNT);
+        }
+    };
+
+    template <typename T>
+    const skeleton<T>& sample()
+    {
+        static skeleton<T> s;
+        return s;
+    }
+
+    template <typename T, typename F>
+    void bone_unary(unsigned int iterations, F f)
+    {
+        const skeleton<T>& s = sample<T>();
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            auto r = f(s.bones[i % BONES]);
+            rbench::keep(r);
+        }
+    }
+
+    template <typename T, typename F>
+    void bone_bone(unsigned int iterations, F f)
+    {
+        const skeleton<T>& s = sample<T>();
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            auto r = f(s.bones[i % BONES], s.bones[(i + 1) % BONES]);
+            rbench::keep(r);
+        }
+    }
+
+    template <typename T>
+    void skin_stream(unsigned int iterations)
+    {
+        const skeleton<T>& s = sample<T>();
+        rgm::vector_stream<T, 3> r;
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            rgm::skin(&s.bones[0], s.indices, s.weights, s.positions, r);
+            rbench::keep(r.lane(0)[i % COUNT]);
+        }
+    }
+
+    template <typename T>
+    void skin_aos(unsigned int iterations)
+    {
+        const skeleton<T>& s = sample<T>();
+        std::vector<rgm::vector<T, 3>> r(COUNT);
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            for (unsigned int j = 0; j < COUNT; j++)
+            {
+                const rgm::vector<unsigned int, 4>& k = s.aos_indices[j];
+                rgm::dual_quaternion<T> q[4] = {s.bones[k[0]], s.bones[k[1]], s.bones[k[2]], s.bones[k[3]]};
+                r[j] = rgm::transform_point(rgm::blend(q, s.aos_weights[j].c_array(), 4), s.aos_positions[j]);
+            }
+            rbench::keep(r[i % COUNT]);
+        }
+    }
+
+    template <typename T>
+    void skin_matrix(unsigned int iterations)
+    {
+        const skeleton<T>& s = sample<T>();
+        std::vector<rgm::vector<T, 3>> r(COUNT);
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            for (unsigned int j = 0; j < COUNT; j++)
+            {
+                const rgm::vector<unsigned int, 4>& k = s.aos_indices[j];
+                const rgm::vector<T, 4>&            w = s.aos_weights[j];
+                rgm::matrix<T, 4> m = s.palette[k[0]] * w[0] + s.palette[k[1]] * w[1] + s.palette[k[2]] * w[2] + s.palette[k[3]] * w[3];
+                r[j] = rgm::vector3<T>(m * rgm::vector4<T>(s.aos_positions[j], (T)1));
+            }
+            rbench::keep(r[i % COUNT]);
+        }
+    }
+}
+
+BENCHMARK(dualquat_skin_stream)   { skin_stream<float>(iterations); }
+BENCHMARK(dualquat_skin_aos)      { skin_aos<float>(iterations); }
+BENCHMARK(mat4_skin_aos)          { skin_matrix<float>(iterations); }
+BENCHMARK(ddualquat_skin_stream)  { skin_stream<double>(iterations); }
+BENCHMARK(ddualquat_skin_aos)     { skin_aos<double>(iterations); }
+BENCHMARK(dmat4_skin_aos)         { skin_matrix<double>(iterations); }
+
+#define DUAL_QUATERNION_BENCHMARKS(P, T)                                                                                                         \
+    BENCHMARK(P ## _mul)             { bone_bone<T>(iterations, [] (const auto& a, const auto& b) { return a * b; }); }                            \
+    BENCHMARK(P ## _normalize)       { bone_unary<T>(iterations, [] (const auto& a) { return rgm::normalize(a); }); }                              \
+    BENCHMARK(P ## _to_mat4)         { bone_unary<T>(iterations, [] (const auto& a) { return rgm::dualquat2mat4(a); }); }                          \
+    BENCHMARK(P ## _from_mat4)       { bone_unary<T>(iterations, [] (const auto& a) { return rgm::mat42dualquat(rgm::dualquat2mat4(a)); }); }      \
+    BENCHMARK(P ## _transform_point) { bone_unary<T>(iterations, [] (const auto& a) { return rgm::transform_point(a, rgm::vector3<T>(1, 2, 3)); }); }
+
+DUAL_QUATERNION_BENCHMARKS(dualquat, float)
+DUAL_QUATERNION_BENCHMARKS(ddualquat, double)
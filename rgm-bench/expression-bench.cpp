@@ -0,0 +1,128 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "rbench.h"
+#include <rgm/rgm.h>
+
+#include <vector>
+#include <cstdlib>
+
+// Each iteration evaluates an expression for COUNT vectors or matrices, once
+// with the plain operators and once with the lazy ones from expression.h.
+
+namespace
+{
+    const unsigned int COUNT = 1024;
+
+    template <typename V>
+    const std::vector<V>& values(unsigned int seed)
+    {
+        static std::vector<V> data[4];
+        std::vector<V>& r = data[seed];
+        if (r.empty())
+        {
+            std::srand(seed);
+            r.resize(COUNT);
+            for (unsigned int i = 0; i < COUNT; i++)
+            {
+                typename rgm::expr::traits<V>::value_type* p = rgm::expr::traits<V>::data(r[i]);
+                for (unsigned int j = 0; j < rgm::expr::traits<V>::size; j++)
+                {
+                    p[j] = (typename rgm::expr::traits<V>::value_type)std::rand() / RAND_MAX + 0.1f;
+                }
+            }
+        }
+        return r;
+    }
+
+    template <typename V, typename F>
+    void combine(unsigned int iterations, F f)
+    {
+        const std::vector<V>& a = values<V>(0);
+        const std::vector<V>& b = values<V>(1);
+        const std::vector<V>& c = values<V>(2);
+        const std::vector<V>& d = values<V>(3);
+        std::vector<V> r(COUNT);
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            for (unsigned int j = 0; j < COUNT; j++)
+            {
+                r[j] = f(a[j], b[j], c[j], d[j]);
+            }
+            rbench::keep(r[i % COUNT]);
+        }
+    }
+}
+
+// a * 0.5 + b * 0.25 + c * 2 - d, three temporaries with the plain
+// operators.
+#define EXPRESSION_BENCHMARKS(P, T, N)                                                                                  \
+    BENCHMARK(P ## N ## _expression)                                                                                    \
+    {                                                                                                                   \
+        combine<rgm::vector<T, N>>(iterations, [] (const auto& a, const auto& b, const auto& c, const auto& d) {         \
+            return a * (T)0.5 + b * (T)0.25 + c * (T)2 - d;                                                             \
+        });                                                                                                             \
+    }                                                                                                                   \
+    BENCHMARK(P ## N ## _expression_lazy)                                                                               \
+    {                                                                                                                   \
+        combine<rgm::vector<T, N>>(iterations, [] (const auto& a, const auto& b, const auto& c, const auto& d) {         \
+            return rgm::eval(rgm::lazy(a) * (T)0.5 + rgm::lazy(b) * (T)0.25 + rgm::lazy(c) * (T)2 - d);                 \
+        });                                                                                                             \
+    }                                                                                                                   \
+    BENCHMARK(P ## N ## _mix_add)                                                                                       \
+    {                                                                                                                   \
+        combine<rgm::vector<T, N>>(iterations, [] (const auto& a, const auto& b, const auto& c, const auto&) {          \
+            return rgm::mix(a, b, (T)0.25) + c;                                                                         \
+        });                                                                                                             \
+    }                                                                                                                   \
+    BENCHMARK(P ## N ## _mix_add_lazy)                                                                                  \
+    {                                                                                                                   \
+        combine<rgm::vector<T, N>>(iterations, [] (const auto& a, const auto& b, const auto& c, const auto&) {          \
+            return rgm::eval(rgm::mix(rgm::lazy(a), rgm::lazy(b), (T)0.25) + c);                                        \
+        });                                                                                                             \
+    }
+
+EXPRESSION_BENCHMARKS(vec, float, 3)
+EXPRESSION_BENCHMARKS(vec, float, 4)
+EXPRESSION_BENCHMARKS(dvec, double, 3)
+EXPRESSION_BENCHMARKS(dvec, double, 4)
+
+#define MATRIX_EXPRESSION_BENCHMARKS(P, T, N)                                                                           \
+    BENCHMARK(P ## N ## _expression)                                                                                    \
+    {                                                                                                                   \
+        combine<rgm::matrix<T, N>>(iterations, [] (const auto& a, const auto& b, const auto& c, const auto& d) {         \
+            return a * (T)0.5 + b - c * (T)2 + d;                                                                       \
+        });                                                                                                             \
+    }                                                                                                                   \
+    BENCHMARK(P ## N ## _expression_lazy)                                                                               \
+    {                                                                                                                   \
+        combine<rgm::matrix<T, N>>(iterations, [] (const auto& a, const auto& b, const auto& c, const auto& d) {         \
+            return rgm::eval(rgm::lazy(a) * (T)0.5 + b - rgm::lazy(c) * (T)2 + d);                                      \
+        });                                                                                                             \
+    }
+
+MATRIX_EXPRESSION_BENCHMARKS(mat, float, 3)
+MATRIX_EXPRESSION_BENCHMARKS(mat, float, 4)
+MATRIX_EXPRESSION_BENCHMARKS(dmat, double, 4)
@@ -0,0 +1,213 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "rbench.h"
+#include <rgm/rgm.h>
+
+#include <vector>
+#include <cstdlib>
+
+// The transform_* benchmarks transform COUNT points per iteration.
+
+namespace
+{
+    const unsigned int COUNT = 1024;
+    const unsigned int LARGE = 256 * 1024;
+
+    template <typename T>
+    const std::vector<rgm::vector<T, 3>>& points(unsigned int count)
+    {
+        static std::vector<rgm::vector<T, 3>> data;
+        if (data.size() != count)
+        {
+            std::srand(0);
+            data.resize(count);
+            for (unsigned int i = 0; i < count; i++)
+            {
+                for (unsigned int j = 0; j < 3; j++)
+                {
+                    data[i][j] = (T)std::rand() / (T)RAND_MAX;
+                }
+            }
+        }
+        return data;
+    }
+
+    template <typename T, typename F>
+    void each_point(unsigned int iterations, F f)
+    {
+        const std::vector<rgm::vector<T, 3>>& p = points<T>(COUNT);
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            auto r = f(p[i % COUNT], p[(i + 1) % COUNT]);
+            rbench::keep(r);
+        }
+    }
+
+    template <typename T>
+    rgm::matrix<T, 4> model()
+    {
+        rgm::matrix<T, 4> m(1);
+        m = rgm::translate(m, rgm::vector3<T>(1, 2, 3));
+        m = rgm::rotate(m, rgm::vector3<T>(0, 1, 0), (T)0.5);
+        return m;
+    }
+
+    // COUNT rotated and uniformly scaled models
+    template <typename T>
+    const std::vector<rgm::matrix<T, 4>>& models()
+    {
+        static std::vector<rgm::matrix<T, 4>> m;
+        if (m.empty())
+        {
+            const std::vector<rgm::vector<T, 3>>& p = points<T>(COUNT);
+            for (unsigned int i = 0; i < COUNT; i++)
+            {
+                rgm::quaterion<T> q = rgm::normalize(rgm::quaterion<T>(p[(i + 1) % COUNT], (T)0.5));
+                m.push_back(rgm::compose_trs(p[i], q, rgm::vector<T, 3>(1 + p[i][0])));
+            }
+        }
+        return m;
+    }
+
+    template <typename T, typename F>
+    void each_model(unsigned int iterations, F f)
+    {
+        const std::vector<rgm::matrix<T, 4>>& m = models<T>();
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            auto r = f(m[i % COUNT]);
+            rbench::keep(r);
+        }
+    }
+}
+
+#define GL_BENCHMARKS(P, V, T)                                                                                                                                                             \
+    BENCHMARK(P ## _translate)   { each_point<T>(iterations, [] (const auto& a, const auto&) { return rgm::translate(rgm::matrix<T, 4>(1), a); }); }                                       \
+    BENCHMARK(P ## _rotate)      { each_point<T>(iterations, [] (const auto& a, const auto& b) { return rgm::rotate(rgm::matrix<T, 4>(1), a, b[0]); }); }                                  \
+    BENCHMARK(P ## _rotate_quat) { each_point<T>(iterations, [] (const auto& a, const auto& b) { return rgm::rotate(rgm::matrix<T, 4>(1), rgm::axis_angle(a, b[0])); }); }                 \
+    BENCHMARK(P ## _scale)       { each_point<T>(iterations, [] (const auto& a, const auto&) { return rgm::scale(rgm::matrix<T, 4>(1), a); }); }                                           \
+    BENCHMARK(P ## _lookat)      { each_point<T>(iterations, [] (const auto& a, const auto& b) { return rgm::lookat(a, b, rgm::vector<T, 3>(rgm::vector3<T>(0, 1, 0))); }); }              \
+    BENCHMARK(P ## _perspective) { each_point<T>(iterations, [] (const auto& a, const auto&) { return rgm::perspective<T>(45 + a[0], a[1] + 1, (T)0.1, 100 + a[2]); }); }                  \
+    BENCHMARK(P ## _ortho)       { each_point<T>(iterations, [] (const auto& a, const auto& b) { return rgm::ortho<T>(-1 - a[0], 1 + a[1], -1 - a[2], 1 + b[0], (T)0.1, 100 + b[1]); }); } \
+    BENCHMARK(P ## _trs_products) { each_point<T>(iterations, [] (const auto& a, const auto& b) { return rgm::scale(rgm::rotate(rgm::translate(rgm::matrix<T, 4>(1), a), rgm::quaterion<T>(b, (T)0.5)), a); }); } \
+    BENCHMARK(P ## _compose_trs) { each_point<T>(iterations, [] (const auto& a, const auto& b) { return rgm::compose_trs(a, rgm::quaterion<T>(b, (T)0.5), a); }); }                             \
+    BENCHMARK(P ## _decompose_trs) { rgm::matrix<T, 4> m = model<T>(); each_point<T>(iterations, [&] (const auto& a, const auto&) { return rgm::decompose_trs(rgm::scale(m, a)); }); }     \
+    BENCHMARK(P ## _normal_matrix_inverse) { each_model<T>(iterations, [] (const auto& m) { return rgm::transpose(rgm::inv(rgm::matrix<T, 3>(rgm::matrix3<T>(m)))); }); }                  \
+    BENCHMARK(P ## _normal_matrix) { each_model<T>(iterations, [] (const auto& m) { return rgm::normal_matrix(m); }); }                                                                    \
+    BENCHMARK(P ## _normal_matrix_uniform) { each_model<T>(iterations, [] (const auto& m) { return rgm::normal_matrix_uniform(m); }); }                                                    \
+    BENCHMARK(P ## _normal_matrix_rigid) { each_model<T>(iterations, [] (const auto& m) { return rgm::normal_matrix_rigid(m); }); }                                                        \
+    BENCHMARK(V ## _transform)   { rgm::matrix<T, 4> m = model<T>(); each_point<T>(iterations, [&] (const auto& a, const auto&) { return rgm::transform(m, a); }); }
+
+GL_BENCHMARKS(gl_mat4, vec3, float)
+GL_BENCHMARKS(gl_dmat4, dvec3, double)
+
+// COUNT normal matrices per iteration
+BENCHMARK(mat4_normal_matrix_batch)
+{
+    const std::vector<rgm::matrix<float, 4>>& m = models<float>();
+    std::vector<rgm::matrix<float, 3>> r(COUNT);
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        rgm::normal_matrix(&m[0], &r[0], COUNT);
+        rbench::keep(r[i % COUNT]);
+    }
+}
+
+BENCHMARK(dmat4_normal_matrix_batch)
+{
+    const std::vector<rgm::matrix<double, 4>>& m = models<double>();
+    std::vector<rgm::matrix<double, 3>> r(COUNT);
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        rgm::normal_matrix(&m[0], &r[0], COUNT);
+        rbench::keep(r[i % COUNT]);
+    }
+}
+
+BENCHMARK(vec3_transform_each)
+{
+    const std::vector<rgm::vector<float, 3>>& p = points<float>(COUNT);
+    std::vector<rgm::vector<float, 3>> r(COUNT);
+    rgm::mat4 m = model<float>();
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        for (unsigned int j = 0; j < COUNT; j++)
+        {
+            r[j] = rgm::vector3<float>(m * rgm::vector4<float>(p[j], 1));
+        }
+        rbench::keep(r[i % COUNT]);
+    }
+}
+
+BENCHMARK(vec3_transform_points)
+{
+    const std::vector<rgm::vector<float, 3>>& p = points<float>(COUNT);
+    std::vector<rgm::vector<float, 3>> r(COUNT);
+    rgm::mat4 m = model<float>();
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        rgm::transform_points(m, &p[0], &r[0], COUNT);
+        rbench::keep(r[i % COUNT]);
+    }
+}
+
+BENCHMARK(dvec3_transform_points)
+{
+    const std::vector<rgm::vector<double, 3>>& p = points<double>(COUNT);
+    std::vector<rgm::vector<double, 3>> r(COUNT);
+    rgm::dmat4 m = model<double>();
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        rgm::transform_points(m, &p[0], &r[0], COUNT);
+        rbench::keep(r[i % COUNT]);
+    }
+}
+
+// These two transform LARGE points per iteration.
+BENCHMARK(vec3_transform_points_large)
+{
+    const std::vector<rgm::vector<float, 3>>& p = points<float>(LARGE);
+    std::vector<rgm::vector<float, 3>> r(LARGE);
+    rgm::mat4 m = model<float>();
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        rgm::transform_points(m, &p[0], &r[0], LARGE);
+        rbench::keep(r[i % LARGE]);
+    }
+}
+
+BENCHMARK(vec3_transform_points_large_pool)
+{
+    static rgm::thread_pool pool;
+    const std::vector<rgm::vector<float, 3>>& p = points<float>(LARGE);
+    std::vector<rgm::vector<float, 3>> r(LARGE);
+    rgm::mat4 m = model<float>();
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        rgm::transform_points(pool, m, &p[0], &r[0], LARGE);
+        rbench::keep(r[i % LARGE]);
+    }
+}
@@ -0,0 +1,124 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+
+#include "rbench.h"
+#include <rgm/rgm.h>
+
+#include <vector>
+
+// A frame of a COUNT node scene, a 4-ary tree, where 5% of the nodes move
+// and only they and their descendants are recomputed (about a quarter of
+// the nodes), compared to every node moving.
+
+namespace
+{
+    const unsigned int COUNT = 100000;
+
+    template <typename T>
+    struct scene
+    {
+        rgm::transform_hierarchy<T> hierarchy;
+        std::vector<unsigned int>   moving;
+
+        scene()
+        {
+            for (unsigned int i = 0; i < COUNT; i++)
+            {
+                unsigned int    parent = i == 0 ? rgm::transform_hierarchy<T>::NONE : (i - 1) / 4;
+                rgm::vector3<T> t((T)(i % 5), (T)1, (T)0);
+                hierarchy.add(parent, t, rgm::axis_angle(rgm::vector3<T>(0, 1, 0), (T)(i % 90)), rgm::vector3<T>(1, 1, 1));
+                // the top three levels stay put, like the roots of a level
+                if (i > 20 && ((i * 2654435761u) >> 16) % 20 == 0)
+                {
+                    moving.push_back(i);
+                }
+            }
+            hierarchy.update();
+        }
+    };
+
+    template <typename T>
+    scene<T>& sample()
+    {
+        static scene<T> s;
+        return s;
+    }
+
+    template <typename T>
+    void move(scene<T>& s, const std::vector<unsigned int>& nodes, unsigned int frame)
+    {
+        for (size_t k = 0; k < nodes.size(); k++)
+        {
+            s.hierarchy.set_translation(nodes[k], rgm::vector3<T>((T)(frame % 5), (T)1, (T)0));
+        }
+    }
+
+    template <typename T>
+    void update_moving(unsigned int iterations)
+    {
+        scene<T>& s = sample<T>();
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            move(s, s.moving, i);
+            size_t n = s.hierarchy.update();
+            rbench::keep(n);
+        }
+    }
+
+    template <typename T>
+    void update_moving_parallel(unsigned int iterations)
+    {
+        static rgm::thread_pool pool;
+        scene<T>& s = sample<T>();
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            move(s, s.moving, i);
+            size_t n = s.hierarchy.update(pool);
+            rbench::keep(n);
+        }
+    }
+
+    template <typename T>
+    void update_all(unsigned int iterations)
+    {
+        scene<T>& s = sample<T>();
+        std::vector<unsigned int> roots(1, 0);
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            move(s, roots, i);
+            size_t n = s.hierarchy.update();
+            rbench::keep(n);
+        }
+    }
+}
+
+#define HIERARCHY_BENCHMARKS(P, T)                                                        \
+    BENCHMARK(P ## _update_5_percent)          { update_moving<T>(iterations); }          \
+    BENCHMARK(P ## _update_5_percent_parallel) { update_moving_parallel<T>(iterations); } \
+    BENCHMARK(P ## _update_all)                { update_all<T>(iterations); }
+
+HIERARCHY_BENCHMARKS(hierarchy, float)
+HIERARCHY_BENCHMARKS(dhierarchy, double)
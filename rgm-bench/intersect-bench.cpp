@@ -0,0 +1,280 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "rbench.h"
+#include <rgm/rgm.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+// One ray against COUNT triangles, boxes and spheres, and COUNT rays
+// against one of them; with a textbook Möller-Trumbore on vectors, the
+// scalar functions in a loop and the batch kernels.
+
+namespace
+{
+    const unsigned int COUNT = 4096;
+
+    template <typename T>
+    T random()
+    {
+        return (T)std::rand() / (T)RAND_MAX;
+    }
+
+    template <typename T>
+    struct scene
+    {
+        rgm::ray<T>                    ray;
+        std::vector<rgm::vector<T, 3>> aos_a, aos_b, aos_c;
+        std::vector<rgm::vector<T, 3>> aos_lower, aos_upper;
+        std::vector<rgm::vector<T, 4>> aos_spheres;
+        rgm::vector_stream<T, 3>       a, b, c;
+        rgm::vector_stream<T, 3>       lower, upper;
+        rgm::vector_stream<T, 4>       spheres;
+        rgm::vector_stream<T, 3>       origins, directions;
+
+        // small triangles in a 100 unit cube, the ray through its middle
+        // hits a few percent of their boxes
+        scene()
+        : ray(rgm::vector3<T>(-60, 1, 2), rgm::vector3<T>(1, (T)0.01, (T)-0.02)),
+          aos_a(COUNT), aos_b(COUNT), aos_c(COUNT), aos_lower(COUNT), aos_upper(COUNT), aos_spheres(COUNT),
+          origins(COUNT), directions(COUNT)
+        {
+            std::srand(0);
+            for (unsigned int i = 0; i < COUNT; i++)
+            {
+                rgm::vector3<T> p(random<T>() * 100 - 50, random<T>() * 8 - 4, random<T>() * 8 - 4);
+                aos_a[i] = p;
+                aos_b[i] = p + rgm::vector3<T>(random<T>() * 2 - 1, random<T>() * 2 - 1, random<T>() * 2 - 1);
+                aos_c[i] = p + rgm::vector3<T>(random<T>() * 2 - 1, random<T>() * 2 - 1, random<T>() * 2 - 1);
+                aos_lower[i]   = rgm::min(aos_a[i], rgm::min(aos_b[i], aos_c[i]));
+                aos_upper[i]   = rgm::max(aos_a[i], rgm::max(aos_b[i], aos_c[i]));
+                aos_spheres[i] = rgm::vector4<T>(p, (T)0.5);
+
+                // rays from a grid in front of the first triangle towards it
+                rgm::vector3<T> o(-60, (T)(i % 64) / 8 - 4, (T)(i / 64) / 8 - 4);
+                origins.set(i, o);
+                directions.set(i, rgm::vector3<T>(60, 0, 0) - o);
+            }
+            a.load(&aos_a[0], COUNT);
+            b.load(&aos_b[0], COUNT);
+            c.load(&aos_c[0], COUNT);
+            lower.load(&aos_lower[0], COUNT);
+            upper.load(&aos_upper[0], COUNT);
+            spheres.load(&aos_spheres[0], COUNT);
+        }
+    };
+
+    template <typename T>
+    const scene<T>& sample()
+    {
+        static scene<T> s;
+        return s;
+    }
+
+    // the way picking code tends to write it
+    template <typename T>
+    T textbook_triangle(const rgm::ray<T>& r, const rgm::vector<T, 3>& a, const rgm::vector<T, 3>& b, const rgm::vector<T, 3>& c, T tmax)
+    {
+        rgm::vector<T, 3> e1  = b - a;
+        rgm::vector<T, 3> e2  = c - a;
+        rgm::vector<T, 3> p   = rgm::cross(r.direction, e2);
+        T                 det = rgm::dot(e1, p);
+        if (std::abs(det) < (T)1e-12)
+        {
+            return tmax;
+        }
+        T                 inv = (T)1 / det;
+        rgm::vector<T, 3> s   = r.origin - a;
+        T                 u   = rgm::dot(s, p) * inv;
+        if (u < 0 || u > 1)
+        {
+            return tmax;
+        }
+        rgm::vector<T, 3> q = rgm::cross(s, e1);
+        T                 v = rgm::dot(r.direction, q) * inv;
+        if (v < 0 || u + v > 1)
+        {
+            return tmax;
+        }
+        T t = rgm::dot(e2, q) * inv;
+        return t >= 0 && t < tmax ? t : tmax;
+    }
+
+    template <typename T>
+    void triangles_textbook(unsigned int iterations)
+    {
+        const scene<T>& s = sample<T>();
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            T t = 1000;
+            for (unsigned int j = 0; j < COUNT; j++)
+            {
+                t = textbook_triangle(s.ray, s.aos_a[j], s.aos_b[j], s.aos_c[j], t);
+            }
+            rbench::keep(t);
+        }
+    }
+
+    template <typename T>
+    void triangles_scalar(unsigned int iterations)
+    {
+        const scene<T>& s = sample<T>();
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            T t = 1000;
+            for (unsigned int j = 0; j < COUNT; j++)
+            {
+                t = rgm::intersect_triangle(s.ray, s.aos_a[j], s.aos_b[j], s.aos_c[j], t);
+            }
+            rbench::keep(t);
+        }
+    }
+
+    template <typename T>
+    void triangles_stream(unsigned int iterations)
+    {
+        const scene<T>& s = sample<T>();
+        rgm::vector_stream<T, 3>  hits;
+        std::vector<unsigned int> mask;
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            rgm::intersect_triangles(s.ray, s.a, s.b, s.c, (T)1000, hits, mask);
+            rbench::keep(hits.lane(0)[i % COUNT]);
+        }
+    }
+
+    template <typename T>
+    void triangles_closest(unsigned int iterations)
+    {
+        const scene<T>& s = sample<T>();
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            T t = 1000, u, v;
+            size_t hit = rgm::closest_triangle(s.ray, s.a, s.b, s.c, t, u, v);
+            rbench::keep(hit);
+        }
+    }
+
+    template <typename T>
+    void boxes_scalar(unsigned int iterations)
+    {
+        const scene<T>& s = sample<T>();
+        std::vector<T> t(COUNT);
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            for (unsigned int j = 0; j < COUNT; j++)
+            {
+                t[j] = rgm::intersect_box(s.ray, s.aos_lower[j], s.aos_upper[j], (T)1000);
+            }
+            rbench::keep(t[i % COUNT]);
+        }
+    }
+
+    template <typename T>
+    void boxes_stream(unsigned int iterations)
+    {
+        const scene<T>& s = sample<T>();
+        rgm::vector_stream<T, 1>  t;
+        std::vector<unsigned int> mask;
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            rgm::intersect_boxes(s.ray, s.lower, s.upper, (T)1000, t, mask);
+            rbench::keep(t.lane(0)[i % COUNT]);
+        }
+    }
+
+    template <typename T>
+    void spheres_scalar(unsigned int iterations)
+    {
+        const scene<T>& s = sample<T>();
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            T t = 1000;
+            for (unsigned int j = 0; j < COUNT; j++)
+            {
+                t = rgm::intersect_sphere(s.ray, rgm::vector3<T>(s.aos_spheres[j]), s.aos_spheres[j][3], t);
+            }
+            rbench::keep(t);
+        }
+    }
+
+    template <typename T>
+    void spheres_closest(unsigned int iterations)
+    {
+        const scene<T>& s = sample<T>();
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            T t = 1000;
+            size_t hit = rgm::closest_sphere(s.ray, s.spheres, t);
+            rbench::keep(hit);
+        }
+    }
+
+    template <typename T>
+    void packet_triangle(unsigned int iterations)
+    {
+        const scene<T>& s = sample<T>();
+        rgm::vector_stream<T, 3>  hits(COUNT);
+        std::vector<unsigned int> mask;
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            std::fill(hits.lane(0), hits.lane(0) + COUNT, (T)1000);
+            rgm::intersect_triangle(s.origins, s.directions, s.aos_a[0], s.aos_b[0], s.aos_c[0], hits, mask);
+            rbench::keep(hits.lane(0)[i % COUNT]);
+        }
+    }
+
+    template <typename T>
+    void packet_box(unsigned int iterations)
+    {
+        const scene<T>& s = sample<T>();
+        rgm::vector_stream<T, 1>  far(COUNT);
+        rgm::vector_stream<T, 1>  t;
+        std::vector<unsigned int> mask;
+        std::fill(far.lane(0), far.lane(0) + COUNT, (T)1000);
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            rgm::intersect_box(s.origins, s.directions, s.aos_lower[0], s.aos_upper[0], far, t, mask);
+            rbench::keep(mask[i % mask.size()]);
+        }
+    }
+}
+
+#define INTERSECT_BENCHMARKS(P, T)                                                            \
+    BENCHMARK(P ## _ray_triangles_textbook) { triangles_textbook<T>(iterations); }             \
+    BENCHMARK(P ## _ray_triangles_scalar)   { triangles_scalar<T>(iterations); }               \
+    BENCHMARK(P ## _ray_triangles_stream)   { triangles_stream<T>(iterations); }               \
+    BENCHMARK(P ## _ray_triangles_closest)  { triangles_closest<T>(iterations); }              \
+    BENCHMARK(P ## _ray_boxes_scalar)       { boxes_scalar<T>(iterations); }                   \
+    BENCHMARK(P ## _ray_boxes_stream)       { boxes_stream<T>(iterations); }                   \
+    BENCHMARK(P ## _ray_spheres_scalar)     { spheres_scalar<T>(iterations); }                 \
+    BENCHMARK(P ## _ray_spheres_closest)    { spheres_closest<T>(iterations); }                \
+    BENCHMARK(P ## _rays_triangle)          { packet_triangle<T>(iterations); }                \
+    BENCHMARK(P ## _rays_box)               { packet_box<T>(iterations); }
+
+INTERSECT_BENCHMARKS(float, float)
+INTERSECT_BENCHMARKS(double, double)
@@ -0,0 +1,175 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "rbench.h"
+#include <rgm/rgm.h>
+
+#include <vector>
+#include <cstdlib>
+
+// Every matrix function is timed for float and double with N = 2, 3, 4 and 5;
+// the ones with a SIMD version are also timed against the generic loop,
+// selected with explicit template arguments (NAME_loop).
+
+namespace
+{
+    const unsigned int COUNT = 1024;
+
+    template <typename T, unsigned int N>
+    const std::vector<rgm::matrix<T, N>>& matrices(unsigned int seed)
+    {
+        static std::vector<rgm::matrix<T, N>> data[2];
+        std::vector<rgm::matrix<T, N>>& r = data[seed];
+        if (r.empty())
+        {
+            std::srand(seed);
+            r.resize(COUNT);
+            for (unsigned int i = 0; i < COUNT; i++)
+            {
+                for (unsigned int j = 0; j < N; j++)
+                {
+                    for (unsigned int k = 0; k < N; k++)
+                    {
+                        r[i][j][k] = (T)std::rand() / (T)RAND_MAX;
+                    }
+                }
+            }
+        }
+        return r;
+    }
+
+    template <typename T, unsigned int N>
+    const std::vector<rgm::vector<T, N>>& vectors()
+    {
+        static std::vector<rgm::vector<T, N>> r;
+        if (r.empty())
+        {
+            r.resize(COUNT);
+            for (unsigned int i = 0; i < COUNT; i++)
+            {
+                for (unsigned int j = 0; j < N; j++)
+                {
+                    r[i][j] = j + 1 < N ? (T)std::rand() / (T)RAND_MAX : (T)1;
+                }
+            }
+        }
+        return r;
+    }
+
+    template <typename T, unsigned int N, typename F>
+    void matrix_unary(unsigned int iterations, F f)
+    {
+        const std::vector<rgm::matrix<T, N>>& a = matrices<T, N>(0);
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            auto r = f(a[i % COUNT]);
+            rbench::keep(r);
+        }
+    }
+
+    template <typename T, unsigned int N, typename F>
+    void matrix_matrix(unsigned int iterations, F f)
+    {
+        const std::vector<rgm::matrix<T, N>>& a = matrices<T, N>(0);
+        const std::vector<rgm::matrix<T, N>>& b = matrices<T, N>(1);
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            auto r = f(a[i % COUNT], b[i % COUNT]);
+            rbench::keep(r);
+        }
+    }
+
+    template <typename T, unsigned int N, typename F>
+    void matrix_vector(unsigned int iterations, F f)
+    {
+        const std::vector<rgm::matrix<T, N>>& a = matrices<T, N>(0);
+        const std::vector<rgm::vector<T, N>>& b = vectors<T, N>();
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            auto r = f(a[i % COUNT], b[i % COUNT]);
+            rbench::keep(r);
+        }
+    }
+}
+
+BENCHMARK(mat4_mul_loop)
+{
+    matrix_matrix<float, 4>(iterations, [] (const auto& a, const auto& b) { return rgm::operator * <float, 4>(a, b); });
+}
+
+BENCHMARK(mat4_vec4_mul_loop)
+{
+    matrix_vector<float, 4>(iterations, [] (const auto& a, const auto& b) { return rgm::operator * <float, 4>(a, b); });
+}
+
+BENCHMARK(mat4_inv_scalar)
+{
+    matrix_unary<float, 4>(iterations, [] (const auto& a) { bool invertible; return rgm::inv<float>(a, invertible); });
+}
+
+// GCC 12 miscompiles the generic double 4x4 loops with -mavx (misaligned
+// spills), so there are no dmat4 loop variants.
+
+#define MATRIX_BENCHMARKS(P, V, T, N)                                                                                                  \
+    BENCHMARK(P ## N ## _mul)            { matrix_matrix<T, N>(iterations, [] (const auto& a, const auto& b) { return a * b; }); }     \
+    BENCHMARK(P ## N ## _ ## V ## N ## _mul) { matrix_vector<T, N>(iterations, [] (const auto& a, const auto& b) { return a * b; }); } \
+    BENCHMARK(P ## N ## _add)            { matrix_matrix<T, N>(iterations, [] (const auto& a, const auto& b) { return a + b; }); }     \
+    BENCHMARK(P ## N ## _scale)          { matrix_unary<T, N>(iterations, [] (const auto& a) { return a * (T)3; }); }                  \
+    BENCHMARK(P ## N ## _equal)          { matrix_matrix<T, N>(iterations, [] (const auto& a, const auto& b) { return a == b; }); }    \
+    BENCHMARK(P ## N ## _close)          { matrix_matrix<T, N>(iterations, [] (const auto& a, const auto& b) { return rgm::close(a, b, (T)1e-3); }); } \
+    BENCHMARK(P ## N ## _transpose)      { matrix_unary<T, N>(iterations, [] (const auto& a) { return rgm::transpose(a); }); }         \
+    BENCHMARK(P ## N ## _det)            { matrix_unary<T, N>(iterations, [] (const auto& a) { return rgm::det(a); }); }               \
+    BENCHMARK(P ## N ## _inv)            { matrix_unary<T, N>(iterations, [] (const auto& a) { return rgm::inv(a); }); }
+
+MATRIX_BENCHMARKS(mat, vec, float, 2)
+MATRIX_BENCHMARKS(mat, vec, float, 3)
+MATRIX_BENCHMARKS(mat, vec, float, 4)
+MATRIX_BENCHMARKS(dmat, dvec, double, 2)
+MATRIX_BENCHMARKS(dmat, dvec, double, 3)
+MATRIX_BENCHMARKS(dmat, dvec, double, 4)
+// N = 5 has no closed forms and no SIMD, it times the generic loops.
+MATRIX_BENCHMARKS(mat, vec, float, 5)
+MATRIX_BENCHMARKS(dmat, dvec, double, 5)
+
+// The random matrices are not affine, but the cost does not depend on that.
+BENCHMARK(mat4_inverse_affine)
+{
+    matrix_unary<float, 4>(iterations, [] (const auto& a) { return rgm::inverse_affine(a); });
+}
+
+BENCHMARK(mat4_inverse_rigid)
+{
+    matrix_unary<float, 4>(iterations, [] (const auto& a) { return rgm::inverse_rigid(a); });
+}
+
+BENCHMARK(dmat4_inverse_affine)
+{
+    matrix_unary<double, 4>(iterations, [] (const auto& a) { return rgm::inverse_affine(a); });
+}
+
+BENCHMARK(dmat4_inverse_rigid)
+{
+    matrix_unary<double, 4>(iterations, [] (const auto& a) { return rgm::inverse_rigid(a); });
+}
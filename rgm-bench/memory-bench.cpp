@@ -0,0 +1,85 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "rbench.h"
+#include <rgm/rgm.h>
+
+#include <vector>
+
+// Each iteration is one frame that creates ARRAYS transient arrays of
+// COUNT vectors, once on the heap and once in a frame_arena.
+
+namespace
+{
+    const unsigned int ARRAYS = 64;
+    const unsigned int COUNT  = 64;
+
+    template <typename V>
+    void fill(V& v, unsigned int i)
+    {
+        v.resize(COUNT);
+        v[i % COUNT] = rgm::vec4((float)i);
+        rbench::keep(v[(i + 1) % COUNT]);
+    }
+}
+
+BENCHMARK(frame_heap_arrays)
+{
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        for (unsigned int j = 0; j < ARRAYS; j++)
+        {
+            std::vector<rgm::vec4> v;
+            fill(v, i + j);
+        }
+    }
+}
+
+BENCHMARK(frame_aligned_arrays)
+{
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        for (unsigned int j = 0; j < ARRAYS; j++)
+        {
+            std::vector<rgm::vec4, rgm::aligned_allocator<rgm::vec4>> v;
+            fill(v, i + j);
+        }
+    }
+}
+
+BENCHMARK(frame_arena_arrays)
+{
+    rgm::frame_arena arena(ARRAYS * COUNT * sizeof(rgm::vec4));
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        rgm::arena_allocator<rgm::vec4> alloc(arena);
+        for (unsigned int j = 0; j < ARRAYS; j++)
+        {
+            std::vector<rgm::vec4, rgm::arena_allocator<rgm::vec4>> v(alloc);
+            fill(v, i + j);
+        }
+        arena.reset();
+    }
+}
@@ -0,0 +1,157 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "rbench.h"
+#include <rgm/rgm.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Each iteration packs or unpacks COUNT elements; the float copies
+// are the baseline memory traffic for the unpacked formats.
+
+namespace
+{
+    const unsigned int COUNT = 1024;
+
+    std::vector<rgm::vec3> normals()
+    {
+        std::vector<rgm::vec3> r(COUNT);
+        for (unsigned int i = 0; i < COUNT; i++)
+        {
+            float a = (float)i * 2.4f;
+            float z = 1.0f - 2.0f * ((float)i + 0.5f) / COUNT;
+            float s = std::sqrt(1.0f - z * z);
+            r[i]    = rgm::vec3(s * std::cos(a), s * std::sin(a), z);
+        }
+        return r;
+    }
+
+    std::vector<rgm::quat> rotations()
+    {
+        std::vector<rgm::vec3> n = normals();
+        std::vector<rgm::quat> r(COUNT);
+        for (unsigned int i = 0; i < COUNT; i++)
+        {
+            r[i] = rgm::normalize(rgm::quat(n[i][0], n[i][1], n[i][2], std::cos((float)i)));
+        }
+        return r;
+    }
+}
+
+BENCHMARK(vec3_copy)
+{
+    std::vector<rgm::vec3> v = normals();
+    std::vector<rgm::vec3> r(COUNT);
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        std::copy(v.begin(), v.end(), r.begin());
+        rbench::keep(r[i % COUNT]);
+    }
+}
+
+BENCHMARK(hvec3_pack)
+{
+    std::vector<rgm::vec3>  v = normals();
+    std::vector<rgm::hvec3> r(COUNT);
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        rgm::pack(&v[0], &r[0], COUNT);
+        rbench::keep(r[i % COUNT]);
+    }
+}
+
+BENCHMARK(hvec3_unpack)
+{
+    std::vector<rgm::vec3>  v = normals();
+    std::vector<rgm::hvec3> h(COUNT);
+    std::vector<rgm::vec3>  r(COUNT);
+    rgm::pack(&v[0], &h[0], COUNT);
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        rgm::unpack(&h[0], &r[0], COUNT);
+        rbench::keep(r[i % COUNT]);
+    }
+}
+
+BENCHMARK(oct_snorm16_pack)
+{
+    std::vector<rgm::vec3>        v = normals();
+    std::vector<rgm::oct_snorm16> r(COUNT);
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        rgm::pack(&v[0], &r[0], COUNT);
+        rbench::keep(r[i % COUNT]);
+    }
+}
+
+BENCHMARK(oct_snorm16_unpack)
+{
+    std::vector<rgm::vec3>        v = normals();
+    std::vector<rgm::oct_snorm16> p(COUNT);
+    std::vector<rgm::vec3>        r(COUNT);
+    rgm::pack(&v[0], &p[0], COUNT);
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        rgm::unpack(&p[0], &r[0], COUNT);
+        rbench::keep(r[i % COUNT]);
+    }
+}
+
+BENCHMARK(quat_copy)
+{
+    std::vector<rgm::quat> q = rotations();
+    std::vector<rgm::quat> r(COUNT);
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        std::copy(q.begin(), q.end(), r.begin());
+        rbench::keep(r[i % COUNT]);
+    }
+}
+
+BENCHMARK(quat48_pack)
+{
+    std::vector<rgm::quat>   q = rotations();
+    std::vector<rgm::quat48> r(COUNT);
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        rgm::pack(&q[0], &r[0], COUNT);
+        rbench::keep(r[i % COUNT]);
+    }
+}
+
+BENCHMARK(quat48_unpack)
+{
+    std::vector<rgm::quat>   q = rotations();
+    std::vector<rgm::quat48> p(COUNT);
+    std::vector<rgm::quat>   r(COUNT);
+    rgm::pack(&q[0], &p[0], COUNT);
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        rgm::unpack(&p[0], &r[0], COUNT);
+        rbench::keep(r[i % COUNT]);
+    }
+}
@@ -0,0 +1,169 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "rbench.h"
+#include <rgm/rgm.h>
+
+#include <vector>
+
+// The batch functions on pools of 1, 2, 4 and 8 threads and on the
+// default pool, with a thread per core, to see how they scale with the
+// cores; the pool of 1 runs the same chunks on the caller. Pools larger
+// than the machine oversubscribe it and show the cost of the scheduling
+// instead. Use --filter to pick the pools, e.g. --filter=cores_.
+
+namespace
+{
+    const unsigned int COUNT = 1 << 20;
+    const unsigned int BONES = 64;
+
+    // N threads, or all cores for N = 0
+    template <unsigned int N>
+    rgm::thread_pool& pool()
+    {
+        static rgm::thread_pool p(N - 1);
+        return p;
+    }
+
+    template <>
+    rgm::thread_pool& pool<0>()
+    {
+        return rgm::default_thread_pool();
+    }
+
+    struct scene
+    {
+        std::vector<rgm::vector<float, 3>>  points;
+        rgm::vector_stream<float, 3>        positions;
+        rgm::vector_stream<float, 3>        normals;
+        rgm::vector_stream<float, 4>        spheres;
+        rgm::vector_stream<unsigned int, 4> indices;
+        rgm::vector_stream<float, 4>        weights;
+        std::vector<rgm::dualquat>          bones;
+        rgm::frustum_planes<float>          frustum;
+
+        scene()
+        : points(COUNT), positions(COUNT), normals(COUNT), spheres(COUNT), indices(COUNT), weights(COUNT), bones(BONES),
+          frustum(rgm::perspective(60.0f, 1.5f, 1.0f, 500.0f))
+        {
+            for (unsigned int i = 0; i < COUNT; i++)
+            {
+                rgm::vec3 p((float)(i % 401) - 200, (float)(i % 397) - 198, -(float)(i % 499));
+                points[i] = p;
+                positions.set(i, p);
+                normals.set(i, rgm::normalize(rgm::vec3(1, (float)(i % 7), -1)));
+                spheres.set(i, rgm::vec4(p, (float)(i % 5)));
+                indices.set(i, rgm::vector4<unsigned int>(i % BONES, (i + 1) % BONES, (i + 7) % BONES, (i + 13) % BONES));
+                weights.set(i, rgm::vec4(0.4f, 0.3f, 0.2f, 0.1f));
+            }
+            for (unsigned int i = 0; i < BONES; i++)
+            {
+                bones[i] = rgm::dualquat(rgm::axis_angle(rgm::vec3(1, (float)i, 2), (float)(5 * i)), rgm::vec3((float)i, 0, 1));
+            }
+        }
+    };
+
+    const scene& sample()
+    {
+        static scene s;
+        return s;
+    }
+
+    template <unsigned int N>
+    void transform_points(unsigned int iterations)
+    {
+        const scene& s = sample();
+        std::vector<rgm::vector<float, 3>> r(COUNT);
+        rgm::mat4 m = rgm::translate(rgm::mat4(1), rgm::vec3(1, 2, 3));
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            rgm::transform_points(pool<N>(), m, &s.points[0], &r[0], COUNT);
+            rbench::keep(r[i % COUNT]);
+        }
+    }
+
+    template <unsigned int N>
+    void transform_normals(unsigned int iterations)
+    {
+        const scene& s = sample();
+        rgm::vector_stream<float, 3> r;
+        rgm::mat3 n = rgm::normal_matrix(rgm::scale(rgm::mat4(1), rgm::vec3(1, 2, 3)));
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            rgm::transform_normals(pool<N>(), n, s.normals, r);
+            rbench::keep(r.lane(0)[i % COUNT]);
+        }
+    }
+
+    template <unsigned int N>
+    void cull(unsigned int iterations)
+    {
+        const scene& s = sample();
+        std::vector<unsigned int> r;
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            rgm::visible_indices(pool<N>(), s.frustum, s.spheres, r);
+            rbench::keep(r[i % r.size()]);
+        }
+    }
+
+    template <unsigned int N>
+    void skin(unsigned int iterations)
+    {
+        const scene& s = sample();
+        rgm::vector_stream<float, 3> rp;
+        rgm::vector_stream<float, 3> rn;
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            rgm::skin(pool<N>(), &s.bones[0], s.indices, s.weights, s.positions, s.normals, rp, rn);
+            rbench::keep(rp.lane(0)[i % COUNT]);
+        }
+    }
+
+    // the scheduling alone: COUNT / 1024 chunks of almost no work
+    template <unsigned int N>
+    void schedule(unsigned int iterations)
+    {
+        std::vector<unsigned int> r(COUNT / 1024);
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            rgm::parallel_for(pool<N>(), 0, COUNT, 1024, [&] (size_t b, size_t) { r[b / 1024]++; });
+            rbench::keep(r[i % r.size()]);
+        }
+    }
+}
+
+#define PARALLEL_BENCHMARKS(P, N)                                                           \
+    BENCHMARK(P ## _transform_points)  { transform_points<N>(iterations); }                  \
+    BENCHMARK(P ## _transform_normals) { transform_normals<N>(iterations); }                 \
+    BENCHMARK(P ## _cull_indices)      { cull<N>(iterations); }                              \
+    BENCHMARK(P ## _skin)              { skin<N>(iterations); }                              \
+    BENCHMARK(P ## _schedule)          { schedule<N>(iterations); }
+
+PARALLEL_BENCHMARKS(threads1, 1)
+PARALLEL_BENCHMARKS(threads2, 2)
+PARALLEL_BENCHMARKS(threads4, 4)
+PARALLEL_BENCHMARKS(threads8, 8)
+PARALLEL_BENCHMARKS(cores, 0)
@@ -0,0 +1,215 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "rbench.h"
+#include <rgm/rgm.h>
+
+#include <cstdlib>
+#include <vector>
+
+// Each iteration projects COUNT points to window coordinates, or
+// generates the rays of a SIZE x SIZE rectangle of pixels.
+
+namespace
+{
+    const unsigned int COUNT = 1024;
+    const unsigned int SIZE  = 256;
+
+    template <typename T>
+    std::vector<rgm::vector<T, 3>> points()
+    {
+        std::srand(0);
+        std::vector<rgm::vector<T, 3>> r(COUNT);
+        for (unsigned int i = 0; i < COUNT; i++)
+        {
+            for (unsigned int j = 0; j < 3; j++)
+            {
+                r[i][j] = (T)std::rand() / (T)RAND_MAX * 20 - 10;
+            }
+        }
+        return r;
+    }
+
+    template <typename T>
+    rgm::matrix<T, 4> projection()
+    {
+        return rgm::perspective<T>(60, T(16) / T(9), T(0.1), 100);
+    }
+
+    template <typename T>
+    rgm::matrix<T, 4> view()
+    {
+        return rgm::translate(rgm::matrix<T, 4>(1), rgm::vector<T, 3>(rgm::vector3<T>(0, -2, -20)));
+    }
+
+    template <typename T>
+    rgm::vector<T, 4> viewport()
+    {
+        return rgm::vector4<T>(0, 0, 1920, 1080);
+    }
+
+    template <typename T>
+    void project_each(unsigned int iterations)
+    {
+        std::vector<rgm::vector<T, 3>> p = points<T>();
+        std::vector<rgm::vector<T, 3>> r(COUNT);
+        rgm::matrix<T, 4> pm = projection<T>();
+        rgm::matrix<T, 4> vm = view<T>();
+        rgm::vector<T, 4> vp = viewport<T>();
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            for (unsigned int j = 0; j < COUNT; j++)
+            {
+                r[j] = rgm::project(p[j], pm, vm, vp);
+            }
+            rbench::keep(r[i % COUNT]);
+        }
+    }
+
+    template <typename T>
+    void project_points(unsigned int iterations)
+    {
+        std::vector<rgm::vector<T, 3>> p = points<T>();
+        std::vector<rgm::vector<T, 3>> r(COUNT);
+        std::vector<unsigned int>      f(COUNT);
+        rgm::projector<T> pr(projection<T>(), view<T>(), viewport<T>());
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            pr.project_points(&p[0], &r[0], &f[0], COUNT);
+            rbench::keep(r[i % COUNT]);
+        }
+    }
+
+    template <typename T>
+    void project_stream(unsigned int iterations)
+    {
+        std::vector<rgm::vector<T, 3>> p = points<T>();
+        rgm::vector_stream<T, 3> s(&p[0], COUNT);
+        rgm::vector_stream<T, 3> r;
+        std::vector<unsigned int> f;
+        rgm::projector<T> pr(projection<T>(), view<T>(), viewport<T>());
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            pr.project_points(s, r, f);
+            rbench::keep(f[i % COUNT]);
+        }
+    }
+
+    // a ray per pixel with unproject() for the near and far point
+    template <typename T>
+    void rays_unproject(unsigned int iterations)
+    {
+        std::vector<rgm::ray<T>> r(SIZE * SIZE);
+        rgm::matrix<T, 4> pm = projection<T>();
+        rgm::matrix<T, 4> vm = view<T>();
+        rgm::vector<T, 4> vp = viewport<T>();
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            for (unsigned int y = 0; y < SIZE; y++)
+            {
+                for (unsigned int x = 0; x < SIZE; x++)
+                {
+                    rgm::vector<T, 3> n = rgm::unproject(rgm::vector<T, 3>(rgm::vector3<T>(T(x) + T(0.5), T(y) + T(0.5), 0)), pm, vm, vp);
+                    rgm::vector<T, 3> f = rgm::unproject(rgm::vector<T, 3>(rgm::vector3<T>(T(x) + T(0.5), T(y) + T(0.5), 1)), pm, vm, vp);
+                    r[y * SIZE + x] = rgm::ray<T>(n, rgm::normalize(f - n));
+                }
+            }
+            rbench::keep(r[i % r.size()]);
+        }
+    }
+
+    template <typename T>
+    void rays_pick(unsigned int iterations)
+    {
+        std::vector<rgm::ray<T>> r(SIZE * SIZE);
+        rgm::unprojector<T> u(projection<T>(), view<T>(), viewport<T>());
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            for (unsigned int y = 0; y < SIZE; y++)
+            {
+                for (unsigned int x = 0; x < SIZE; x++)
+                {
+                    r[y * SIZE + x] = u.pick(T(x) + T(0.5), T(y) + T(0.5));
+                }
+            }
+            rbench::keep(r[i % r.size()]);
+        }
+    }
+
+    template <typename T>
+    void rays_array(unsigned int iterations)
+    {
+        std::vector<rgm::ray<T>> r(SIZE * SIZE);
+        rgm::unprojector<T> u(projection<T>(), view<T>(), viewport<T>());
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            u.rays(0, 0, SIZE, SIZE, &r[0]);
+            rbench::keep(r[i % r.size()]);
+        }
+    }
+
+    template <typename T>
+    void rays_stream(unsigned int iterations)
+    {
+        rgm::vector_stream<T, 3> o;
+        rgm::vector_stream<T, 3> d;
+        rgm::unprojector<T> u(projection<T>(), view<T>(), viewport<T>());
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            u.rays(0, 0, SIZE, SIZE, o, d);
+            rbench::keep(d.lane(0)[i % d.size()]);
+        }
+    }
+
+    template <typename T>
+    void rays_stream_pool(unsigned int iterations)
+    {
+        static rgm::thread_pool pool;
+        rgm::vector_stream<T, 3> o;
+        rgm::vector_stream<T, 3> d;
+        rgm::unprojector<T> u(projection<T>(), view<T>(), viewport<T>());
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            u.rays(pool, 0, 0, SIZE, SIZE, o, d);
+            rbench::keep(d.lane(0)[i % d.size()]);
+        }
+    }
+}
+
+BENCHMARK(vec3_project_each)     { project_each<float>(iterations); }
+BENCHMARK(vec3_project_points)   { project_points<float>(iterations); }
+BENCHMARK(vec3_project_stream)   { project_stream<float>(iterations); }
+BENCHMARK(dvec3_project_each)    { project_each<double>(iterations); }
+BENCHMARK(dvec3_project_points)  { project_points<double>(iterations); }
+BENCHMARK(dvec3_project_stream)  { project_stream<double>(iterations); }
+
+BENCHMARK(rays_unproject)        { rays_unproject<float>(iterations); }
+BENCHMARK(rays_pick)             { rays_pick<float>(iterations); }
+BENCHMARK(rays_array)            { rays_array<float>(iterations); }
+BENCHMARK(rays_stream)           { rays_stream<float>(iterations); }
+BENCHMARK(rays_stream_pool)      { rays_stream_pool<float>(iterations); }
+BENCHMARK(drays_unproject)       { rays_unproject<double>(iterations); }
+BENCHMARK(drays_array)           { rays_array<double>(iterations); }
+BENCHMARK(drays_stream)          { rays_stream<double>(iterations); }
@@ -0,0 +1,130 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "rbench.h"
+#include <rgm/rgm.h>
+
+#include <vector>
+#include <cstdlib>
+
+namespace
+{
+    const unsigned int COUNT = 1024;
+
+    template <typename T>
+    T random()
+    {
+        return (T)std::rand() / (T)RAND_MAX - (T)0.5;
+    }
+
+    template <typename T>
+    const std::vector<rgm::quaterion<T>>& quaternions(unsigned int seed)
+    {
+        static std::vector<rgm::quaterion<T>> data[2];
+        std::vector<rgm::quaterion<T>>& r = data[seed];
+        if (r.empty())
+        {
+            std::srand(seed);
+            r.resize(COUNT);
+            for (unsigned int i = 0; i < COUNT; i++)
+            {
+                r[i] = rgm::normalize(rgm::vector4<T>(random<T>(), random<T>(), random<T>(), random<T>()));
+            }
+        }
+        return r;
+    }
+
+    template <typename T>
+    const std::vector<rgm::vector<T, 3>>& directions()
+    {
+        static std::vector<rgm::vector<T, 3>> r;
+        if (r.empty())
+        {
+            r.resize(COUNT);
+            for (unsigned int i = 0; i < COUNT; i++)
+            {
+                r[i] = rgm::vector3<T>(random<T>(), random<T>(), random<T>());
+            }
+        }
+        return r;
+    }
+
+    template <typename T, typename F>
+    void quat_unary(unsigned int iterations, F f)
+    {
+        const std::vector<rgm::quaterion<T>>& a = quaternions<T>(0);
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            auto r = f(a[i % COUNT]);
+            rbench::keep(r);
+        }
+    }
+
+    template <typename T, typename F>
+    void quat_quat(unsigned int iterations, F f)
+    {
+        const std::vector<rgm::quaterion<T>>& a = quaternions<T>(0);
+        const std::vector<rgm::quaterion<T>>& b = quaternions<T>(1);
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            auto r = f(a[i % COUNT], b[i % COUNT]);
+            rbench::keep(r);
+        }
+    }
+
+    template <typename T, typename F>
+    void quat_vector(unsigned int iterations, F f)
+    {
+        const std::vector<rgm::quaterion<T>>& a = quaternions<T>(0);
+        const std::vector<rgm::vector<T, 3>>& b = directions<T>();
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            auto r = f(a[i % COUNT], b[i % COUNT]);
+            rbench::keep(r);
+        }
+    }
+}
+
+#define QUATERNION_BENCHMARKS(P, T)                                                                                                          \
+    BENCHMARK(P ## _mul)             { quat_quat<T>(iterations, [] (const auto& a, const auto& b) { return a * b; }); }                      \
+    BENCHMARK(P ## _conjugate)       { quat_unary<T>(iterations, [] (const auto& a) { return rgm::conjugate(a); }); }                        \
+    BENCHMARK(P ## _inverse)         { quat_unary<T>(iterations, [] (const auto& a) { return rgm::inverse(a); }); }                          \
+    BENCHMARK(P ## _normalize)       { quat_unary<T>(iterations, [] (const auto& a) { return rgm::normalize(a); }); }                        \
+    BENCHMARK(P ## _quat2mat4)       { quat_unary<T>(iterations, [] (const auto& a) { return rgm::quat2mat4(a); }); }                        \
+    BENCHMARK(P ## _transform)       { quat_vector<T>(iterations, [] (const auto& a, const auto& b) { return rgm::transform(a, b); }); }     \
+    BENCHMARK(P ## _axis_angle)      { quat_vector<T>(iterations, [] (const auto& a, const auto& b) { return rgm::axis_angle(b, a[3]); }); }
+
+QUATERNION_BENCHMARKS(quat, float)
+QUATERNION_BENCHMARKS(dquat, double)
+
+BENCHMARK(quat_quatfromvectors)
+{
+    const std::vector<rgm::vector<float, 3>>& a = directions<float>();
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        auto r = rgm::quatfromvectors(a[i % COUNT], a[(i + 1) % COUNT]);
+        rbench::keep(r);
+    }
+}
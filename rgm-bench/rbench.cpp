@@ -0,0 +1,221 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "rbench.h"
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+namespace rbench
+{
+    std::vector<impl::Benchmark*>& get_benchmarks()
+    {
+        static std::vector<impl::Benchmark*> benchmarks;
+        return benchmarks;
+    }
+
+    struct Options
+    {
+        std::string  format      = "text";
+        std::string  filter;
+        unsigned int repetitions = 10;
+        double       min_time    = 10e6;
+    };
+
+    struct Result
+    {
+        const char*  name;
+        unsigned int iterations;
+        double       mean;
+        double       stddev;
+        double       min;
+        double       max;
+    };
+
+    double measure(impl::Benchmark* benchmark, unsigned int iterations)
+    {
+        auto start = std::chrono::steady_clock::now();
+        benchmark->run(iterations);
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count();
+    }
+
+    Result measure(impl::Benchmark* benchmark, const Options& options)
+    {
+        // grow the iteration count until one run is long enough to time;
+        // this also warms up caches and clocks
+        unsigned int iterations = 100;
+        double       time       = measure(benchmark, iterations);
+        while (time < options.min_time && iterations < (1u << 30))
+        {
+            iterations *= 2;
+            time = measure(benchmark, iterations);
+        }
+        measure(benchmark, iterations);
+
+        std::vector<double> times(options.repetitions);
+        for (unsigned int i = 0; i < options.repetitions; i++)
+        {
+            times[i] = measure(benchmark, iterations) / iterations;
+        }
+
+        Result r;
+        r.name       = benchmark->name;
+        r.iterations = iterations;
+        r.min        = *std::min_element(times.begin(), times.end());
+        r.max        = *std::max_element(times.begin(), times.end());
+        r.mean       = 0;
+        for (double t : times)
+        {
+            r.mean += t;
+        }
+        r.mean /= times.size();
+        r.stddev = 0;
+        for (double t : times)
+        {
+            r.stddev += (t - r.mean) * (t - r.mean);
+        }
+        r.stddev = times.size() > 1 ? std::sqrt(r.stddev / (times.size() - 1)) : 0.0;
+        return r;
+    }
+
+    void print_header(const Options& options)
+    {
+        if (options.format == "csv")
+        {
+            std::cout << "name,iterations,repetitions,mean_ns,stddev_ns,min_ns,max_ns" << std::endl;
+        }
+        else if (options.format == "json")
+        {
+            std::cout << "{\n  \"repetitions\": " << options.repetitions << ",\n  \"benchmarks\": [";
+        }
+    }
+
+    void print(const Result& r, const Options& options, bool first)
+    {
+        if (options.format == "csv")
+        {
+            std::cout << r.name << "," << r.iterations << "," << options.repetitions << ","
+                      << r.mean << "," << r.stddev << "," << r.min << "," << r.max << std::endl;
+        }
+        else if (options.format == "json")
+        {
+            std::cout << (first ? "\n" : ",\n")
+                      << "    {\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+                      << ", \"mean_ns\": " << r.mean << ", \"stddev_ns\": " << r.stddev
+                      << ", \"min_ns\": " << r.min << ", \"max_ns\": " << r.max << "}";
+        }
+        else
+        {
+            std::cout << r.name << ": " << r.mean << " ns +- " << r.stddev
+                      << " (min " << r.min << ", max " << r.max << ")" << std::endl;
+        }
+    }
+
+    void print_footer(const Options& options)
+    {
+        if (options.format == "json")
+        {
+            std::cout << "\n  ]\n}" << std::endl;
+        }
+    }
+
+    bool parse(int argc, char* argv[], Options& options)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            size_t      eq  = arg.find('=');
+            std::string key = arg.substr(0, eq);
+            std::string val = eq == std::string::npos ? std::string() : arg.substr(eq + 1);
+
+            if (key == "--format" && (val == "text" || val == "csv" || val == "json"))
+            {
+                options.format = val;
+            }
+            else if (key == "--filter")
+            {
+                options.filter = val;
+            }
+            else if (key == "--repetitions" && std::atoi(val.c_str()) > 0)
+            {
+                options.repetitions = std::atoi(val.c_str());
+            }
+            else if (key == "--min-time" && std::atof(val.c_str()) > 0)
+            {
+                options.min_time = std::atof(val.c_str()) * 1e6;
+            }
+            else
+            {
+                std::cerr << "usage: " << argv[0] << " [--format=text|csv|json] [--filter=TEXT] [--repetitions=N] [--min-time=MS]" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int run(int argc, char* argv[])
+    {
+        Options options;
+        if (!parse(argc, argv, options))
+        {
+            return -1;
+        }
+
+        std::vector<impl::Benchmark*>& benchmarks = get_benchmarks();
+
+        print_header(options);
+        bool first = true;
+        for (unsigned int i = 0; i < benchmarks.size(); i++)
+        {
+            if (std::strstr(benchmarks[i]->name, options.filter.c_str()) == nullptr)
+            {
+                continue;
+            }
+            print(measure(benchmarks[i], options), options, first);
+            first = false;
+        }
+        print_footer(options);
+
+        return 0;
+    }
+
+    namespace impl
+    {
+        Benchmark::Benchmark(const char* n, const char* f, unsigned int l)
+        {
+            name = n;
+            file = f;
+            line = l;
+            get_benchmarks().push_back(this);
+        }
+    }
+}
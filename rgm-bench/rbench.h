@@ -0,0 +1,75 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#ifndef _RBENCH_H_
+#define _RBENCH_H_
+
+namespace rbench
+{
+    // Runs the benchmarks and prints the time per iteration; see the README
+    // for the command line options.
+    int run(int argc, char* argv[]);
+
+    namespace impl
+    {
+        struct Benchmark
+        {
+            const char*  name;
+            const char*  file;
+            unsigned int line;
+
+            Benchmark(const char* name, const char* file, unsigned int line);
+
+            virtual void run(unsigned int iterations) = 0;
+        };
+    }
+
+    // Make the optimizer believe the value is used, so that the code
+    // computing it is not removed from the benchmark loop.
+    template <typename T>
+    inline void keep(T& value)
+    {
+#if defined(__GNUC__)
+        asm volatile("" : : "g"(&value) : "memory");
+#else
+        static const void* volatile sink;
+        sink = &value;
+#endif
+    }
+}
+
+#define BENCHMARK(NAME)                                                                            \
+    struct Benchmark_ ## NAME : public ::rbench::impl::Benchmark                                   \
+    {                                                                                              \
+        Benchmark_ ## NAME()                                                                       \
+        : Benchmark(#NAME, __FILE__, __LINE__) {}                                                  \
+                                                                                                   \
+        void run(unsigned int iterations);                                                         \
+                                                                                                   \
+    } benchmark_ ## NAME;                                                                          \
+                                                                                                   \
+    void Benchmark_ ## NAME ::run(unsigned int iterations)
+
+#endif
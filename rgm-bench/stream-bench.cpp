@@ -0,0 +1,304 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "rbench.h"
+#include <rgm/rgm.h>
+
+#include <vector>
+#include <cstdlib>
+
+// Each iteration processes COUNT vectors, once as an array of vectors with
+// the vector functions and once as a vector_stream with the batch functions.
+
+namespace
+{
+    const unsigned int COUNT = 1024;
+
+    template <typename T, unsigned int N>
+    const std::vector<rgm::vector<T, N>>& values(unsigned int seed)
+    {
+        static std::vector<rgm::vector<T, N>> data[2];
+        std::vector<rgm::vector<T, N>>& r = data[seed];
+        if (r.empty())
+        {
+            std::srand(seed);
+            r.resize(COUNT);
+            for (unsigned int i = 0; i < COUNT; i++)
+            {
+                for (unsigned int j = 0; j < N; j++)
+                {
+                    r[i][j] = (T)std::rand() / (T)RAND_MAX + (T)0.1;
+                }
+            }
+        }
+        return r;
+    }
+
+    template <typename T, unsigned int N>
+    const rgm::vector_stream<T, N>& stream(unsigned int seed)
+    {
+        static rgm::vector_stream<T, N> data[2];
+        rgm::vector_stream<T, N>& r = data[seed];
+        if (r.size() == 0)
+        {
+            r.load(&values<T, N>(seed)[0], COUNT);
+        }
+        return r;
+    }
+
+    template <typename T>
+    const std::vector<rgm::quaterion<T>>& rotations(unsigned int seed)
+    {
+        static std::vector<rgm::quaterion<T>> data[2];
+        std::vector<rgm::quaterion<T>>& r = data[seed];
+        if (r.empty())
+        {
+            const std::vector<rgm::vector<T, 4>>& v = values<T, 4>(seed);
+            r.resize(COUNT);
+            for (unsigned int i = 0; i < COUNT; i++)
+            {
+                r[i] = rgm::normalize(v[i] - rgm::vector<T, 4>((T)0.6));
+            }
+        }
+        return r;
+    }
+
+    template <typename T>
+    const rgm::vector_stream<T, 4>& rotation_stream(unsigned int seed)
+    {
+        static rgm::vector_stream<T, 4> data[2];
+        rgm::vector_stream<T, 4>& r = data[seed];
+        if (r.size() == 0)
+        {
+            r.load(&rotations<T>(seed)[0], COUNT);
+        }
+        return r;
+    }
+
+    template <typename T, typename F>
+    void interpolate_aos(unsigned int iterations, F f)
+    {
+        const std::vector<rgm::quaterion<T>>& a = rotations<T>(0);
+        const std::vector<rgm::quaterion<T>>& b = rotations<T>(1);
+        std::vector<rgm::quaterion<T>> r(COUNT);
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            for (unsigned int j = 0; j < COUNT; j++)
+            {
+                r[j] = f(a[j], b[j], (T)0.3);
+            }
+            rbench::keep(r[i % COUNT]);
+        }
+    }
+
+    template <typename T, typename F>
+    void interpolate_stream(unsigned int iterations, F f)
+    {
+        const rgm::vector_stream<T, 4>& a = rotation_stream<T>(0);
+        const rgm::vector_stream<T, 4>& b = rotation_stream<T>(1);
+        rgm::vector_stream<T, 4> r;
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            f(a, b, (T)0.3, r);
+            rbench::keep(r.lane(0)[i % COUNT]);
+        }
+    }
+}
+
+BENCHMARK(vec3_normalize_aos)
+{
+    const std::vector<rgm::vector<float, 3>>& a = values<float, 3>(0);
+    std::vector<rgm::vector<float, 3>> r(COUNT);
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        for (unsigned int j = 0; j < COUNT; j++)
+        {
+            r[j] = rgm::normalize(a[j]);
+        }
+        rbench::keep(r[i % COUNT]);
+    }
+}
+
+BENCHMARK(vec3_normalize_stream)
+{
+    const rgm::vec3_stream& a = stream<float, 3>(0);
+    rgm::vec3_stream r;
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        rgm::normalize(a, r);
+        rbench::keep(r.lane(0)[i % COUNT]);
+    }
+}
+
+BENCHMARK(vec3_normalize_fast_aos)
+{
+    const std::vector<rgm::vector<float, 3>>& a = values<float, 3>(0);
+    std::vector<rgm::vector<float, 3>> r(COUNT);
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        for (unsigned int j = 0; j < COUNT; j++)
+        {
+            r[j] = rgm::normalize_fast(a[j]);
+        }
+        rbench::keep(r[i % COUNT]);
+    }
+}
+
+BENCHMARK(vec3_normalize_fast_stream)
+{
+    const rgm::vec3_stream& a = stream<float, 3>(0);
+    rgm::vec3_stream r;
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        rgm::normalize_fast(a, r);
+        rbench::keep(r.lane(0)[i % COUNT]);
+    }
+}
+
+BENCHMARK(vec3_transform_normals_aos)
+{
+    const std::vector<rgm::vector<float, 3>>& a = values<float, 3>(0);
+    std::vector<rgm::vector<float, 3>> r(COUNT);
+    rgm::mat3 n = rgm::normal_matrix(rgm::scale(rgm::rotate(rgm::mat4(1), rgm::vec3(0, 1, 0), 0.5f), rgm::vec3(1, 2, 3)));
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        for (unsigned int j = 0; j < COUNT; j++)
+        {
+            r[j] = rgm::normalize(n * a[j]);
+        }
+        rbench::keep(r[i % COUNT]);
+    }
+}
+
+BENCHMARK(vec3_transform_normals_stream)
+{
+    const rgm::vec3_stream& a = stream<float, 3>(0);
+    rgm::vec3_stream r;
+    rgm::mat3 n = rgm::normal_matrix(rgm::scale(rgm::rotate(rgm::mat4(1), rgm::vec3(0, 1, 0), 0.5f), rgm::vec3(1, 2, 3)));
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        rgm::transform_normals(n, a, r);
+        rbench::keep(r.lane(0)[i % COUNT]);
+    }
+}
+
+BENCHMARK(vec3_cross_aos)
+{
+    const std::vector<rgm::vector<float, 3>>& a = values<float, 3>(0);
+    const std::vector<rgm::vector<float, 3>>& b = values<float, 3>(1);
+    std::vector<rgm::vector<float, 3>> r(COUNT);
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        for (unsigned int j = 0; j < COUNT; j++)
+        {
+            r[j] = rgm::cross(a[j], b[j]);
+        }
+        rbench::keep(r[i % COUNT]);
+    }
+}
+
+BENCHMARK(vec3_cross_stream)
+{
+    const rgm::vec3_stream& a = stream<float, 3>(0);
+    const rgm::vec3_stream& b = stream<float, 3>(1);
+    rgm::vec3_stream r;
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        rgm::cross(a, b, r);
+        rbench::keep(r.lane(0)[i % COUNT]);
+    }
+}
+
+BENCHMARK(vec4_dot_aos)
+{
+    const std::vector<rgm::vector<float, 4>>& a = values<float, 4>(0);
+    const std::vector<rgm::vector<float, 4>>& b = values<float, 4>(1);
+    std::vector<float> r(COUNT);
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        for (unsigned int j = 0; j < COUNT; j++)
+        {
+            r[j] = rgm::dot(a[j], b[j]);
+        }
+        rbench::keep(r[i % COUNT]);
+    }
+}
+
+BENCHMARK(vec4_dot_stream)
+{
+    const rgm::vec4_stream& a = stream<float, 4>(0);
+    const rgm::vec4_stream& b = stream<float, 4>(1);
+    rgm::float_stream r;
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        rgm::dot(a, b, r);
+        rbench::keep(r.lane(0)[i % COUNT]);
+    }
+}
+
+BENCHMARK(dvec3_normalize_aos)
+{
+    const std::vector<rgm::vector<double, 3>>& a = values<double, 3>(0);
+    std::vector<rgm::vector<double, 3>> r(COUNT);
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        for (unsigned int j = 0; j < COUNT; j++)
+        {
+            r[j] = rgm::normalize(a[j]);
+        }
+        rbench::keep(r[i % COUNT]);
+    }
+}
+
+BENCHMARK(dvec3_normalize_stream)
+{
+    const rgm::dvec3_stream& a = stream<double, 3>(0);
+    rgm::dvec3_stream r;
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        rgm::normalize(a, r);
+        rbench::keep(r.lane(0)[i % COUNT]);
+    }
+}
+
+BENCHMARK(vec3_aos_to_stream)
+{
+    const std::vector<rgm::vector<float, 3>>& a = values<float, 3>(0);
+    rgm::vec3_stream r;
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        r.load(&a[0], COUNT);
+        rbench::keep(r.lane(0)[i % COUNT]);
+    }
+}
+
+#define INTERPOLATION_BENCHMARKS(P, T)                                                                                                                 \
+    BENCHMARK(P ## _slerp_aos)    { interpolate_aos<T>(iterations, [] (const auto& a, const auto& b, T t) { return rgm::slerp(a, b, t); }); }          \
+    BENCHMARK(P ## _slerp_stream) { interpolate_stream<T>(iterations, [] (const auto& a, const auto& b, T t, auto& r) { rgm::slerp(a, b, t, r); }); }  \
+    BENCHMARK(P ## _nlerp_aos)    { interpolate_aos<T>(iterations, [] (const auto& a, const auto& b, T t) { return rgm::nlerp(a, b, t); }); }          \
+    BENCHMARK(P ## _nlerp_stream) { interpolate_stream<T>(iterations, [] (const auto& a, const auto& b, T t, auto& r) { rgm::nlerp(a, b, t, r); }); }
+
+INTERPOLATION_BENCHMARKS(quat, float)
+INTERPOLATION_BENCHMARKS(dquat, double)
@@ -0,0 +1,199 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "rbench.h"
+#include <rgm/rgm.h>
+
+#include <vector>
+#include <cstdlib>
+
+// Every vector function is timed for float and double with 2, 3 and 4
+// elements. The ones with a SIMD version are also timed against the
+// generic loop, selected with explicit template arguments (NAME_loop).
+
+namespace
+{
+    const unsigned int COUNT = 1024;
+
+    template <typename T, unsigned int N>
+    const std::vector<rgm::vector<T, N>>& values(unsigned int seed)
+    {
+        static std::vector<rgm::vector<T, N>> data[3];
+        std::vector<rgm::vector<T, N>>& r = data[seed];
+        if (r.empty())
+        {
+            std::srand(seed);
+            r.resize(COUNT);
+            for (unsigned int i = 0; i < COUNT; i++)
+            {
+                for (unsigned int j = 0; j < N; j++)
+                {
+                    r[i][j] = (T)std::rand() / (T)RAND_MAX + (T)0.1;
+                }
+            }
+        }
+        return r;
+    }
+
+    template <typename T, unsigned int N, typename F>
+    void unary(unsigned int iterations, F f)
+    {
+        const std::vector<rgm::vector<T, N>>& a = values<T, N>(0);
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            auto r = f(a[i % COUNT]);
+            rbench::keep(r);
+        }
+    }
+
+    template <typename T, unsigned int N, typename F>
+    void binary(unsigned int iterations, F f)
+    {
+        const std::vector<rgm::vector<T, N>>& a = values<T, N>(0);
+        const std::vector<rgm::vector<T, N>>& b = values<T, N>(1);
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            auto r = f(a[i % COUNT], b[i % COUNT]);
+            rbench::keep(r);
+        }
+    }
+
+    template <typename T, unsigned int N, typename F>
+    void ternary(unsigned int iterations, F f)
+    {
+        const std::vector<rgm::vector<T, N>>& a = values<T, N>(0);
+        const std::vector<rgm::vector<T, N>>& b = values<T, N>(1);
+        const std::vector<rgm::vector<T, N>>& c = values<T, N>(2);
+        for (unsigned int i = 0; i < iterations; i++)
+        {
+            auto r = f(a[i % COUNT], b[i % COUNT], c[i % COUNT]);
+            rbench::keep(r);
+        }
+    }
+}
+
+BENCHMARK(vec4_add_loop)
+{
+    binary<float, 4>(iterations, [] (const auto& a, const auto& b) { return rgm::operator + <float, 4>(a, b); });
+}
+
+BENCHMARK(vec4_mul_loop)
+{
+    binary<float, 4>(iterations, [] (const auto& a, const auto& b) { return rgm::operator * <float, 4>(a, b); });
+}
+
+BENCHMARK(vec4_dot_loop)
+{
+    binary<float, 4>(iterations, [] (const auto& a, const auto& b) { return rgm::dot<float, 4>(a, b); });
+}
+
+BENCHMARK(vec4_min_loop)
+{
+    binary<float, 4>(iterations, [] (const auto& a, const auto& b) { return rgm::min<float, 4>(a, b); });
+}
+
+BENCHMARK(vec4_max_loop)
+{
+    binary<float, 4>(iterations, [] (const auto& a, const auto& b) { return rgm::max<float, 4>(a, b); });
+}
+
+BENCHMARK(vec4_normalize_loop)
+{
+    unary<float, 4>(iterations, [] (const auto& a) { return rgm::normalize<float, 4>(a); });
+}
+
+BENCHMARK(vec4_mix_loop)
+{
+    ternary<float, 4>(iterations, [] (const auto& a, const auto& b, const auto& c) { return rgm::mix<float, 4>(a, b, c); });
+}
+
+BENCHMARK(vec4_clamp_loop)
+{
+    ternary<float, 4>(iterations, [] (const auto& a, const auto& b, const auto& c) { return rgm::clamp<float, 4>(a, b, b + c); });
+}
+
+BENCHMARK(vec3_add_loop)
+{
+    binary<float, 3>(iterations, [] (const auto& a, const auto& b) { return rgm::operator + <float, 3>(a, b); });
+}
+
+BENCHMARK(vec3_dot_loop)
+{
+    binary<float, 3>(iterations, [] (const auto& a, const auto& b) { return rgm::dot<float, 3>(a, b); });
+}
+
+BENCHMARK(vec3_normalize_loop)
+{
+    unary<float, 3>(iterations, [] (const auto& a) { return rgm::normalize<float, 3>(a); });
+}
+
+BENCHMARK(dvec2_add_loop)
+{
+    binary<double, 2>(iterations, [] (const auto& a, const auto& b) { return rgm::operator + <double, 2>(a, b); });
+}
+
+BENCHMARK(dvec4_add_loop)
+{
+    binary<double, 4>(iterations, [] (const auto& a, const auto& b) { return rgm::operator + <double, 4>(a, b); });
+}
+
+BENCHMARK(dvec4_mix_loop)
+{
+    ternary<double, 4>(iterations, [] (const auto& a, const auto& b, const auto& c) { return rgm::mix<double, 4>(a, b, c); });
+}
+
+#define VECTOR_BENCHMARKS(P, T, N)                                                                                                                       \
+    BENCHMARK(P ## N ## _add)       { binary<T, N>(iterations, [] (const auto& a, const auto& b) { return a + b; }); }                                   \
+    BENCHMARK(P ## N ## _sub)       { binary<T, N>(iterations, [] (const auto& a, const auto& b) { return a - b; }); }                                   \
+    BENCHMARK(P ## N ## _mul)       { binary<T, N>(iterations, [] (const auto& a, const auto& b) { return a * b; }); }                                   \
+    BENCHMARK(P ## N ## _div)       { binary<T, N>(iterations, [] (const auto& a, const auto& b) { return a / b; }); }                                   \
+    BENCHMARK(P ## N ## _scale)     { unary<T, N>(iterations, [] (const auto& a) { return a * (T)3; }); }                                                \
+    BENCHMARK(P ## N ## _neg)       { unary<T, N>(iterations, [] (const auto& a) { return -a; }); }                                                      \
+    BENCHMARK(P ## N ## _dot)       { binary<T, N>(iterations, [] (const auto& a, const auto& b) { return rgm::dot(a, b); }); }                          \
+    BENCHMARK(P ## N ## _length)    { unary<T, N>(iterations, [] (const auto& a) { return rgm::length(a); }); }                                          \
+    BENCHMARK(P ## N ## _distance)  { binary<T, N>(iterations, [] (const auto& a, const auto& b) { return rgm::distance(a, b); }); }                     \
+    BENCHMARK(P ## N ## _normalize) { unary<T, N>(iterations, [] (const auto& a) { return rgm::normalize(a); }); }                                       \
+    BENCHMARK(P ## N ## _min)       { binary<T, N>(iterations, [] (const auto& a, const auto& b) { return rgm::min(a, b); }); }                          \
+    BENCHMARK(P ## N ## _max)       { binary<T, N>(iterations, [] (const auto& a, const auto& b) { return rgm::max(a, b); }); }                          \
+    BENCHMARK(P ## N ## _abs)       { unary<T, N>(iterations, [] (const auto& a) { return rgm::abs(a); }); }                                             \
+    BENCHMARK(P ## N ## _clamp)     { ternary<T, N>(iterations, [] (const auto& a, const auto& b, const auto& c) { return rgm::clamp(a, b, b + c); }); } \
+    BENCHMARK(P ## N ## _mix)       { ternary<T, N>(iterations, [] (const auto& a, const auto& b, const auto& c) { return rgm::mix(a, b, c); }); }
+
+VECTOR_BENCHMARKS(vec, float, 2)
+VECTOR_BENCHMARKS(vec, float, 3)
+VECTOR_BENCHMARKS(vec, float, 4)
+VECTOR_BENCHMARKS(dvec, double, 2)
+VECTOR_BENCHMARKS(dvec, double, 3)
+VECTOR_BENCHMARKS(dvec, double, 4)
+
+BENCHMARK(vec3_cross)
+{
+    binary<float, 3>(iterations, [] (const auto& a, const auto& b) { return rgm::cross(a, b); });
+}
+
+BENCHMARK(dvec3_cross)
+{
+    binary<double, 3>(iterations, [] (const auto& a, const auto& b) { return rgm::cross(a, b); });
+}
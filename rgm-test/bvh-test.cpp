@@ -0,0 +1,245 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+
+#include "rtest.h"
+#include "sample.h"
+#include <rgm/rgm.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+SUITE(bvh)
+{
+    // More than BUILD_TASK boxes, so that the top of the tree and the
+    // subtrees are built separately.
+    const size_t COUNT = 10000;
+
+    template <typename T>
+    struct scene
+    {
+        std::vector<rgm::vector<T, 3>> lower;
+        std::vector<rgm::vector<T, 3>> upper;
+
+        explicit scene(size_t count)
+        : lower(count), upper(count)
+        {
+            sample::generator g(1);
+            for (size_t i = 0; i < count; i++)
+            {
+                T v[6];
+                for (unsigned int j = 0; j < 6; j++)
+                {
+                    v[j] = g.uniform<T>(0, 100);
+                }
+                // some clusters of boxes, so that SAH has work to do
+                rgm::vector3<T> c(v[0], v[1], i % 7 == 0 ? (T)0 : v[2]);
+                rgm::vector3<T> e(v[3] / (T)50, v[4] / (T)50, v[5] / (T)50);
+                lower[i] = c - e;
+                upper[i] = c + e;
+            }
+        }
+    };
+
+    // Entry distance of r into a box in [0, t], or t if it misses.
+    template <typename T>
+    T hit_box(const rgm::ray<T>& r, const rgm::vector<T, 3>& lower, const rgm::vector<T, 3>& upper, T t)
+    {
+        T t0 = 0;
+        T t1 = t;
+        for (unsigned int j = 0; j < 3; j++)
+        {
+            T a = (lower[j] - r.origin[j]) / r.direction[j];
+            T b = (upper[j] - r.origin[j]) / r.direction[j];
+            t0  = std::max(t0, std::min(a, b));
+            t1  = std::min(t1, std::max(a, b));
+        }
+        return t0 <= t1 ? t0 : t;
+    }
+
+    template <typename T>
+    bool contains(const typename rgm::bvh<T>::node& n, const rgm::vector<T, 3>& lower, const rgm::vector<T, 3>& upper)
+    {
+        for (unsigned int j = 0; j < 3; j++)
+        {
+            if (lower[j] < n.lower[j] || upper[j] > n.upper[j])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename T>
+    void check_structure(const rgm::bvh<T>& tree, const scene<T>& s)
+    {
+        const typename rgm::bvh<T>::node* nodes = tree.nodes();
+        CHECK_EQUAL(0u, reinterpret_cast<uintptr_t>(nodes) % (8 * sizeof(T)));
+        CHECK_EQUAL(s.lower.size(), tree.indices().size());
+
+        std::vector<unsigned int> seen(s.lower.size(), 0);
+        for (size_t i = 0; i < tree.size(); i++)
+        {
+            const typename rgm::bvh<T>::node& n = nodes[i];
+            if (n.count != 0)
+            {
+                CHECK(n.count <= rgm::bvh<T>::MAX_LEAF);
+                for (unsigned int k = 0; k < n.count; k++)
+                {
+                    unsigned int p = tree.indices()[n.offset + k];
+                    seen[p]++;
+                    CHECK(contains(n, s.lower[p], s.upper[p]));
+                }
+            }
+            else
+            {
+                CHECK(n.offset > i && n.offset + 1 < tree.size());
+                for (unsigned int c = 0; c < 2; c++)
+                {
+                    const typename rgm::bvh<T>::node& child = nodes[n.offset + c];
+                    CHECK(contains(n, rgm::vector3<T>(child.lower[0], child.lower[1], child.lower[2]), rgm::vector3<T>(child.upper[0], child.upper[1], child.upper[2])));
+                }
+            }
+        }
+        CHECK(std::count(seen.begin(), seen.end(), 1u) == (std::ptrdiff_t)s.lower.size());
+    }
+
+    template <typename T>
+    void check_queries(const rgm::bvh<T>& tree, const scene<T>& s)
+    {
+        for (unsigned int i = 0; i < 20; i++)
+        {
+            rgm::ray<T> r(rgm::vector3<T>((T)-10, (T)(5 * i), (T)(3 * i)), rgm::vector3<T>((T)1, (T)0.3 - (T)0.03 * (T)i, (T)0.25));
+
+            T      t        = std::numeric_limits<T>::max();
+            size_t expected = rgm::bvh<T>::NONE;
+            for (size_t p = 0; p < s.lower.size(); p++)
+            {
+                T d = hit_box(r, s.lower[p], s.upper[p], t);
+                if (d < t)
+                {
+                    t        = d;
+                    expected = p;
+                }
+            }
+
+            T      tt  = std::numeric_limits<T>::max();
+            size_t hit = tree.raycast(r, tt, [&] (unsigned int p, T tmax) { return hit_box(r, s.lower[p], s.upper[p], tmax); });
+            CHECK_EQUAL(expected, hit);
+            CHECK_EQUAL(t, tt);
+        }
+
+        rgm::vector3<T> lower((T)20, (T)30, (T)-1);
+        rgm::vector3<T> upper((T)30, (T)45, (T)50);
+        auto overlaps = [&] (size_t p) {
+            return lower[0] <= s.upper[p][0] && lower[1] <= s.upper[p][1] && lower[2] <= s.upper[p][2] &&
+                   upper[0] >= s.lower[p][0] && upper[1] >= s.lower[p][1] && upper[2] >= s.lower[p][2];
+        };
+        std::vector<unsigned int> expected;
+        for (size_t p = 0; p < s.lower.size(); p++)
+        {
+            if (overlaps(p))
+            {
+                expected.push_back((unsigned int)p);
+            }
+        }
+        std::vector<unsigned int> found;
+        size_t candidates = 0;
+        tree.overlap(lower, upper, [&] (unsigned int p) {
+            candidates++;
+            if (overlaps(p))
+            {
+                found.push_back(p);
+            }
+        });
+        std::sort(found.begin(), found.end());
+        CHECK(!expected.empty());
+        CHECK(expected == found);
+        CHECK(candidates < 2 * expected.size());
+    }
+
+    template <typename T>
+    void check_bvh()
+    {
+        scene<T>    s(COUNT);
+        rgm::bvh<T> tree(&s.lower[0], &s.upper[0], COUNT);
+        check_structure(tree, s);
+        check_queries(tree, s);
+
+        // moved boxes, same tree
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            rgm::vector3<T> d((T)(i % 5), (T)1, -(T)(i % 3));
+            s.lower[i] = s.lower[i] + d;
+            s.upper[i] = s.upper[i] + d;
+        }
+        tree.refit(&s.lower[0], &s.upper[0]);
+        check_structure(tree, s);
+        check_queries(tree, s);
+    }
+
+    TEST(build_and_query)
+    {
+        check_bvh<float>();
+        check_bvh<double>();
+    }
+
+    TEST(parallel_build_same_as_serial)
+    {
+        scene<float>       s(COUNT);
+        rgm::thread_pool   pool(3);
+        rgm::bvh<float>    a(&s.lower[0], &s.upper[0], COUNT);
+        rgm::bvh<float>    b(pool, &s.lower[0], &s.upper[0], COUNT);
+
+        CHECK_EQUAL(a.size(), b.size());
+        CHECK(a.indices() == b.indices());
+        bool same = true;
+        for (size_t i = 0; i < a.size() && i < b.size(); i++)
+        {
+            const rgm::bvh<float>::node& x = a.nodes()[i];
+            const rgm::bvh<float>::node& y = b.nodes()[i];
+            same = same && x.count == y.count && x.offset == y.offset &&
+                   std::equal(x.lower, x.lower + 3, y.lower) && std::equal(x.upper, x.upper + 3, y.upper);
+        }
+        CHECK(same);
+    }
+
+    TEST(small_and_empty)
+    {
+        rgm::bvh<double> empty(nullptr, nullptr, 0);
+        CHECK_EQUAL(0u, empty.size());
+        double t = 100.0;
+        CHECK_EQUAL(rgm::bvh<double>::NONE, empty.raycast(rgm::ray<double>(rgm::dvec3(0, 0, 0), rgm::dvec3(1, 0, 0)), t, [] (unsigned int, double t) { return t; }));
+
+        rgm::dvec3       lower(1, -1, -1);
+        rgm::dvec3       upper(2, 1, 1);
+        rgm::bvh<double> one(&lower, &upper, 1);
+        CHECK_EQUAL(1u, one.size());
+        CHECK_EQUAL(0u, one.raycast(rgm::ray<double>(rgm::dvec3(0, 0, 0), rgm::dvec3(1, 0, 0)), t, [] (unsigned int, double) { return 1.0; }));
+        CHECK_EQUAL(1.0, t);
+    }
+}
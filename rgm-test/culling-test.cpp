@@ -0,0 +1,207 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+
+#include "rtest.h"
+#include "sample.h"
+#include <rgm/rgm.h>
+
+#include <vector>
+
+SUITE(culling)
+{
+    // 90 degree field of view, so the side planes are at 45 degrees
+    rgm::dmat4 sample_viewprojection()
+    {
+        return rgm::perspective(90.0, 1.0, 1.0, 100.0);
+    }
+
+    TEST(planes)
+    {
+        rgm::frustum_planes<double> f(sample_viewprojection());
+
+        for (unsigned int i = 0; i < 6; i++)
+        {
+            CHECK_CLOSE(1.0, rgm::length(rgm::dvec3(f[i])), 1e-12);
+        }
+        double s = std::sqrt(0.5);
+        CHECK(rgm::close(rgm::dvec4( s,  0, -s, 0), f[0], 1e-12));
+        CHECK(rgm::close(rgm::dvec4(-s,  0, -s, 0), f[1], 1e-12));
+        CHECK(rgm::close(rgm::dvec4( 0,  s, -s, 0), f[2], 1e-12));
+        CHECK(rgm::close(rgm::dvec4( 0, -s, -s, 0), f[3], 1e-12));
+        CHECK(rgm::close(rgm::dvec4( 0,  0, -1, -1), f[4], 1e-12));
+        CHECK(rgm::close(rgm::dvec4( 0,  0,  1, 100), f[5], 1e-12));
+    }
+
+    TEST(visible)
+    {
+        rgm::frustum_planes<double> f(sample_viewprojection());
+
+        CHECK(rgm::visible(f, rgm::dvec3(0, 0, -10), 0.0));
+        CHECK(!rgm::visible(f, rgm::dvec3(0, 0, 10), 1.0));
+        CHECK(rgm::visible(f, rgm::dvec3(0, 0, -0.5), 0.6));
+        CHECK(!rgm::visible(f, rgm::dvec3(0, 0, -0.5), 0.4));
+        CHECK(rgm::visible(f, rgm::dvec3(0, 0, -100.5), 0.6));
+        // 1 / sqrt(2) outside the left plane
+        CHECK(rgm::visible(f, rgm::dvec3(-11, 0, -10), 0.8));
+        CHECK(!rgm::visible(f, rgm::dvec3(-11, 0, -10), 0.6));
+
+        CHECK(rgm::visible(f, rgm::dvec3(-1, -1, -11), rgm::dvec3(1, 1, -9)));
+        CHECK(rgm::visible(f, rgm::dvec3(-11.5, -1, -10), rgm::dvec3(-9.5, 1, -10)));
+        CHECK(!rgm::visible(f, rgm::dvec3(-12, -1, -10), rgm::dvec3(-10.5, 1, -10)));
+        CHECK(!rgm::visible(f, rgm::dvec3(-1, -1, 2), rgm::dvec3(1, 1, 3)));
+    }
+
+    // 203 objects, so that the last batch and the last word are only
+    // partially used
+    template <typename T>
+    void check_batch()
+    {
+        const size_t COUNT = 203;
+
+        rgm::frustum_planes<T> f(rgm::perspective((T)60, (T)1.5, (T)1, (T)100));
+
+        rgm::vector_stream<T, 4> spheres(COUNT);
+        rgm::vector_stream<T, 3> lower(COUNT);
+        rgm::vector_stream<T, 3> upper(COUNT);
+        sample::generator g(1);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            T v[4];
+            for (unsigned int j = 0; j < 4; j++)
+            {
+                v[j] = g.uniform<T>(-100, 100, 2000);
+            }
+            rgm::vector3<T> c(v[0], v[1], v[2] / (T)2 - (T)50);
+            T               r = std::abs(v[3]) / (T)10;
+            spheres.set(i, rgm::vector4<T>(c, r));
+            lower.set(i, c - rgm::vector3<T>(r, r / (T)2, r));
+            upper.set(i, c + rgm::vector3<T>(r, r, r / (T)2));
+        }
+
+        std::vector<unsigned int> sphere_mask;
+        std::vector<unsigned int> sphere_indices;
+        std::vector<unsigned int> box_mask;
+        std::vector<unsigned int> box_indices;
+        rgm::visible_mask(f, spheres, sphere_mask);
+        rgm::visible_indices(f, spheres, sphere_indices);
+        rgm::visible_mask(f, lower, upper, box_mask);
+        rgm::visible_indices(f, lower, upper, box_indices);
+
+        CHECK_EQUAL((COUNT + 31) / 32, sphere_mask.size());
+        CHECK_EQUAL((COUNT + 31) / 32, box_mask.size());
+
+        std::vector<unsigned int> expected_sphere_mask((COUNT + 31) / 32, 0);
+        std::vector<unsigned int> expected_sphere_indices;
+        std::vector<unsigned int> expected_box_mask((COUNT + 31) / 32, 0);
+        std::vector<unsigned int> expected_box_indices;
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            rgm::vector4<T> s = spheres.get(i);
+            if (rgm::visible(f, rgm::vector3<T>(s), s[3]))
+            {
+                expected_sphere_mask[i / 32] |= 1u << (i % 32);
+                expected_sphere_indices.push_back((unsigned int)i);
+            }
+            if (rgm::visible(f, lower.get(i), upper.get(i)))
+            {
+                expected_box_mask[i / 32] |= 1u << (i % 32);
+                expected_box_indices.push_back((unsigned int)i);
+            }
+        }
+
+        // the sample must neither be all visible nor all culled
+        CHECK(expected_sphere_indices.size() > COUNT / 10 && expected_sphere_indices.size() < COUNT - COUNT / 10);
+        CHECK(expected_box_indices.size() > COUNT / 10 && expected_box_indices.size() < COUNT - COUNT / 10);
+
+        CHECK(expected_sphere_mask == sphere_mask);
+        CHECK(expected_sphere_indices == sphere_indices);
+        CHECK(expected_box_mask == box_mask);
+        CHECK(expected_box_indices == box_indices);
+    }
+
+    TEST(batch_same_as_scalar)
+    {
+        check_batch<float>();
+        check_batch<double>();
+    }
+
+    // several chunks of CULL_GRAIN, the last one partial
+    template <typename T>
+    void check_pool()
+    {
+        const size_t COUNT = 2 * rgm::CULL_GRAIN + 203;
+
+        rgm::frustum_planes<T> f(rgm::perspective((T)60, (T)1.5, (T)1, (T)100));
+
+        rgm::vector_stream<T, 4> spheres(COUNT);
+        rgm::vector_stream<T, 3> lower(COUNT);
+        rgm::vector_stream<T, 3> upper(COUNT);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            rgm::vector3<T> c((T)(i % 201) - 100, (T)(i % 67) - 33, -(T)(i % 151));
+            T               r = (T)(i % 5);
+            spheres.set(i, rgm::vector4<T>(c, r));
+            lower.set(i, c - rgm::vector3<T>(r, r, r));
+            upper.set(i, c + rgm::vector3<T>(r, r, r));
+        }
+
+        rgm::thread_pool pool(3);
+        std::vector<unsigned int> a;
+        std::vector<unsigned int> b;
+        rgm::visible_mask(f, spheres, a);
+        rgm::visible_mask(pool, f, spheres, b);
+        CHECK(a == b);
+        rgm::visible_indices(f, spheres, a);
+        rgm::visible_indices(pool, f, spheres, b);
+        CHECK(a.size() > COUNT / 10 && a.size() < COUNT - COUNT / 10);
+        CHECK(a == b);
+        rgm::visible_mask(f, lower, upper, a);
+        rgm::visible_mask(pool, f, lower, upper, b);
+        CHECK(a == b);
+        rgm::visible_indices(f, lower, upper, a);
+        rgm::visible_indices(pool, f, lower, upper, b);
+        CHECK(a == b);
+
+        // fully visible chunks, kept in place
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            spheres.set(i, rgm::vector4<T>((T)0, (T)0, (T)-10, (T)1));
+        }
+        a.resize(COUNT);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            a[i] = (unsigned int)i;
+        }
+        rgm::visible_indices(pool, f, spheres, b);
+        CHECK(a == b);
+    }
+
+    TEST(pool_same_as_serial)
+    {
+        check_pool<float>();
+        check_pool<double>();
+    }
+}
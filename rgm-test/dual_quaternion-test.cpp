@@ -0,0 +1,187 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "rtest.h"
+#include <rgm/rgm.h>
+
+#include <vector>
+
+SUITE(dual_quaternion)
+{
+    rgm::ddualquat sample(double angle, const rgm::dvec3& axis, const rgm::dvec3& t)
+    {
+        return rgm::ddualquat(rgm::axis_angle(axis, angle), t);
+    }
+
+    rgm::dmat4 sample_matrix(double angle, const rgm::dvec3& axis, const rgm::dvec3& t)
+    {
+        return rgm::rotate(rgm::translate(rgm::dmat4(1.0), t), axis, angle);
+    }
+
+    TEST(transform_same_as_matrix)
+    {
+        rgm::dvec3     axis(1, 2, 3);
+        rgm::dvec3     t(4, -5, 6);
+        rgm::ddualquat q = sample(33.0, axis, t);
+        rgm::dmat4     m = sample_matrix(33.0, axis, t);
+        rgm::dvec3     p(0.5, -1, 2);
+
+        CHECK(rgm::close(rgm::dvec3(m * rgm::dvec4(p, 1.0)), rgm::transform_point(q, p), 1e-12));
+        CHECK(rgm::close(rgm::transform(m, p), rgm::transform_direction(q, p), 1e-12));
+        CHECK(rgm::close(t, rgm::translation(q), 1e-12));
+        CHECK(rgm::close(m, rgm::dualquat2mat4(q), 1e-12));
+
+        rgm::ddualquat identity;
+        CHECK_EQUAL(p, rgm::transform_point(identity, p));
+    }
+
+    TEST(compose)
+    {
+        rgm::ddualquat a = sample(33.0, rgm::dvec3(1, 2, 3), rgm::dvec3(4, -5, 6));
+        rgm::ddualquat b = sample(-70.0, rgm::dvec3(0, 1, 0), rgm::dvec3(1, 1, 0));
+        rgm::dvec3     p(0.5, -1, 2);
+
+        CHECK(rgm::close(rgm::transform_point(a, rgm::transform_point(b, p)), rgm::transform_point(a * b, p), 1e-12));
+        CHECK(rgm::close(rgm::dualquat2mat4(a) * rgm::dualquat2mat4(b), rgm::dualquat2mat4(a * b), 1e-12));
+    }
+
+    TEST(inverse)
+    {
+        rgm::ddualquat a = sample(33.0, rgm::dvec3(1, 2, 3), rgm::dvec3(4, -5, 6));
+        rgm::dvec3     p(0.5, -1, 2);
+
+        CHECK(rgm::close(p, rgm::transform_point(rgm::inverse(a), rgm::transform_point(a, p)), 1e-12));
+        CHECK(rgm::close(p, rgm::transform_point(rgm::inverse(a) * a, p), 1e-12));
+    }
+
+    TEST(matrix_round_trip)
+    {
+        // the angles reach all four cases of mat42quat
+        rgm::dvec3 axes[] = {rgm::dvec3(1, 2, 3), rgm::dvec3(1, 0, 0), rgm::dvec3(0, 1, 0), rgm::dvec3(0, 0, 1)};
+        double     angles[] = {33.0, 180.0, 170.0, -175.0};
+        for (unsigned int i = 0; i < 4; i++)
+        {
+            rgm::dmat4     m = sample_matrix(angles[i], axes[i], rgm::dvec3(4, -5, 6));
+            rgm::ddualquat q = rgm::mat42dualquat(m);
+            CHECK_CLOSE(1.0, rgm::length(q.real), 1e-12);
+            CHECK(rgm::close(m, rgm::dualquat2mat4(q), 1e-12));
+        }
+    }
+
+    TEST(blend)
+    {
+        rgm::ddualquat q[2] = {sample(20.0, rgm::dvec3(0, 0, 1), rgm::dvec3(2, 0, 0)),
+                               sample(60.0, rgm::dvec3(0, 0, 1), rgm::dvec3(2, 0, 0))};
+        double         w[2] = {3.0, 1.0};
+        rgm::ddualquat ref  = sample(30.0, rgm::dvec3(0, 0, 1), rgm::dvec3(2, 0, 0));
+        rgm::dvec3     p(0.5, -1, 2);
+
+        // the rotation is not at 30 degrees, but close; the unit length
+        // and the translation are exact
+        rgm::ddualquat b = rgm::blend(q, w, 2);
+        CHECK_CLOSE(1.0, rgm::length(b.real), 1e-12);
+        CHECK_CLOSE(0.0, rgm::dot(b.real, b.dual), 1e-12);
+        CHECK(rgm::close(rgm::transform_point(ref, p), rgm::transform_point(b, p), 1e-2));
+        CHECK(rgm::close(rgm::dvec3(2, 0, 0), rgm::translation(b), 1e-12));
+
+        // -q is the same transformation and must blend the same
+        q[1] = rgm::ddualquat(rgm::dquat(-q[1].real), rgm::dquat(-q[1].dual));
+        CHECK(rgm::close(rgm::transform_point(b, p), rgm::transform_point(rgm::blend(q, w, 2), p), 1e-12));
+    }
+
+    // Skins count vertices and compares them to blending each one on its
+    // own; with a pool the result must match the serial one exactly.
+    template <typename T>
+    void check_skin(size_t count)
+    {
+        std::vector<rgm::dual_quaternion<T>> bones(5);
+        for (unsigned int i = 0; i < bones.size(); i++)
+        {
+            rgm::vector3<T> axis((T)1, (T)i, (T)2 - (T)i);
+            rgm::vector3<T> t((T)i, (T)-1, (T)0.5 * (T)i);
+            bones[i] = rgm::dual_quaternion<T>(rgm::axis_angle(axis, (T)(40 * i)), t);
+        }
+        // the same as bone 1 on the other hemisphere
+        bones[4] = rgm::dual_quaternion<T>(rgm::quaterion<T>(-bones[1].real), rgm::quaterion<T>(-bones[1].dual));
+
+        rgm::vector_stream<unsigned int, 4> indices(count);
+        rgm::vector_stream<T, 4>            weights(count);
+        rgm::vector_stream<T, 3>            positions(count);
+        rgm::vector_stream<T, 3>            normals(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            indices.set(i, rgm::vector4<unsigned int>((unsigned int)i % 5, (unsigned int)(i + 1) % 5, (unsigned int)(i + 3) % 5, 4u));
+            weights.set(i, rgm::vector4<T>((T)(i % 3), (T)1, (T)0.5, i % 2 ? (T)0.25 : (T)0));
+            positions.set(i, rgm::vector3<T>((T)(i % 37), (T)1 - (T)(i % 37), (T)2));
+            normals.set(i, rgm::normalize(rgm::vector3<T>((T)1, (T)i, (T)-1)));
+        }
+
+        rgm::vector_stream<T, 3> rp;
+        rgm::vector_stream<T, 3> rn;
+        rgm::skin(&bones[0], indices, weights, positions, normals, rp, rn);
+        CHECK_EQUAL(count, rp.size());
+        CHECK_EQUAL(count, rn.size());
+
+        T eps = sizeof(T) == sizeof(float) ? (T)1e-4 : (T)1e-10;
+        for (size_t i = 0; i < count; i++)
+        {
+            rgm::vector<unsigned int, 4> k = indices.get(i);
+            rgm::dual_quaternion<T>      q[4] = {bones[k[0]], bones[k[1]], bones[k[2]], bones[k[3]]};
+            rgm::dual_quaternion<T>      b = rgm::blend(q, weights.get(i).c_array(), 4);
+            CHECK(rgm::close(rgm::transform_point(b, positions.get(i)), rp.get(i), eps));
+            CHECK(rgm::close(rgm::transform_direction(b, normals.get(i)), rn.get(i), eps));
+        }
+
+        rgm::vector_stream<T, 3> r;
+        rgm::skin(&bones[0], indices, weights, positions, r);
+        for (size_t i = 0; i < count; i++)
+        {
+            CHECK_EQUAL(rp.get(i), r.get(i));
+        }
+
+        rgm::thread_pool         pool(3);
+        rgm::vector_stream<T, 3> pp;
+        rgm::vector_stream<T, 3> pn;
+        rgm::skin(pool, &bones[0], indices, weights, positions, normals, pp, pn);
+        rgm::skin(pool, &bones[0], indices, weights, positions, r);
+        CHECK_EQUAL(count, pp.size());
+        for (size_t i = 0; i < count; i++)
+        {
+            CHECK_EQUAL(rp.get(i), pp.get(i));
+            CHECK_EQUAL(rn.get(i), pn.get(i));
+            CHECK_EQUAL(rp.get(i), r.get(i));
+        }
+    }
+
+    TEST(skin_same_as_blend)
+    {
+        // 37 leaves the last batch partially used; the larger counts
+        // span a few chunks of SKIN_GRAIN
+        check_skin<float>(37);
+        check_skin<double>(37);
+        check_skin<float>(2 * rgm::SKIN_GRAIN + 37);
+        check_skin<double>(2 * rgm::SKIN_GRAIN + 37);
+    }
+}
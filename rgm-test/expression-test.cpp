@@ -0,0 +1,106 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "rtest.h"
+#include <rgm/rgm.h>
+
+SUITE(expression)
+{
+    // not exact, since the operations may be contracted to FMA differently
+    template <typename T>
+    T eps()
+    {
+        return sizeof(T) == sizeof(float) ? (T)1e-5 : (T)1e-12;
+    }
+
+    template <typename T, unsigned int N>
+    rgm::vector<T, N> sample(unsigned int seed)
+    {
+        rgm::vector<T, N> r;
+        for (unsigned int i = 0; i < N; i++)
+        {
+            r[i] = (T)((int)((i * 7 + seed * 5) % 11) - 5) / (T)(2 + i + seed);
+        }
+        return r;
+    }
+
+    template <typename T, unsigned int N>
+    void check_same_as_operators()
+    {
+        rgm::vector<T, N> a = sample<T, N>(0);
+        rgm::vector<T, N> b = sample<T, N>(1);
+        rgm::vector<T, N> c = sample<T, N>(2) + rgm::vector<T, N>((T)10);
+
+        rgm::vector<T, N> r = rgm::lazy(a) * (T)0.5 + b * rgm::lazy(c) - rgm::lazy(a) / c;
+        CHECK(rgm::close(a * (T)0.5 + b * c - a / c, r, eps<T>()));
+
+        r = -rgm::lazy(a) + (T)2 * (b - rgm::lazy(c)) / (T)4;
+        CHECK(rgm::close(-a + (b - c) * (T)2 / (T)4, r, eps<T>()));
+
+        r = rgm::mix(rgm::lazy(a), rgm::lazy(b), (T)0.25);
+        CHECK(rgm::close(rgm::mix(a, b, (T)0.25), r, eps<T>()));
+    }
+
+    TEST(same_as_operators)
+    {
+        check_same_as_operators<float, 2>();
+        check_same_as_operators<float, 3>();
+        check_same_as_operators<float, 4>();
+        check_same_as_operators<double, 2>();
+        check_same_as_operators<double, 3>();
+        check_same_as_operators<double, 4>();
+        check_same_as_operators<int, 3>();
+    }
+
+    TEST(derived_types)
+    {
+        rgm::vec3 a(1, 2, 3);
+        rgm::vec3 b(4, 5, 6);
+
+        rgm::vec3 r = rgm::lazy(a) + b;
+        CHECK_EQUAL(rgm::vec3(5, 7, 9), r);
+
+        r = rgm::lazy(r) - a;
+        CHECK_EQUAL(b, r);
+
+        CHECK_EQUAL(rgm::vec3(2, 4, 6), rgm::eval(rgm::lazy(a) * 2.0f));
+    }
+
+    TEST(matrix)
+    {
+        rgm::mat4 a(1, 2, 3, 4,
+                    5, 6, 7, 8,
+                    9, 10, 11, 12,
+                    13, 14, 15, 16);
+        rgm::mat4 b(2);
+
+        rgm::mat4 r = rgm::lazy(a) * 0.5f + b - rgm::lazy(a) / 4.0f;
+        CHECK(rgm::close(a * 0.5f + b - a * 0.25f, r, 0.00001f));
+
+        rgm::dmat3 c(3);
+        rgm::dmat3 d = -rgm::lazy(c) + c * 2.0;
+        CHECK_EQUAL(c, d);
+    }
+}
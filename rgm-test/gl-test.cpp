@@ -0,0 +1,347 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "rtest.h"
+#include "sample.h"
+
+#include <rgm/rgm.h>
+
+#include <vector>
+
+SUITE(gl)
+{
+    template <typename T>
+    rgm::matrix<T, 4> sample_affine()
+    {
+        rgm::matrix<T, 4> m(1);
+        m = rgm::translate(m, rgm::vector3<T>(3, -2, 5));
+        m = rgm::rotate(m, rgm::vector3<T>(1, 2, 3), rgm::radians(T(30)));
+        m = rgm::scale(m, rgm::vector3<T>(2, T(0.5), 4));
+        return m;
+    }
+
+    template <typename T>
+    rgm::matrix<T, 4> sample_rigid()
+    {
+        rgm::matrix<T, 4> m(1);
+        m = rgm::translate(m, rgm::vector3<T>(3, -2, 5));
+        m = rgm::rotate(m, rgm::normalize(rgm::vector3<T>(1, 2, 3)), rgm::radians(T(30)));
+        return m;
+    }
+
+    TEST(inverse_affine)
+    {
+        rgm::mat4 m = sample_affine<float>();
+        CHECK(rgm::close(rgm::inv(m), rgm::inverse_affine(m), 0.00001f));
+
+        rgm::dmat4 d = sample_affine<double>();
+        CHECK(rgm::close(rgm::inv(d), rgm::inverse_affine(d), 1e-12));
+    }
+
+    TEST(inverse_rigid)
+    {
+        rgm::mat4 m = sample_rigid<float>();
+        CHECK(rgm::close(rgm::inv(m), rgm::inverse_rigid(m), 0.00001f));
+
+        rgm::dmat4 d = sample_rigid<double>();
+        CHECK(rgm::close(rgm::inv(d), rgm::inverse_rigid(d), 1e-12));
+    }
+
+    TEST(inverse_view)
+    {
+        rgm::mat4 v = rgm::lookat(rgm::vec3(4, 0, -2), rgm::vec3(0, 0, 0), rgm::vec3(0, 1, 0));
+        CHECK(rgm::close(rgm::inv(v), rgm::inverse_rigid(v), 0.00001f));
+        CHECK(rgm::close(rgm::inv(v), rgm::inverse_affine(v), 0.00001f));
+    }
+
+    TEST(lookat_orthonormal)
+    {
+        // up is not perpendicular to the view direction
+        rgm::vec3 p(4, 3, -2);
+        rgm::mat4 v = rgm::lookat(p, rgm::vec3(0, 0, 1), rgm::vec3(0, 1, 0));
+        // the rotation without the translation to -p
+        rgm::mat4 r = rgm::translate(v, p);
+        CHECK(rgm::close(r * rgm::transpose(r), rgm::mat4(1), 0.00001f));
+        CHECK(rgm::close(rgm::inv(v), rgm::inverse_rigid(v), 0.00001f));
+    }
+
+    template <typename T>
+    void check_trs(T eps)
+    {
+        rgm::vector<T, 3> t = rgm::vector3<T>(3, -2, 5);
+        rgm::quaterion<T> q = rgm::axis_angle(rgm::vector<T, 3>(rgm::vector3<T>(1, 2, 3)), T(70));
+        rgm::vector<T, 3> s = rgm::vector3<T>(2, T(0.5), 4);
+
+        rgm::matrix<T, 4> m = rgm::compose_trs(t, q, s);
+        CHECK(rgm::close(rgm::scale(rgm::rotate(rgm::translate(rgm::matrix<T, 4>(1), t), q), s), m, eps));
+
+        rgm::trs<T> d = rgm::decompose_trs(m);
+        CHECK(rgm::close(t, d.translation, eps));
+        CHECK(rgm::close(s, d.scale, eps));
+        // q and -q are the same rotation
+        CHECK(std::abs(rgm::dot(q, d.rotation)) > 1 - eps);
+        CHECK(rgm::close(m, rgm::compose_trs(d), eps));
+
+        // a mirror is folded into the x scale
+        rgm::matrix<T, 4> mirror = rgm::compose_trs(t, q, rgm::vector<T, 3>(rgm::vector3<T>(-2, T(0.5), 4)));
+        rgm::trs<T> dm = rgm::decompose_trs(mirror);
+        CHECK(dm.scale[0] < 0);
+        CHECK(rgm::close(mirror, rgm::compose_trs(dm), eps));
+    }
+
+    TEST(trs)
+    {
+        check_trs<float>(1e-5f);
+        check_trs<double>(1e-12);
+    }
+
+    TEST(trs_batch)
+    {
+        rgm::vec3 t[2] = {rgm::vec3(1, 2, 3), rgm::vec3(-4, 0, 1)};
+        rgm::quat q[2] = {rgm::axis_angle(rgm::vec3(0, 1, 0), 30.0f), rgm::axis_angle(rgm::vec3(1, 1, 0), -120.0f)};
+        rgm::vec3 s[2] = {rgm::vec3(1, 1, 1), rgm::vec3(3, 2, 1)};
+        rgm::mat4 m[2];
+        rgm::compose_trs(t, q, s, m, 2);
+
+        rgm::vec3 dt[2];
+        rgm::quat dq[2];
+        rgm::vec3 ds[2];
+        rgm::decompose_trs(m, dt, dq, ds, 2);
+        for (unsigned int i = 0; i < 2; i++)
+        {
+            CHECK(rgm::close(rgm::compose_trs(t[i], q[i], s[i]), m[i], 0.00001f));
+            CHECK(rgm::close(t[i], dt[i], 0.00001f));
+            CHECK(rgm::close(s[i], ds[i], 0.00001f));
+            CHECK(std::abs(rgm::dot(q[i], dq[i])) > 1 - 0.00001f);
+        }
+    }
+
+    TEST(inverse_batch_in_place)
+    {
+        rgm::mat4 m[3] = {sample_affine<float>(), sample_rigid<float>(), rgm::mat4(1)};
+        rgm::mat4 r[3] = {m[0], m[1], m[2]};
+
+        rgm::inverse_affine(r, r, 3);
+        for (unsigned int i = 0; i < 3; i++)
+        {
+            CHECK(rgm::close(rgm::inverse_affine(m[i]), r[i], 0.0f));
+        }
+
+        rgm::inverse_rigid(m + 1, r, 2);
+        CHECK(rgm::close(rgm::inverse_rigid(m[1]), r[0], 0.0f));
+        CHECK(rgm::close(rgm::mat4(1), r[1], 0.0f));
+    }
+
+    template <typename T>
+    void check_normal_matrix(T eps)
+    {
+        rgm::matrix<T, 4> m = sample_affine<T>();
+        CHECK(rgm::close(rgm::transpose(rgm::inv(rgm::matrix<T, 3>(rgm::matrix3<T>(m)))), rgm::normal_matrix(m), eps));
+
+        // normals stay perpendicular to the transformed surface
+        rgm::vector<T, 3> n = rgm::vector3<T>(1, 2, 3);
+        rgm::vector<T, 3> t = rgm::vector3<T>(3, 0, -1);
+        CHECK_CLOSE(T(0), rgm::dot(rgm::normal_matrix(m) * n, rgm::transform(m, t)), eps);
+
+        // and keep their side with a mirror
+        rgm::matrix<T, 4> mirror = rgm::scale(m, rgm::vector3<T>(-1, 1, 1));
+        CHECK(rgm::close(rgm::transpose(rgm::inv(rgm::matrix<T, 3>(rgm::matrix3<T>(mirror)))), rgm::normal_matrix(mirror), eps));
+
+        rgm::matrix<T, 4> rigid = sample_rigid<T>();
+        CHECK(rgm::close(rgm::normal_matrix(rigid), rgm::normal_matrix_rigid(rigid), eps));
+
+        rgm::matrix<T, 4> uniform = rgm::scale(rigid, rgm::vector3<T>(3, 3, 3));
+        CHECK(rgm::close(rgm::normal_matrix(uniform), rgm::normal_matrix_uniform(uniform), eps));
+    }
+
+    TEST(normal_matrix)
+    {
+        check_normal_matrix<float>(1e-5f);
+        check_normal_matrix<double>(1e-12);
+
+        rgm::mat4 m[2] = {sample_affine<float>(), sample_rigid<float>()};
+        rgm::mat3 r[2];
+        rgm::normal_matrix(m, r, 2);
+        CHECK(rgm::close(rgm::normal_matrix(m[0]), r[0], 0.0f));
+        CHECK(rgm::close(rgm::normal_matrix(m[1]), r[1], 0.0f));
+    }
+
+    template <typename T>
+    void check_transform_normals(T eps)
+    {
+        rgm::matrix<T, 3> n = rgm::normal_matrix(sample_affine<T>());
+        std::vector<rgm::vector<T, 3>> v(37);
+        for (size_t i = 0; i < v.size(); i++)
+        {
+            v[i] = rgm::normalize(rgm::vector3<T>((T)(i % 7) - 3, (T)(i % 5) - 2, (T)(i % 3) + 1));
+        }
+        v[5] = rgm::vector<T, 3>(0);
+
+        rgm::vector_stream<T, 3> s(&v[0], v.size());
+        rgm::vector_stream<T, 3> r;
+        rgm::transform_normals(n, s, r);
+        CHECK_EQUAL(v.size(), r.size());
+        for (size_t i = 0; i < v.size(); i++)
+        {
+            rgm::vector<T, 3> ref = i == 5 ? v[i] : rgm::normalize(n * v[i]);
+            CHECK(rgm::close(ref, r.get(i), eps));
+        }
+
+        // in place
+        rgm::transform_normals(n, s, s);
+        CHECK(rgm::close(r.get(36), s.get(36), T(0)));
+    }
+
+    TEST(transform_normals)
+    {
+        check_transform_normals<float>(1e-6f);
+        check_transform_normals<double>(1e-14);
+    }
+
+    template <typename T>
+    std::vector<rgm::vector<T, 3>> points(size_t count)
+    {
+        return sample::points<T>(count, rgm::vector3<T>(-8, 0, 0), rgm::vector3<T>(8, 2, 20));
+    }
+
+    template <typename T>
+    void check_transform(T eps)
+    {
+        rgm::matrix<T, 4> m = sample_affine<T>();
+        std::vector<rgm::vector<T, 3>> p = points<T>(37);
+        std::vector<rgm::vector<T, 3>> r(p.size());
+
+        rgm::transform_points(m, &p[0], &r[0], p.size());
+        for (size_t i = 0; i < p.size(); i++)
+        {
+            rgm::vector<T, 3> ref = rgm::vector3<T>(m * rgm::vector4<T>(p[i], 1));
+            CHECK(rgm::close(ref, r[i], eps));
+        }
+
+        // in place
+        rgm::transform_directions(m, &p[0], &p[0], p.size());
+        for (size_t i = 0; i < p.size(); i++)
+        {
+            CHECK(rgm::close(rgm::transform(m, points<T>(37)[i]), p[i], eps));
+        }
+    }
+
+    TEST(transform_points)
+    {
+        check_transform<float>(0.0001f);
+        check_transform<double>(1e-12);
+    }
+
+    TEST(transform_interleaved)
+    {
+        struct vertex
+        {
+            float position[3];
+            float normal[3];
+            float uv[2];
+        };
+
+        rgm::mat4 m = sample_rigid<float>();
+        std::vector<rgm::vector<float, 3>> p = points<float>(10);
+        std::vector<vertex> v(p.size());
+        for (size_t i = 0; i < v.size(); i++)
+        {
+            for (unsigned int j = 0; j < 3; j++)
+            {
+                v[i].position[j] = p[i][j];
+                v[i].normal[j]   = p[i][2 - j];
+            }
+            v[i].uv[0] = v[i].uv[1] = -1.0f;
+        }
+
+        rgm::transform_points(m, v[0].position, sizeof(vertex), v[0].position, sizeof(vertex), v.size());
+        rgm::transform_directions(m, v[0].normal, sizeof(vertex), v[0].normal, sizeof(vertex), v.size());
+        for (size_t i = 0; i < v.size(); i++)
+        {
+            rgm::vec3 n(p[i][2], p[i][1], p[i][0]);
+            CHECK(rgm::close(rgm::vec3(m * rgm::vec4(p[i], 1)), rgm::vec3(v[i].position[0], v[i].position[1], v[i].position[2]), 0.0001f));
+            CHECK(rgm::close(rgm::transform(m, n), rgm::vec3(v[i].normal[0], v[i].normal[1], v[i].normal[2]), 0.0001f));
+            CHECK_EQUAL(-1.0f, v[i].uv[0]);
+            CHECK_EQUAL(-1.0f, v[i].uv[1]);
+        }
+    }
+
+    TEST(transform_parallel)
+    {
+        rgm::thread_pool pool(3);
+        rgm::mat4 m = sample_affine<float>();
+        std::vector<rgm::vector<float, 3>> p = points<float>(3 * rgm::TRANSFORM_GRAIN + 5);
+        std::vector<rgm::vector<float, 3>> a(p.size());
+        std::vector<rgm::vector<float, 3>> b(p.size());
+
+        rgm::transform_points(m, &p[0], &a[0], p.size());
+        rgm::transform_points(pool, m, &p[0], &b[0], p.size());
+        CHECK(a == b);
+
+        rgm::transform_directions(m, &p[0], &a[0], p.size());
+        rgm::transform_directions(pool, m, &p[0], &b[0], p.size());
+        CHECK(a == b);
+
+        rgm::mat3 n = rgm::normal_matrix(m);
+        rgm::vector_stream<float, 3> s(&p[0], p.size());
+        rgm::vector_stream<float, 3> rs;
+        rgm::vector_stream<float, 3> rp;
+        rgm::transform_normals(n, s, rs);
+        rgm::transform_normals(pool, n, s, rp);
+        CHECK_EQUAL(s.size(), rp.size());
+        for (size_t i = 0; i < s.size(); i++)
+        {
+            CHECK_EQUAL(rs.get(i), rp.get(i));
+        }
+
+        std::vector<rgm::mat4> models(rgm::TRANSFORM_GRAIN + 3);
+        for (size_t i = 0; i < models.size(); i++)
+        {
+            models[i] = rgm::translate(m, rgm::vec3((float)i, 0, 1));
+            models[i][0][0] += (float)(i % 7) / 10;
+        }
+        std::vector<rgm::mat3> na(models.size());
+        std::vector<rgm::mat3> nb(models.size());
+        rgm::normal_matrix(&models[0], &na[0], models.size());
+        rgm::normal_matrix(pool, &models[0], &nb[0], models.size());
+        CHECK(na == nb);
+    }
+
+    TEST(constant_projection)
+    {
+        constexpr rgm::mat4 f = rgm::frustum(-1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 100.0f);
+        constexpr rgm::mat4 o = rgm::ortho(-2.0f, 2.0f, -1.0f, 1.0f, -1.0f, 1.0f);
+        constexpr rgm::mat4 t = rgm::scale(rgm::translate(rgm::mat4(1), rgm::vec3(1, 2, 3)), rgm::vec3(2, 2, 2));
+        constexpr rgm::mat4 m = f * t;
+        static_assert(rgm::det(t) == 8, "scale");
+        static_assert(t[3] == rgm::vec4(1, 2, 3, 1), "translate");
+        static_assert(o[0][0] == 0.5f && o[2][2] == -1, "ortho");
+        static_assert(rgm::radians(180.0) > 3.14159 && rgm::radians(180.0) < 3.1416, "radians");
+
+        rgm::mat4 r = rgm::translate(rgm::mat4(1), rgm::vec3(1, 2, 3));
+        r = rgm::scale(r, rgm::vec3(2, 2, 2));
+        CHECK_EQUAL(rgm::frustum(-1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 100.0f) * r, m);
+    }
+}
@@ -0,0 +1,126 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+
+#include "rtest.h"
+#include "sample.h"
+#include <rgm/rgm.h>
+
+SUITE(hierarchy)
+{
+    rgm::dmat4 trs(const rgm::dvec3& t, const rgm::dquat& r, const rgm::dvec3& s)
+    {
+        return rgm::scale(rgm::rotate(rgm::translate(rgm::dmat4(1.0), t), r), s);
+    }
+
+    TEST(world_matrices)
+    {
+        rgm::transform_hierarchy<double> h;
+
+        rgm::dquat   r0 = rgm::axis_angle(rgm::dvec3(0, 1, 0), 30.0);
+        rgm::dquat   r1 = rgm::axis_angle(rgm::dvec3(1, 0, 0), -45.0);
+        unsigned int root  = h.add(rgm::transform_hierarchy<double>::NONE, rgm::dvec3(1, 2, 3), r0, rgm::dvec3(2, 2, 2));
+        unsigned int child = h.add(root, rgm::dvec3(0, 1, 0), r1, rgm::dvec3(1, 1, 1));
+        unsigned int leaf  = h.add(child, rgm::dvec3(0, 0, -1), rgm::dquat(0, 0, 0, 1), rgm::dvec3(1, 0.5, 1));
+        CHECK_EQUAL(3u, h.size());
+        CHECK_EQUAL(child, h.parent(leaf));
+
+        CHECK_EQUAL(3u, h.update());
+
+        rgm::dmat4 w0 = trs(rgm::dvec3(1, 2, 3), r0, rgm::dvec3(2, 2, 2));
+        rgm::dmat4 w1 = w0 * trs(rgm::dvec3(0, 1, 0), r1, rgm::dvec3(1, 1, 1));
+        rgm::dmat4 w2 = w1 * trs(rgm::dvec3(0, 0, -1), rgm::dquat(0, 0, 0, 1), rgm::dvec3(1, 0.5, 1));
+        CHECK(rgm::close(w0, h.world(root), 1e-12));
+        CHECK(rgm::close(w1, h.world(child), 1e-12));
+        CHECK(rgm::close(w2, h.world(leaf), 1e-12));
+    }
+
+    TEST(only_dirty_subtrees)
+    {
+        rgm::transform_hierarchy<double> h;
+
+        // two roots with a chain of 3 below each
+        unsigned int a = h.add(rgm::transform_hierarchy<double>::NONE, rgm::dvec3(1, 0, 0), rgm::dquat(0, 0, 0, 1), rgm::dvec3(1, 1, 1));
+        unsigned int b = h.add(rgm::transform_hierarchy<double>::NONE, rgm::dvec3(0, 1, 0), rgm::dquat(0, 0, 0, 1), rgm::dvec3(1, 1, 1));
+        unsigned int pa = a;
+        unsigned int pb = b;
+        for (unsigned int i = 0; i < 3; i++)
+        {
+            pa = h.add(pa, rgm::dvec3(0, 0, 1), rgm::dquat(0, 0, 0, 1), rgm::dvec3(1, 1, 1));
+            pb = h.add(pb, rgm::dvec3(0, 0, 1), rgm::dquat(0, 0, 0, 1), rgm::dvec3(1, 1, 1));
+        }
+        CHECK_EQUAL(8u, h.update());
+        CHECK_EQUAL(0u, h.update());
+
+        rgm::dmat4 before = h.world(pb);
+        h.set_translation(a, rgm::dvec3(5, 0, 0));
+        CHECK_EQUAL(4u, h.update());
+        CHECK(rgm::close(rgm::dvec3(5, 0, 3), rgm::dvec3(h.world(pa) * rgm::dvec4(0, 0, 0, 1)), 1e-12));
+        CHECK_EQUAL(before, h.world(pb));
+
+        h.set_scale(pb, rgm::dvec3(2, 2, 2));
+        CHECK_EQUAL(1u, h.update());
+        CHECK(rgm::close(rgm::dvec3(0, 1, 5), rgm::dvec3(h.world(pb) * rgm::dvec4(0, 0, 1, 1)), 1e-12));
+
+        h.set_rotation(b, rgm::axis_angle(rgm::dvec3(0, 1, 0), 90.0));
+        h.set_translation(pa, rgm::dvec3(0, 0, 2));
+        CHECK_EQUAL(5u, h.update());
+    }
+
+    TEST(parallel_same_as_serial)
+    {
+        rgm::transform_hierarchy<float> a;
+        rgm::transform_hierarchy<float> b;
+
+        sample::generator g(1);
+        for (unsigned int i = 0; i < 5000; i++)
+        {
+            unsigned int parent = i < 10 ? rgm::transform_hierarchy<float>::NONE : g.next(i);
+            rgm::quat    r      = rgm::axis_angle(rgm::vec3(1, (float)(i % 3), 0), (float)(i % 360));
+            rgm::vec3    t((float)(i % 7), 1, -0.5f);
+            rgm::vec3    s(1, 1.01f, 1);
+            a.add(parent, t, r, s);
+            b.add(parent, t, r, s);
+        }
+
+        rgm::thread_pool pool(3);
+        for (unsigned int frame = 0; frame < 3; frame++)
+        {
+            for (unsigned int i = frame; i < 5000; i += 37)
+            {
+                rgm::vec3 t((float)frame, (float)i / 5000.0f, 0);
+                a.set_translation(i, t);
+                b.set_translation(i, t);
+            }
+            CHECK_EQUAL(a.update(), b.update(pool));
+            bool same = true;
+            for (unsigned int i = 0; i < 5000; i++)
+            {
+                same = same && a.world(i) == b.world(i);
+            }
+            CHECK(same);
+        }
+    }
+}
@@ -0,0 +1,367 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "rtest.h"
+#include "sample.h"
+#include <rgm/rgm.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+SUITE(intersect)
+{
+    // Not a multiple of any batch size, so that the padding is exercised.
+    const size_t COUNT = 203;
+
+    template <typename T>
+    rgm::vector<T, 3> vec(T x, T y, T z)
+    {
+        return rgm::vector3<T>(x, y, z);
+    }
+
+    template <typename T>
+    struct scene
+    {
+        std::vector<rgm::vector<T, 3>> a, b, c;
+        std::vector<rgm::vector<T, 3>> lower, upper;
+        std::vector<rgm::vector<T, 4>> spheres;
+
+        explicit scene(size_t count)
+        : a(count), b(count), c(count), lower(count), upper(count), spheres(count)
+        {
+            sample::generator g(7);
+            for (size_t i = 0; i < count; i++)
+            {
+                T v[9];
+                for (unsigned int j = 0; j < 9; j++)
+                {
+                    v[j] = g.uniform<T>(-10, 10, 2000);
+                }
+                // triangles of a few units around points in [-10, 10]^3
+                a[i] = vec(v[0], v[1], v[2]);
+                b[i] = a[i] + vec(v[3], v[4], v[5]) / (T)4;
+                c[i] = a[i] + vec(v[6], v[7], v[8]) / (T)4;
+                lower[i] = rgm::min(a[i], rgm::min(b[i], c[i]));
+                upper[i] = rgm::max(a[i], rgm::max(b[i], c[i]));
+                spheres[i] = rgm::vector4<T>(v[0], v[1], v[2], (T)0.5 + (T)(i % 5) / (T)4);
+            }
+        }
+    };
+
+    // rays from in front of the scene through it, in different directions
+    template <typename T>
+    std::vector<rgm::ray<T>> rays(size_t count)
+    {
+        std::vector<rgm::ray<T>> r(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            rgm::vector<T, 3> o = vec((T)(i % 9) - 4, (T)(i % 5) - 2, (T)20);
+            rgm::vector<T, 3> d = vec((T)(i % 7) / 20 - (T)0.15, (T)(i % 3) / 10 - (T)0.1, (T)-1);
+            r[i] = rgm::ray<T>(o, i % 2 == 0 ? d : d * (T)3);
+        }
+        return r;
+    }
+
+    bool bit(const std::vector<unsigned int>& mask, size_t i)
+    {
+        return (mask[i / 32] >> (i % 32) & 1) != 0;
+    }
+
+    template <typename T>
+    void check_box()
+    {
+        rgm::vector<T, 3> lower = vec<T>(0, 0, 0);
+        rgm::vector<T, 3> upper = vec<T>(1, 1, 1);
+        T tmax = 100;
+
+        CHECK_EQUAL(T(5), rgm::intersect_box(rgm::ray<T>(vec<T>(-5, T(0.5), T(0.5)), vec<T>(1, 0, 0)), lower, upper, tmax));
+        CHECK_EQUAL(T(2), rgm::intersect_box(rgm::ray<T>(vec<T>(T(0.5), T(0.5), 5), vec<T>(0, 0, -2)), lower, upper, tmax));
+        // not reached before tmax, beside, behind
+        CHECK_EQUAL(T(4), rgm::intersect_box(rgm::ray<T>(vec<T>(-5, T(0.5), T(0.5)), vec<T>(1, 0, 0)), lower, upper, T(4)));
+        CHECK_EQUAL(tmax, rgm::intersect_box(rgm::ray<T>(vec<T>(-5, 2, T(0.5)), vec<T>(1, 0, 0)), lower, upper, tmax));
+        CHECK_EQUAL(tmax, rgm::intersect_box(rgm::ray<T>(vec<T>(-5, T(0.5), T(0.5)), vec<T>(-1, 0, 0)), lower, upper, tmax));
+        // from inside
+        CHECK_EQUAL(T(0), rgm::intersect_box(rgm::ray<T>(vec<T>(T(0.5), T(0.5), T(0.5)), vec<T>(0, 1, 0)), lower, upper, tmax));
+        // along a face, where the slab gives NaN, and into a flat box
+        CHECK_EQUAL(T(5), rgm::intersect_box(rgm::ray<T>(vec<T>(-5, 0, T(0.5)), vec<T>(1, 0, 0)), lower, upper, tmax));
+        CHECK_EQUAL(T(4), rgm::intersect_box(rgm::ray<T>(vec<T>(T(0.5), T(0.5), -4), vec<T>(0, 0, 1)), lower, vec<T>(1, 1, 0), tmax));
+    }
+
+    template <typename T>
+    void check_triangle()
+    {
+        rgm::vector<T, 3> a = vec<T>(0, 0, 0);
+        rgm::vector<T, 3> b = vec<T>(1, 0, 0);
+        rgm::vector<T, 3> c = vec<T>(0, 1, 0);
+        T tmax = 100;
+        T u = -1, v = -1;
+
+        CHECK_EQUAL(T(5), rgm::intersect_triangle(rgm::ray<T>(vec<T>(T(0.25), T(0.5), 5), vec<T>(0, 0, -1)), a, b, c, tmax, u, v));
+        CHECK_EQUAL(T(0.25), u);
+        CHECK_EQUAL(T(0.5), v);
+        // from the back, in units of the direction
+        CHECK_EQUAL(T(1), rgm::intersect_triangle(rgm::ray<T>(vec<T>(T(0.5), T(0.25), -2), vec<T>(0, 0, 2)), a, b, c, tmax, u, v));
+        CHECK_EQUAL(T(0.5), u);
+        CHECK_EQUAL(T(0.25), v);
+
+        // misses leave u and v alone
+        u = v = -1;
+        CHECK_EQUAL(tmax, rgm::intersect_triangle(rgm::ray<T>(vec<T>(T(0.75), T(0.75), 5), vec<T>(0, 0, -1)), a, b, c, tmax, u, v));
+        CHECK_EQUAL(tmax, rgm::intersect_triangle(rgm::ray<T>(vec<T>(T(0.25), T(0.5), 5), vec<T>(0, 0, 1)), a, b, c, tmax, u, v));
+        CHECK_EQUAL(T(3), rgm::intersect_triangle(rgm::ray<T>(vec<T>(T(0.25), T(0.5), 5), vec<T>(0, 0, -1)), a, b, c, T(3), u, v));
+        CHECK_EQUAL(T(-1), u);
+        CHECK_EQUAL(T(-1), v);
+        // edge on and degenerate
+        CHECK_EQUAL(tmax, rgm::intersect_triangle(rgm::ray<T>(vec<T>(-1, T(0.25), 0), vec<T>(1, 0, 0)), a, b, c, tmax));
+        CHECK_EQUAL(tmax, rgm::intersect_triangle(rgm::ray<T>(vec<T>(T(0.25), 0, 5), vec<T>(0, 0, -1)), a, b, b * T(2), tmax));
+    }
+
+    template <typename T>
+    void check_sphere()
+    {
+        rgm::vector<T, 3> center = vec<T>(0, 0, -10);
+        T tmax = 100;
+
+        CHECK_EQUAL(T(8), rgm::intersect_sphere(rgm::ray<T>(vec<T>(0, 0, 0), vec<T>(0, 0, -1)), center, T(2), tmax));
+        CHECK_EQUAL(T(4), rgm::intersect_sphere(rgm::ray<T>(vec<T>(0, 0, 0), vec<T>(0, 0, -2)), center, T(2), tmax));
+        // from inside it is left
+        CHECK_EQUAL(T(2), rgm::intersect_sphere(rgm::ray<T>(center, vec<T>(0, 1, 0)), center, T(2), tmax));
+        CHECK_EQUAL(tmax, rgm::intersect_sphere(rgm::ray<T>(vec<T>(0, 0, 0), vec<T>(0, 0, 1)), center, T(2), tmax));
+        CHECK_EQUAL(tmax, rgm::intersect_sphere(rgm::ray<T>(vec<T>(3, 0, 0), vec<T>(0, 0, -1)), center, T(2), tmax));
+        CHECK_EQUAL(T(7), rgm::intersect_sphere(rgm::ray<T>(vec<T>(0, 0, 0), vec<T>(0, 0, -1)), center, T(2), T(7)));
+    }
+
+    template <typename T>
+    void check_one_ray(T eps)
+    {
+        scene<T> s(COUNT);
+        rgm::vector_stream<T, 3> a(&s.a[0], COUNT), b(&s.b[0], COUNT), c(&s.c[0], COUNT);
+        rgm::vector_stream<T, 3> lower(&s.lower[0], COUNT), upper(&s.upper[0], COUNT);
+        rgm::vector_stream<T, 4> spheres(&s.spheres[0], COUNT);
+
+        T tmax = 100;
+        rgm::vector_stream<T, 1> t;
+        rgm::vector_stream<T, 3> hits;
+        std::vector<unsigned int> mask;
+        size_t hit_triangles = 0;
+        for (const rgm::ray<T>& r : rays<T>(23))
+        {
+            rgm::intersect_triangles(r, a, b, c, tmax, hits, mask);
+            CHECK_EQUAL((COUNT + 31) / 32, mask.size());
+            T      closest = tmax;
+            size_t index   = rgm::NO_HIT;
+            for (size_t i = 0; i < COUNT; i++)
+            {
+                T u = 0, v = 0;
+                T ref = rgm::intersect_triangle(r, s.a[i], s.b[i], s.c[i], tmax, u, v);
+                CHECK_EQUAL(ref < tmax, bit(mask, i));
+                CHECK_CLOSE(ref, hits.lane(0)[i], eps);
+                if (ref < tmax)
+                {
+                    hit_triangles++;
+                    CHECK_CLOSE(u, hits.lane(1)[i], eps);
+                    CHECK_CLOSE(v, hits.lane(2)[i], eps);
+                }
+                if (ref < closest)
+                {
+                    closest = ref;
+                    index   = i;
+                }
+            }
+            T tc = tmax, uc = -1, vc = -1;
+            CHECK_EQUAL(index, rgm::closest_triangle(r, a, b, c, tc, uc, vc));
+            CHECK_CLOSE(closest, tc, eps);
+            if (index != rgm::NO_HIT)
+            {
+                CHECK_CLOSE(hits.lane(1)[index], uc, eps);
+                CHECK_CLOSE(hits.lane(2)[index], vc, eps);
+            }
+
+            rgm::intersect_boxes(r, lower, upper, tmax, t, mask);
+            for (size_t i = 0; i < COUNT; i++)
+            {
+                T ref = rgm::intersect_box(r, s.lower[i], s.upper[i], tmax);
+                CHECK_EQUAL(ref < tmax, bit(mask, i));
+                CHECK_CLOSE(ref, t.lane(0)[i], eps);
+            }
+
+            rgm::intersect_spheres(r, spheres, tmax, t, mask);
+            closest = tmax;
+            index   = rgm::NO_HIT;
+            for (size_t i = 0; i < COUNT; i++)
+            {
+                T ref = rgm::intersect_sphere(r, rgm::vector3<T>(s.spheres[i][0], s.spheres[i][1], s.spheres[i][2]), s.spheres[i][3], tmax);
+                CHECK_EQUAL(ref < tmax, bit(mask, i));
+                CHECK_CLOSE(ref, t.lane(0)[i], eps);
+                if (ref < closest)
+                {
+                    closest = ref;
+                    index   = i;
+                }
+            }
+            tc = tmax;
+            CHECK_EQUAL(index, rgm::closest_sphere(r, spheres, tc));
+            CHECK_CLOSE(closest, tc, eps);
+        }
+        // the rays do go through the scene
+        CHECK(hit_triangles > 10);
+    }
+
+    template <typename T>
+    void check_packet(T eps)
+    {
+        scene<T> s(COUNT);
+        rgm::vector_stream<T, 3> a(&s.a[0], COUNT), b(&s.b[0], COUNT), c(&s.c[0], COUNT);
+
+        std::vector<rgm::ray<T>> r = rays<T>(101);
+        rgm::vector_stream<T, 3> origins(r.size()), directions(r.size());
+        for (size_t i = 0; i < r.size(); i++)
+        {
+            origins.set(i, r[i].origin);
+            directions.set(i, r[i].direction);
+        }
+
+        T tmax = 100;
+        rgm::vector_stream<T, 3> hits(r.size());
+        rgm::vector_stream<T, 1> far(r.size());
+        rgm::vector_stream<T, 1> near;
+        std::fill(hits.lane(0), hits.lane(0) + r.size(), tmax);
+        std::fill(far.lane(0), far.lane(0) + r.size(), tmax);
+        std::vector<size_t>       index(r.size(), rgm::NO_HIT);
+        std::vector<unsigned int> mask;
+        for (size_t j = 0; j < COUNT; j++)
+        {
+            rgm::intersect_triangle(origins, directions, s.a[j], s.b[j], s.c[j], hits, mask);
+            for (size_t i = 0; i < r.size(); i++)
+            {
+                if (bit(mask, i))
+                {
+                    index[i] = j;
+                }
+            }
+
+            rgm::intersect_box(origins, directions, s.lower[j], s.upper[j], far, near, mask);
+            for (size_t i = 0; i < r.size(); i++)
+            {
+                T ref = rgm::intersect_box(r[i], s.lower[j], s.upper[j], tmax);
+                CHECK_EQUAL(ref < tmax, bit(mask, i));
+                CHECK_CLOSE(ref, near.lane(0)[i], eps);
+            }
+        }
+
+        size_t hit_rays = 0;
+        for (size_t i = 0; i < r.size(); i++)
+        {
+            T t = tmax, u = -1, v = -1;
+            CHECK_EQUAL(rgm::closest_triangle(r[i], a, b, c, t, u, v), index[i]);
+            CHECK_CLOSE(t, hits.lane(0)[i], eps);
+            if (index[i] != rgm::NO_HIT)
+            {
+                hit_rays++;
+                CHECK_CLOSE(u, hits.lane(1)[i], eps);
+                CHECK_CLOSE(v, hits.lane(2)[i], eps);
+            }
+        }
+        CHECK(hit_rays > 10);
+
+        // spheres, the same way
+        rgm::vector_stream<T, 1> t(r.size());
+        std::fill(t.lane(0), t.lane(0) + r.size(), tmax);
+        rgm::vector_stream<T, 4> spheres(&s.spheres[0], COUNT);
+        for (size_t j = 0; j < COUNT; j++)
+        {
+            rgm::vector<T, 4> sp = s.spheres[j];
+            rgm::intersect_sphere(origins, directions, rgm::vector3<T>(sp[0], sp[1], sp[2]), sp[3], t, mask);
+        }
+        for (size_t i = 0; i < r.size(); i++)
+        {
+            T tc = tmax;
+            rgm::closest_sphere(r[i], spheres, tc);
+            CHECK_CLOSE(tc, t.lane(0)[i], eps);
+        }
+    }
+
+    // the triangle test plugged into the bvh
+    template <typename T>
+    void check_bvh(T eps)
+    {
+        scene<T> s(COUNT);
+        rgm::vector_stream<T, 3> a(&s.a[0], COUNT), b(&s.b[0], COUNT), c(&s.c[0], COUNT);
+        rgm::bvh<T> tree(&s.lower[0], &s.upper[0], COUNT);
+
+        for (const rgm::ray<T>& r : rays<T>(23))
+        {
+            T t = std::numeric_limits<T>::max();
+            T u = -1, v = -1;
+            size_t hit = tree.raycast(r, t, [&] (unsigned int i, T tmax) {
+                return rgm::intersect_triangle(r, s.a[i], s.b[i], s.c[i], tmax, u, v);
+            });
+
+            T tc = std::numeric_limits<T>::max();
+            T uc = -1, vc = -1;
+            CHECK_EQUAL(rgm::closest_triangle(r, a, b, c, tc, uc, vc), hit);
+            CHECK_CLOSE(tc, t, eps);
+            CHECK_CLOSE(uc, u, eps);
+            CHECK_CLOSE(vc, v, eps);
+        }
+    }
+
+    TEST(box)
+    {
+        check_box<float>();
+        check_box<double>();
+    }
+
+    TEST(triangle)
+    {
+        check_triangle<float>();
+        check_triangle<double>();
+    }
+
+    TEST(sphere)
+    {
+        check_sphere<float>();
+        check_sphere<double>();
+    }
+
+    TEST(one_ray)
+    {
+        check_one_ray<float>(1e-4f);
+        check_one_ray<double>(1e-12);
+    }
+
+    TEST(packet)
+    {
+        check_packet<float>(1e-4f);
+        check_packet<double>(1e-12);
+    }
+
+    TEST(bvh)
+    {
+        check_bvh<float>(1e-4f);
+        check_bvh<double>(1e-12);
+    }
+}
@@ -87,4 +87,228 @@ SUITE(matrix)
 
         CHECK_EQUAL(ref, res);
     }
-}
\ No newline at end of file
+
+    // the generic product, written against the raw arrays
+    template <typename T, unsigned int N>
+    rgm::matrix<T, N> product_loops(const rgm::matrix<T, N>& a, const rgm::matrix<T, N>& b)
+    {
+        const T* pa = a.c_array();
+        const T* pb = b.c_array();
+        rgm::matrix<T, N> r((T)0);
+        for (unsigned int i = 0; i < N; i++)
+        {
+            for (unsigned int j = 0; j < N; j++)
+            {
+                T v = 0;
+                for (unsigned int k = 0; k < N; k++)
+                {
+                    v += pa[k * N + j] * pb[i * N + k];
+                }
+                r[i][j] = v;
+            }
+        }
+        return r;
+    }
+
+    template <typename T>
+    rgm::vector<T, 4> product_loops(const rgm::matrix<T, 4>& m, const rgm::vector<T, 4>& v)
+    {
+        const T* pm = m.c_array();
+        rgm::vector<T, 4> r((T)0);
+        for (unsigned int i = 0; i < 4; i++)
+        {
+            for (unsigned int j = 0; j < 4; j++)
+            {
+                r[i] += pm[j * 4 + i] * v[j];
+            }
+        }
+        return r;
+    }
+
+    template <typename T>
+    void check_product(T eps)
+    {
+        rgm::matrix4<T> a( 1.5f, -2.0f,  0.1f,  4.0f,
+                           0.3f,  6.0f, -7.5f,  8.0f,
+                           9.0f,  0.7f, 11.0f, -1.2f,
+                          13.0f, 14.0f,  0.2f, 16.0f);
+        rgm::matrix4<T> b = rgm::rotate<T>(rgm::translate<T>(rgm::matrix4<T>(1), rgm::vector3<T>(1, 2, 3)), rgm::vector3<T>(1, 1, 0), 30);
+        rgm::vector<T, 4> v = rgm::vector4<T>((T)0.5, (T)-1 / (T)3, (T)2, (T)1);
+
+        rgm::matrix<T, 4> m1 = product_loops(a, b);
+        rgm::matrix<T, 4> m2 = a * b;
+        rgm::vector<T, 4> v1 = product_loops(a, v);
+        rgm::vector<T, 4> v2 = a * v;
+
+#ifdef RGM_FMA
+        CHECK(rgm::close(m1, m2, eps));
+        CHECK(rgm::close(v1, v2, eps));
+#else
+        (void)eps;
+        CHECK_EQUAL(m1, m2);
+        CHECK_EQUAL(v1, v2);
+#endif
+    }
+
+    TEST(mat4_product_same_as_loops)
+    {
+        check_product<float>(0.0001f);
+    }
+
+    TEST(dmat4_product_same_as_loops)
+    {
+        check_product<double>(1e-12);
+    }
+
+    template <typename T, unsigned int N>
+    rgm::matrix<T, N> sample()
+    {
+        rgm::matrix<T, N> m;
+        for (unsigned int i = 0; i < N; i++)
+        {
+            for (unsigned int j = 0; j < N; j++)
+            {
+                m[i][j] = (T)((i * 7 + j * 3) % 5) - (T)i / (T)2 + (i == j ? (T)4 : (T)0);
+            }
+        }
+        return m;
+    }
+
+    template <typename T, unsigned int N>
+    void check_inverse(T eps)
+    {
+        rgm::matrix<T, N> m = sample<T, N>();
+
+        bool invertible = false;
+        rgm::matrix<T, N> r = rgm::inv(m, invertible);
+
+        CHECK(invertible);
+        CHECK(rgm::close(rgm::matrix<T, N>(1), product_loops(m, r), eps));
+        CHECK(rgm::close(rgm::matrix<T, N>(1), product_loops(r, m), eps));
+        CHECK(rgm::close(r, rgm::inv<T, N>(m), eps));
+    }
+
+    TEST(inverse)
+    {
+        check_inverse<float, 2>(0.00001f);
+        check_inverse<float, 3>(0.00001f);
+        check_inverse<float, 4>(0.00001f);
+        check_inverse<double, 2>(1e-12);
+        check_inverse<double, 3>(1e-12);
+        check_inverse<double, 4>(1e-12);
+        check_inverse<double, 5>(1e-12);
+        check_inverse<double, 6>(1e-12);
+    }
+
+    TEST(inverse_template_mat4)
+    {
+        rgm::mat4 m = sample<float, 4>();
+        bool invertible = false;
+        rgm::mat4 r = rgm::inv<float>(m, invertible);
+
+        CHECK(invertible);
+        CHECK(rgm::close(rgm::mat4(1), m * r, 0.00001f));
+        CHECK(rgm::close(rgm::inv(m), r, 0.00001f));
+    }
+
+    TEST(inverse_reports_singular)
+    {
+        rgm::mat4 m4(1, 2, 3, 4,
+                     2, 4, 6, 8,
+                     0, 1, 0, 1,
+                     1, 0, 1, 0);
+        rgm::dmat3 m3(1, 2, 3,
+                      4, 5, 6,
+                      7, 8, 9);
+        rgm::matrix<double, 5> m5((double)1);
+        m5[4][4] = 0;
+
+        bool invertible = true;
+        rgm::inv(m4, invertible);
+        CHECK(!invertible);
+
+        invertible = true;
+        rgm::inv<float>(m4, invertible);
+        CHECK(!invertible);
+
+        invertible = true;
+        rgm::inv(m3, invertible);
+        CHECK(!invertible);
+
+        invertible = true;
+        rgm::inv(m5, invertible);
+        CHECK(!invertible);
+    }
+
+    TEST(determinant)
+    {
+        rgm::dmat3 m3(2, 0, 1,
+                      1, 3, 2,
+                      1, 1, 2);
+        CHECK_CLOSE(6.0, rgm::det(m3), 1e-12);
+        CHECK_CLOSE((rgm::det<double, 3>(m3)), rgm::det(m3), 1e-12);
+
+        rgm::dmat4 m4 = sample<double, 4>();
+        CHECK_CLOSE((rgm::det<double, 4>(m4)), rgm::det(m4), 1e-9);
+
+        rgm::matrix<double, 5> m5((double)2);
+        CHECK_CLOSE(32.0, rgm::det(m5), 1e-12);
+    }
+
+    TEST(scale_does_not_transpose)
+    {
+        rgm::mat2 m(1, 2,
+                    3, 4);
+        rgm::mat2 ref(2, 4,
+                      6, 8);
+        CHECK_EQUAL(ref, m * 2.0f);
+        CHECK_EQUAL(ref, 2.0f * m);
+    }
+
+    TEST(constant_expression)
+    {
+        constexpr rgm::dmat3 m3(2, 0, 1,
+                                1, 3, 2,
+                                1, 1, 2);
+        static_assert(rgm::det(m3) == 6, "det3");
+        static_assert(rgm::det(rgm::matrix<double, 5>(2.0)) == 32, "det5");
+        static_assert(rgm::transpose(m3)[0][1] == 0 && rgm::transpose(m3)[1][0] == 1, "transpose");
+
+        constexpr rgm::mat4 a(1, 2, 3, 4,
+                              0, 1, 0, 5,
+                              0, 0, 1, 6,
+                              0, 0, 0, 1);
+        constexpr rgm::mat4 p = a * a;
+        constexpr rgm::vec4 v = a * rgm::vec4(1, 1, 1, 1);
+        static_assert(p[3][0] == 36 && p[3][1] == 10, "product");
+        static_assert(v == rgm::vec4(10, 6, 7, 1), "matrix vector product");
+
+        CHECK_EQUAL(a * a, p);
+        CHECK_EQUAL(a * rgm::vec4(1, 1, 1, 1), v);
+    }
+
+    TEST(element_access)
+    {
+        rgm::matrix<double, 5> m = sample<double, 5>();
+        const rgm::matrix<double, 5>& c = m;
+        for (unsigned int i = 0; i < 5; i++)
+        {
+            rgm::vector<double, 5> col = c.column(i);
+            CHECK_EQUAL(c[i], col);
+            for (unsigned int j = 0; j < 5; j++)
+            {
+                CHECK_EQUAL(c[i][j], c.at(i, j));
+                CHECK_EQUAL(c[i][j], c.column(i)[j]);
+            }
+        }
+
+        m.at(2, 3) = 42;
+        CHECK_EQUAL(42.0, m[2][3]);
+        CHECK_EQUAL(42.0, c.column(2)[3]);
+
+        constexpr rgm::mat3 k(1, 2, 3,
+                              4, 5, 6,
+                              7, 8, 9);
+        static_assert(k.at(1, 2) == 8 && k.column(2)[0] == 3 && k.at(1, 2) == k[1][2], "element access");
+    }
+}
@@ -0,0 +1,122 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "rtest.h"
+#include <rgm/rgm.h>
+
+#include <cstdint>
+#include <vector>
+
+SUITE(memory)
+{
+    bool aligned(const void* p, size_t alignment)
+    {
+        return reinterpret_cast<uintptr_t>(p) % alignment == 0;
+    }
+
+    TEST(aligned_types)
+    {
+        CHECK_EQUAL(16u, alignof(rgm::avec4));
+        CHECK_EQUAL(32u, alignof(rgm::advec4));
+        CHECK_EQUAL(64u, alignof(rgm::amat4));
+        CHECK_EQUAL(64u, alignof(rgm::admat4));
+        CHECK_EQUAL(sizeof(rgm::mat4), sizeof(rgm::amat4));
+
+        // they mix with the plain types
+        rgm::amat4 m(2.0f);
+        rgm::avec4 v(1, 2, 3, 4);
+        v = m * v;
+        CHECK_EQUAL(rgm::vec4(2, 4, 6, 8), v);
+    }
+
+    TEST(aligned_allocator)
+    {
+        std::vector<rgm::amat4, rgm::aligned_allocator<rgm::amat4>> m(5, rgm::amat4(1.0f));
+        std::vector<float, rgm::aligned_allocator<float>> f(7);
+        for (unsigned int k = 0; k < 10; k++)
+        {
+            m.push_back(rgm::mat4(2.0f));
+            f.push_back(1.0f);
+            CHECK(aligned(m.data(), 64));
+            CHECK(aligned(f.data(), 32));
+        }
+        CHECK_EQUAL(rgm::mat4(1.0f), rgm::mat4(m[0]));
+        CHECK_EQUAL(rgm::mat4(2.0f), rgm::mat4(m[14]));
+    }
+
+    TEST(frame_arena)
+    {
+        rgm::frame_arena arena(1024);
+        CHECK_EQUAL(1024u, arena.capacity());
+
+        void* a = arena.allocate(100);
+        void* b = arena.allocate(8, 8);
+        void* c = arena.allocate(64, 64);
+        CHECK(aligned(a, 32));
+        CHECK(aligned(b, 8));
+        CHECK(aligned(c, 64));
+        CHECK(static_cast<char*>(b) >= static_cast<char*>(a) + 100);
+        CHECK(static_cast<char*>(c) >= static_cast<char*>(b) + 8);
+
+        // the next frame gets the same memory
+        arena.reset();
+        CHECK_EQUAL(0u, arena.size());
+        CHECK(a == arena.allocate(100));
+    }
+
+    TEST(frame_arena_grows)
+    {
+        rgm::frame_arena arena(256);
+        arena.allocate(200);
+        void* p = arena.allocate(300);
+        CHECK(aligned(p, 32));
+        CHECK(arena.size() >= 500);
+
+        // a frame that did not fit makes the arena large enough for it
+        arena.reset();
+        CHECK(arena.capacity() >= 500);
+        char* a = static_cast<char*>(arena.allocate(200));
+        char* b = static_cast<char*>(arena.allocate(300));
+        CHECK(b >= a + 200 && b + 300 <= a + arena.capacity());
+    }
+
+    TEST(arena_allocator)
+    {
+        rgm::frame_arena arena(64 * 1024);
+        for (unsigned int frame = 0; frame < 3; frame++)
+        {
+            rgm::arena_allocator<rgm::vec4> alloc(arena);
+            std::vector<rgm::vec4, rgm::arena_allocator<rgm::vec4>> v(alloc);
+            for (unsigned int i = 0; i < 100; i++)
+            {
+                v.push_back(rgm::vec4((float)i));
+            }
+            CHECK(aligned(v.data(), 32));
+            CHECK_EQUAL(rgm::vec4(99.0f), v[99]);
+            CHECK(arena.size() <= arena.capacity());
+            arena.reset();
+        }
+    }
+}
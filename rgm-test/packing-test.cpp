@@ -0,0 +1,172 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "rtest.h"
+#include <rgm/rgm.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+SUITE(packing)
+{
+    // every half survives the round trip through float
+    TEST(half_round_trip)
+    {
+        for (uint32_t b = 0; b < 0x10000; b++)
+        {
+            float f = rgm::half::from_bits(static_cast<uint16_t>(b));
+            if (std::isnan(f))
+            {
+                CHECK(std::isnan(static_cast<float>(rgm::half(f))));
+            }
+            else
+            {
+                CHECK_EQUAL(b, rgm::half(f).to_bits());
+            }
+        }
+    }
+
+    TEST(half_rounding)
+    {
+        CHECK_EQUAL(0x3c00u, rgm::half(1.0f).to_bits());
+        CHECK_EQUAL(0xc000u, rgm::half(-2.0f).to_bits());
+        CHECK_EQUAL(0x7bffu, rgm::half(65504.0f).to_bits());
+        CHECK_EQUAL(0x7bffu, rgm::half(65519.0f).to_bits());
+        CHECK_EQUAL(0x7c00u, rgm::half(65520.0f).to_bits());
+        CHECK_EQUAL(0xfc00u, rgm::half(-1e10f).to_bits());
+        CHECK_EQUAL(0x0001u, rgm::half(std::ldexp(1.0f, -24)).to_bits());
+        CHECK_EQUAL(0x0400u, rgm::half(std::ldexp(1.0f, -14)).to_bits());
+        CHECK_EQUAL(0x8000u, rgm::half(-0.0f).to_bits());
+        // ties go to even
+        CHECK_EQUAL(0x0000u, rgm::half(std::ldexp(1.0f, -25)).to_bits());
+        CHECK_EQUAL(0x0002u, rgm::half(std::ldexp(3.0f, -25)).to_bits());
+        CHECK_EQUAL(0x3c00u, rgm::half(1.0f + std::ldexp(1.0f, -11)).to_bits());
+        CHECK_EQUAL(0x3c02u, rgm::half(1.0f + std::ldexp(3.0f, -11)).to_bits());
+        CHECK(std::isnan(static_cast<float>(rgm::half(std::nanf("")))));
+    }
+
+    TEST(half_batch_same_as_scalar)
+    {
+        // 37 elements, so that the tail after the F16C blocks is used
+        std::vector<rgm::vec3> v(37);
+        for (size_t i = 0; i < v.size(); i++)
+        {
+            v[i] = rgm::vec3((float)i * 0.37f - 5.0f, std::ldexp(1.0f, (int)i - 20), 70000.0f - (float)i * 1000.0f);
+        }
+        std::vector<rgm::hvec3> h(v.size());
+        std::vector<rgm::vec3>  r(v.size());
+        rgm::pack(&v[0], &h[0], v.size());
+        rgm::unpack(&h[0], &r[0], v.size());
+        for (size_t i = 0; i < v.size(); i++)
+        {
+            rgm::hvec3 s(v[i]);
+            for (unsigned int j = 0; j < 3; j++)
+            {
+                CHECK_EQUAL(s[j].to_bits(), h[i][j].to_bits());
+            }
+            CHECK_EQUAL(s.unpack(), r[i]);
+        }
+    }
+
+    // directions spread evenly over the sphere
+    std::vector<rgm::vec3> directions(int count)
+    {
+        std::vector<rgm::vec3> r(count);
+        for (int i = 0; i < count; i++)
+        {
+            double z = 1 - 2 * (i + 0.5) / count;
+            double s = std::sqrt(1 - z * z);
+            double a = i * 2.399963229728653;
+            r[i] = rgm::normalize(rgm::vec3((float)(s * std::cos(a)), (float)(s * std::sin(a)), (float)z));
+        }
+        r[0] = rgm::vec3(0, 0, -1);
+        r[1] = rgm::vec3(1, 0, 0);
+        r[2] = rgm::vec3(0, -1, 0);
+        return r;
+    }
+
+    double angle(const rgm::vec3& a, const rgm::vec3& b)
+    {
+        rgm::dvec3 da(a);
+        rgm::dvec3 db(b);
+        return rgm::degrees(std::atan2(rgm::length(rgm::cross(da, db)), rgm::dot(da, db)));
+    }
+
+    // the error bounds documented in packing.h
+    TEST(octahedral_normals)
+    {
+        std::vector<rgm::vec3>        n = directions(20000);
+        std::vector<rgm::oct_snorm16> p16(n.size());
+        std::vector<rgm::oct_unorm8>  p8(n.size());
+        std::vector<rgm::vec3>        r16(n.size());
+        std::vector<rgm::vec3>        r8(n.size());
+        rgm::pack(&n[0], &p16[0], n.size());
+        rgm::pack(&n[0], &p8[0], n.size());
+        rgm::unpack(&p16[0], &r16[0], n.size());
+        rgm::unpack(&p8[0], &r8[0], n.size());
+
+        double e16 = 0;
+        double e8  = 0;
+        for (size_t i = 0; i < n.size(); i++)
+        {
+            e16 = std::max(e16, angle(n[i], r16[i]));
+            e8  = std::max(e8, angle(n[i], r8[i]));
+            CHECK_CLOSE(1.0f, rgm::length(r16[i]), 1e-6f);
+        }
+        CHECK(e16 < 0.004);
+        CHECK(e8 < 1.0);
+        CHECK_EQUAL(4u, sizeof(rgm::oct_snorm16));
+        CHECK_EQUAL(2u, sizeof(rgm::oct_unorm8));
+    }
+
+    TEST(quat48)
+    {
+        std::vector<rgm::vec3> n = directions(20000);
+        std::vector<rgm::quat> q(n.size());
+        for (size_t i = 0; i < n.size(); i++)
+        {
+            q[i] = rgm::normalize(rgm::quat(n[i][0], n[i][1] * 0.3f, n[i][2], std::cos((float)i * 1.7f)));
+        }
+        q[3] = rgm::quat(0, 0, 0, 1);
+        q[4] = rgm::quat(0, -1, 0, 0);
+
+        std::vector<rgm::quat48> p(q.size());
+        std::vector<rgm::quat>   r(q.size());
+        rgm::pack(&q[0], &p[0], q.size());
+        rgm::unpack(&p[0], &r[0], q.size());
+        for (size_t i = 0; i < q.size(); i++)
+        {
+            // the same rotation, possibly with the opposite sign
+            rgm::quat s = rgm::dot(q[i], r[i]) < 0 ? rgm::quat(-r[i]) : r[i];
+            for (unsigned int j = 0; j < 4; j++)
+            {
+                CHECK_CLOSE(q[i][j], s[j], 6e-5f);
+            }
+        }
+        CHECK_EQUAL(6u, sizeof(rgm::quat48));
+    }
+}
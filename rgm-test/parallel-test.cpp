@@ -0,0 +1,256 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "rtest.h"
+#include <rgm/rgm.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+SUITE(parallel)
+{
+    TEST(each_index_once)
+    {
+        rgm::thread_pool pool(3);
+        CHECK_EQUAL(4u, pool.size());
+
+        std::vector<int> hits(1000, 0);
+        // several jobs in a row on the same pool
+        for (unsigned int k = 0; k < 10; k++)
+        {
+            rgm::parallel_for(pool, 3, 1000, 64, [&] (size_t b, size_t e) {
+                CHECK(e - b <= 64);
+                for (size_t i = b; i < e; i++)
+                {
+                    hits[i]++;
+                }
+            });
+        }
+
+        for (size_t i = 0; i < hits.size(); i++)
+        {
+            CHECK_EQUAL(i < 3 ? 0 : 10, hits[i]);
+        }
+    }
+
+    TEST(empty_range)
+    {
+        rgm::thread_pool pool(2);
+        bool called = false;
+        rgm::parallel_for(pool, 5, 5, 1, [&] (size_t, size_t) { called = true; });
+        CHECK(!called);
+    }
+
+    TEST(no_workers)
+    {
+        rgm::thread_pool pool(0);
+        std::atomic<size_t> sum(0);
+        rgm::parallel_for(pool, 0, 100, 7, [&] (size_t b, size_t e) {
+            for (size_t i = b; i < e; i++)
+            {
+                sum += i;
+            }
+        });
+        CHECK_EQUAL(4950u, sum.load());
+    }
+
+    // Slow tasks at the start of the first slice, so that the other
+    // threads finish theirs and steal; every task still runs once.
+    TEST(uneven_tasks)
+    {
+        rgm::thread_pool pool(3);
+        for (size_t count : {1u, 3u, 4u, 5u, 100u, 1001u})
+        {
+            std::vector<std::atomic<unsigned int>> calls(count);
+            for (size_t i = 0; i < count; i++)
+            {
+                calls[i] = 0;
+            }
+            pool.run(count, [&] (size_t i) {
+                if (i < count / 8)
+                {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                }
+                calls[i]++;
+            });
+            for (size_t i = 0; i < count; i++)
+            {
+                CHECK_EQUAL(1u, calls[i].load());
+            }
+        }
+    }
+
+    // Jobs from two threads on one pool take turns instead of mixing
+    // their tasks.
+    TEST(concurrent_callers)
+    {
+        rgm::thread_pool pool(2);
+        std::atomic<unsigned int> errors(0);
+        auto caller = [&] (size_t count) {
+            for (unsigned int k = 0; k < 100; k++)
+            {
+                std::vector<std::atomic<unsigned int>> calls(count);
+                for (size_t i = 0; i < count; i++)
+                {
+                    calls[i] = 0;
+                }
+                rgm::parallel_for(pool, 0, count, 1, [&] (size_t b, size_t e) {
+                    for (size_t i = b; i < e; i++)
+                    {
+                        calls[i]++;
+                    }
+                    // let the other caller in, even on a single core
+                    std::this_thread::yield();
+                });
+                for (size_t i = 0; i < count; i++)
+                {
+                    if (calls[i] != 1)
+                    {
+                        errors++;
+                    }
+                }
+            }
+        };
+
+        std::thread a(caller, 40);
+        std::thread b(caller, 30);
+        a.join();
+        b.join();
+        CHECK_EQUAL(0u, errors.load());
+    }
+
+    // A task that calls parallel_for on its own pool runs the inner
+    // chunks itself instead of waiting for the busy threads.
+    TEST(nested_calls)
+    {
+        rgm::thread_pool pool(2);
+        std::vector<std::atomic<unsigned int>> calls(8 * 50);
+        for (size_t i = 0; i < calls.size(); i++)
+        {
+            calls[i] = 0;
+        }
+        rgm::parallel_for(pool, 0, 8, 1, [&] (size_t ob, size_t oe) {
+            for (size_t o = ob; o < oe; o++)
+            {
+                rgm::parallel_for(pool, 0, 50, 1, [&] (size_t b, size_t e) {
+                    for (size_t i = b; i < e; i++)
+                    {
+                        calls[o * 50 + i]++;
+                    }
+                });
+            }
+        });
+        for (size_t i = 0; i < calls.size(); i++)
+        {
+            CHECK_EQUAL(1u, calls[i].load());
+        }
+
+        // and the same through the default pool
+        std::vector<int> hits(1000, 0);
+        rgm::parallel_for(0, 10, 1, [&] (size_t ob, size_t oe) {
+            for (size_t o = ob; o < oe; o++)
+            {
+                rgm::parallel_for(o * 100, o * 100 + 100, 10, [&] (size_t b, size_t e) {
+                    for (size_t i = b; i < e; i++)
+                    {
+                        hits[i]++;
+                    }
+                });
+            }
+        });
+        CHECK(std::count(hits.begin(), hits.end(), 1) == 1000);
+    }
+
+    TEST(default_pool)
+    {
+        CHECK(rgm::default_thread_pool().size() >= 1);
+        CHECK(&rgm::default_thread_pool() == &rgm::default_thread_pool());
+
+        std::vector<int> hits(1000, 0);
+        rgm::parallel_for(0, hits.size(), 10, [&] (size_t b, size_t e) {
+            for (size_t i = b; i < e; i++)
+            {
+                hits[i]++;
+            }
+        });
+        CHECK(std::count(hits.begin(), hits.end(), 1) == 1000);
+    }
+
+    // A float sum is only reproducible if it is added up in the same
+    // order, which parallel_reduce guarantees for any number of threads.
+    TEST(reduce_is_reproducible)
+    {
+        std::vector<float> v(100003);
+        for (size_t i = 0; i < v.size(); i++)
+        {
+            v[i] = 1.0f / (float)(i % 1000 + 1) * (i % 3 == 0 ? -1.0f : 1.0f);
+        }
+        auto sum = [&] (size_t b, size_t e) {
+            float s = 0;
+            for (size_t i = b; i < e; i++)
+            {
+                s += v[i];
+            }
+            return s;
+        };
+        auto add = [] (float a, float b) { return a + b; };
+
+        float expected = 0;
+        for (size_t b = 0; b < v.size(); b += 256)
+        {
+            expected += sum(b, std::min(b + 256, v.size()));
+        }
+
+        for (unsigned int workers : {0u, 1u, 3u, 7u})
+        {
+            rgm::thread_pool pool(workers);
+            for (unsigned int k = 0; k < 5; k++)
+            {
+                CHECK_EQUAL(expected, rgm::parallel_reduce(pool, 0, v.size(), 256, 0.0f, sum, add));
+            }
+        }
+
+        rgm::thread_pool pool(2);
+        CHECK_EQUAL(42, rgm::parallel_reduce(pool, 7, 7, 1, 42, [] (size_t, size_t) { return 1; }, add));
+    }
+
+    TEST(exception_is_rethrown)
+    {
+        rgm::thread_pool pool(2);
+        std::atomic<unsigned int> calls(0);
+        CHECK_THROW(pool.run(16, [&] (size_t i) {
+            calls++;
+            if (i == 5)
+            {
+                throw std::runtime_error("task failed");
+            }
+        }), const std::runtime_error&);
+        CHECK_EQUAL(16u, calls.load());
+    }
+}
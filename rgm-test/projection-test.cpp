@@ -0,0 +1,256 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "rtest.h"
+#include "sample.h"
+#include <rgm/rgm.h>
+
+#include <vector>
+
+SUITE(projection)
+{
+    template <typename T>
+    struct camera
+    {
+        rgm::matrix<T, 4> projection;
+        rgm::matrix<T, 4> view;
+        rgm::vector<T, 4> viewport;
+
+        camera()
+        {
+            projection = rgm::perspective<T>(60, T(4) / T(3), 1, 100);
+            // the camera at (0, 2, 10) looking down -z
+            view       = rgm::translate(rgm::matrix<T, 4>(1), rgm::vector<T, 3>(rgm::vector3<T>(0, -2, -10)));
+            viewport   = rgm::vector4<T>(10, 20, 640, 480);
+        }
+    };
+
+    // points in and around the view volume, a few behind the camera
+    template <typename T>
+    std::vector<rgm::vector<T, 3>> points(size_t count)
+    {
+        return sample::points<T>(count, rgm::vector3<T>(-18, -6, -30), rgm::vector3<T>(18, 6, 14));
+    }
+
+    template <typename T>
+    void check_project(T eps)
+    {
+        camera<T> c;
+        rgm::projector<T> p(c.projection, c.view, c.viewport);
+        CHECK(rgm::close(c.projection * c.view, p.viewprojection(), T(0)));
+
+        std::vector<rgm::vector<T, 3>> v = points<T>(37);
+        std::vector<rgm::vector<T, 3>> r(v.size());
+        std::vector<unsigned int>      f(v.size());
+        p.project_points(&v[0], &r[0], &f[0], v.size());
+        for (size_t i = 0; i < v.size(); i++)
+        {
+            rgm::vector<T, 3> ref = rgm::project(v[i], c.projection, c.view, c.viewport);
+            if (f[i] == 0)
+            {
+                // relative to the window size
+                CHECK(rgm::close(ref, r[i], eps * 1000));
+            }
+            CHECK(rgm::close(p.project(v[i]), r[i], T(0)));
+            CHECK_EQUAL(p.clip_flags(v[i]), f[i]);
+
+            rgm::vector<T, 4> h = c.projection * c.view * rgm::vector4<T>(v[i], 1);
+            CHECK_EQUAL(rgm::simd::clip_flags(h[0], h[1], h[2], h[3]), f[i]);
+        }
+
+        // in place, without flags
+        p.project_points(&v[0], &v[0], v.size());
+        for (size_t i = 0; i < v.size(); i++)
+        {
+            CHECK(rgm::close(r[i], v[i], T(0)));
+        }
+    }
+
+    TEST(project_points)
+    {
+        check_project<float>(1e-5f);
+        check_project<double>(1e-12);
+    }
+
+    TEST(clip_flags)
+    {
+        typedef rgm::projector<float> P;
+        camera<float> c;
+        P p(c.projection * c.view, c.viewport);
+
+        CHECK_EQUAL(0u, p.clip_flags(rgm::vec3(0, 0, 0)));
+        CHECK_EQUAL(P::CLIP_LEFT, p.clip_flags(rgm::vec3(-100, 0, 0)));
+        CHECK_EQUAL(P::CLIP_RIGHT, p.clip_flags(rgm::vec3(100, 0, 0)));
+        CHECK_EQUAL(P::CLIP_BOTTOM, p.clip_flags(rgm::vec3(0, -100, 0)));
+        CHECK_EQUAL(P::CLIP_TOP, p.clip_flags(rgm::vec3(0, 100, 0)));
+        CHECK_EQUAL(P::CLIP_NEAR, p.clip_flags(rgm::vec3(0, 2, 9.5f)));
+        CHECK_EQUAL(P::CLIP_FAR, p.clip_flags(rgm::vec3(0, 0, -200)));
+        // with w < 0 the point on the axis is outside both side planes
+        unsigned int sides = P::CLIP_LEFT | P::CLIP_RIGHT | P::CLIP_BOTTOM | P::CLIP_TOP;
+        CHECK_EQUAL(sides | P::CLIP_NEAR | P::CLIP_BEHIND, p.clip_flags(rgm::vec3(0, 2, 20)));
+        CHECK_EQUAL(P::CLIP_LEFT | P::CLIP_TOP, p.clip_flags(rgm::vec3(-100, 100, 0)));
+
+        // the center of the view lands in the center of the viewport
+        rgm::vec3 w = p.project(rgm::vec3(0, 2, 0));
+        CHECK_CLOSE(330.0f, w[0], 0.001f);
+        CHECK_CLOSE(260.0f, w[1], 0.001f);
+    }
+
+    template <typename T>
+    void check_stream()
+    {
+        camera<T> c;
+        rgm::projector<T> p(c.projection, c.view, c.viewport);
+
+        std::vector<rgm::vector<T, 3>> v = points<T>(37);
+        std::vector<rgm::vector<T, 3>> r(v.size());
+        std::vector<unsigned int>      f(v.size());
+        p.project_points(&v[0], &r[0], &f[0], v.size());
+
+        rgm::vector_stream<T, 3> s(&v[0], v.size());
+        rgm::vector_stream<T, 3> rs;
+        std::vector<unsigned int> fs;
+        p.project_points(s, rs, fs);
+        CHECK_EQUAL(v.size(), rs.size());
+        CHECK_EQUAL(v.size(), fs.size());
+        for (size_t i = 0; i < v.size(); i++)
+        {
+            CHECK_EQUAL(f[i], fs[i]);
+            if (f[i] == 0)
+            {
+                CHECK(rgm::close(r[i], rs.get(i), T(0.001)));
+            }
+        }
+
+        // in place
+        p.project_points(s, s);
+        CHECK(rgm::close(rs.get(0), s.get(0), T(0)));
+    }
+
+    TEST(project_stream)
+    {
+        check_stream<float>();
+        check_stream<double>();
+    }
+
+    template <typename T>
+    void check_unproject(T eps)
+    {
+        camera<T> c;
+        rgm::projector<T>   p(c.projection, c.view, c.viewport);
+        rgm::unprojector<T> u(c.projection, c.view, c.viewport);
+        CHECK(rgm::close(rgm::inv(c.projection * c.view), u.inverse(), T(0)));
+
+        std::vector<rgm::vector<T, 3>> v = points<T>(37);
+        for (size_t i = 0; i < v.size(); i++)
+        {
+            if (p.clip_flags(v[i]) == 0)
+            {
+                rgm::vector<T, 3> w = p.project(v[i]);
+                CHECK(rgm::close(v[i], u.unproject(w), eps));
+                CHECK(rgm::close(v[i], rgm::unproject(w, c.projection, c.view, c.viewport), eps));
+            }
+        }
+    }
+
+    TEST(unproject)
+    {
+        check_unproject<float>(0.001f);
+        check_unproject<double>(1e-9);
+    }
+
+    template <typename T>
+    void check_pick(T eps)
+    {
+        camera<T> c;
+        rgm::projector<T>   p(c.projection, c.view, c.viewport);
+        rgm::unprojector<T> u(c.projection, c.view, c.viewport);
+
+        rgm::vector<T, 3> q = rgm::vector3<T>(3, 1, -5);
+        rgm::vector<T, 3> w = p.project(q);
+        rgm::ray<T>       r = u.pick(w[0], w[1]);
+
+        // starts on the near plane and passes through q
+        CHECK_CLOSE(T(1), rgm::length(r.direction), eps);
+        CHECK_CLOSE(T(0), p.project(r.origin)[2], eps);
+        CHECK_CLOSE(T(0), rgm::length(rgm::cross(q - r.origin, r.direction)), eps * 10);
+        CHECK(rgm::dot(q - r.origin, r.direction) > 0);
+    }
+
+    TEST(pick)
+    {
+        check_pick<float>(1e-5f);
+        check_pick<double>(1e-12);
+    }
+
+    template <typename T>
+    void check_rays(T eps)
+    {
+        camera<T> c;
+        rgm::unprojector<T> u(c.projection * c.view, c.viewport);
+
+        // not a multiple of the batch size
+        const unsigned int w = 37;
+        const unsigned int h = 5;
+        std::vector<rgm::ray<T>> r(w * h);
+        u.rays(3, 4, w, h, &r[0]);
+
+        rgm::vector_stream<T, 3> o;
+        rgm::vector_stream<T, 3> d;
+        u.rays(3, 4, w, h, o, d);
+        CHECK_EQUAL(size_t(w * h), o.size());
+        CHECK_EQUAL(size_t(w * h), d.size());
+
+        rgm::thread_pool pool(3);
+        std::vector<rgm::ray<T>> rp(w * h);
+        u.rays(pool, 3, 4, w, h, &rp[0]);
+        rgm::vector_stream<T, 3> op;
+        rgm::vector_stream<T, 3> dp;
+        u.rays(pool, 3, 4, w, h, op, dp);
+
+        for (unsigned int j = 0; j < h; j++)
+        {
+            for (unsigned int i = 0; i < w; i++)
+            {
+                size_t      k = j * w + i;
+                rgm::ray<T> e = u.pick(T(3 + i) + T(0.5), T(4 + j) + T(0.5));
+                CHECK(rgm::close(e.origin, r[k].origin, eps));
+                CHECK(rgm::close(e.direction, r[k].direction, eps));
+                CHECK(rgm::close(r[k].origin, o.get(k), T(0)));
+                CHECK(rgm::close(r[k].direction, d.get(k), T(0)));
+                CHECK(rgm::close(r[k].origin, rp[k].origin, T(0)));
+                CHECK(rgm::close(r[k].direction, rp[k].direction, T(0)));
+                CHECK(rgm::close(r[k].origin, op.get(k), T(0)));
+                CHECK(rgm::close(r[k].direction, dp.get(k), T(0)));
+            }
+        }
+    }
+
+    TEST(rays)
+    {
+        check_rays<float>(1e-5f);
+        check_rays<double>(1e-12);
+    }
+}
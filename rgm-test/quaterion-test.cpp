@@ -71,4 +71,39 @@ SUITE(quat)
 
         CHECK(rgm::close(vr, v2, 0.00001f));
     }
+
+    TEST(slerp)
+    {
+        rgm::dquat a = rgm::axis_angle<double>(rgm::dvec3(0, 0, 1), 0.0);
+        rgm::dquat b = rgm::axis_angle<double>(rgm::dvec3(0, 0, 1), 90.0);
+
+        CHECK(rgm::close(rgm::slerp(a, b, 0.0), a, 1e-12));
+        CHECK(rgm::close(rgm::slerp(a, b, 1.0), b, 1e-12));
+
+        // constant angular velocity
+        rgm::dquat ref = rgm::axis_angle<double>(rgm::dvec3(0, 0, 1), 30.0);
+        CHECK(rgm::close(rgm::slerp(a, b, 1.0 / 3.0), ref, 1e-12));
+        CHECK_CLOSE(1.0, rgm::length(rgm::slerp(a, b, 0.7)), 1e-12);
+
+        // -b is the same rotation, the path must not go the long way
+        CHECK(rgm::close(rgm::slerp(a, rgm::dquat(-b), 1.0 / 3.0), ref, 1e-12));
+
+        // nearly equal quaternions
+        rgm::dquat c = rgm::axis_angle<double>(rgm::dvec3(0, 0, 1), 1e-6);
+        rgm::dquat h = rgm::axis_angle<double>(rgm::dvec3(0, 0, 1), 0.5e-6);
+        CHECK(rgm::close(rgm::slerp(a, c, 0.5), h, 1e-12));
+        CHECK(rgm::close(rgm::slerp(a, a, 0.5), a, 1e-12));
+    }
+
+    TEST(nlerp)
+    {
+        rgm::quat a = rgm::axis_angle<float>(rgm::vec3(1, 0, 0), 0.0f);
+        rgm::quat b = rgm::axis_angle<float>(rgm::vec3(1, 0, 0), 90.0f);
+        rgm::quat h = rgm::axis_angle<float>(rgm::vec3(1, 0, 0), 45.0f);
+
+        // the midpoint is exact, the rest is not
+        CHECK(rgm::close(rgm::nlerp(a, b, 0.5f), h, 1e-6f));
+        CHECK(rgm::close(rgm::nlerp(a, rgm::quat(-b), 0.5f), h, 1e-6f));
+        CHECK_CLOSE(1.0f, rgm::length(rgm::nlerp(a, b, 0.3f)), 1e-6f);
+    }
 }
@@ -0,0 +1,79 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#ifndef _SAMPLE_H_
+#define _SAMPLE_H_
+
+#include <rgm/rgm.h>
+
+#include <vector>
+
+// Reproducible test data, shared by the suites.
+namespace sample
+{
+    // Linear congruential generator: the same seed gives the same numbers
+    // on every platform, unlike std::rand.
+    class generator
+    {
+    public:
+        explicit generator(unsigned int seed = 1)
+        : seed(seed) {}
+
+        // An integer in [0, n).
+        unsigned int next(unsigned int n)
+        {
+            seed = seed * 1103515245u + 12345u;
+            return (seed >> 8) % n;
+        }
+
+        // A value in [lower, upper), in steps of (upper - lower) / steps.
+        template <typename T>
+        T uniform(T lower, T upper, unsigned int steps = 10000)
+        {
+            return lower + (upper - lower) * (T)next(steps) / (T)steps;
+        }
+
+    private:
+        unsigned int seed;
+    };
+
+    // count points in the box [lower, upper).
+    template <typename T>
+    std::vector<rgm::vector<T, 3>> points(size_t count, const rgm::vector<T, 3>& lower, const rgm::vector<T, 3>& upper, unsigned int seed = 1)
+    {
+        generator g(seed);
+        std::vector<rgm::vector<T, 3>> r(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            for (unsigned int j = 0; j < 3; j++)
+            {
+                r[i][j] = g.uniform(lower[j], upper[j]);
+            }
+        }
+        return r;
+    }
+}
+
+#endif
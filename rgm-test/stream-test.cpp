@@ -0,0 +1,308 @@
+/*
+rgm - Rioki's Graphic Math Library
+
+Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+
+#include "rtest.h"
+#include <rgm/rgm.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+SUITE(stream)
+{
+    // 37 elements, so that the last batch is only partially used
+    const size_t COUNT = 37;
+
+    template <typename T, unsigned int N>
+    std::vector<rgm::vector<T, N>> values(unsigned int seed)
+    {
+        std::vector<rgm::vector<T, N>> r(COUNT);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            for (unsigned int j = 0; j < N; j++)
+            {
+                r[i][j] = (T)((int)((i * 7 + j * 13 + seed * 5) % 23) - 11) / (T)(3 + j + seed);
+            }
+        }
+        return r;
+    }
+
+    // not exact, since the compiler may contract the scalar code to FMA
+    template <typename T>
+    T eps()
+    {
+        return sizeof(T) == sizeof(float) ? (T)1e-5 : (T)1e-12;
+    }
+
+    template <typename T, unsigned int N>
+    void check_same_as_vector()
+    {
+        std::vector<rgm::vector<T, N>> a = values<T, N>(0);
+        std::vector<rgm::vector<T, N>> b = values<T, N>(1);
+        std::vector<rgm::vector<T, N>> w = values<T, N>(2);
+        rgm::vector_stream<T, N> sa(&a[0], COUNT);
+        rgm::vector_stream<T, N> sb(&b[0], COUNT);
+        rgm::vector_stream<T, N> sw(&w[0], COUNT);
+
+        rgm::vector_stream<T, 1> s;
+        rgm::vector_stream<T, N> r;
+
+        rgm::dot(sa, sb, s);
+        CHECK_EQUAL(COUNT, s.size());
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            CHECK_CLOSE(rgm::dot(a[i], b[i]), s.lane(0)[i], eps<T>());
+        }
+
+        rgm::length(sa, s);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            CHECK_CLOSE(rgm::length(a[i]), s.lane(0)[i], eps<T>());
+        }
+
+        rgm::normalize(sa, r);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            CHECK(rgm::close(rgm::normalize(a[i]), r.get(i), eps<T>()));
+        }
+
+        rgm::min(sa, sb, r);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            CHECK_EQUAL(rgm::min(a[i], b[i]), r.get(i));
+        }
+
+        rgm::inv_length(sa, s);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            T l = rgm::inv_length(a[i]);
+            CHECK_CLOSE(l, s.lane(0)[i], eps<T>() * l);
+        }
+
+        rgm::length_fast(sa, s);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            CHECK_CLOSE(rgm::length_fast(a[i]), s.lane(0)[i], eps<T>());
+        }
+
+        rgm::normalize_fast(sa, r);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            CHECK(rgm::close(rgm::normalize_fast(a[i]), r.get(i), eps<T>()));
+        }
+
+        // no zero elements, so that the reciprocals are finite
+        rgm::max(sa, (T)0.5, r);
+        rgm::rcp(r, r);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            CHECK(rgm::close(rgm::rcp(rgm::max(a[i], (T)0.5)), r.get(i), eps<T>()));
+        }
+
+        rgm::max(sa, (T)0, r);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            CHECK_EQUAL(rgm::max(a[i], (T)0), r.get(i));
+        }
+
+        rgm::clamp(sa, (T)-1, (T)1, r);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            CHECK_EQUAL(rgm::clamp(a[i], (T)-1, (T)1), r.get(i));
+        }
+
+        rgm::mix(sa, sb, sw, r);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            CHECK(rgm::close(rgm::mix(a[i], b[i], w[i]), r.get(i), eps<T>()));
+        }
+    }
+
+    TEST(same_as_vector)
+    {
+        check_same_as_vector<float, 2>();
+        check_same_as_vector<float, 3>();
+        check_same_as_vector<float, 4>();
+        check_same_as_vector<double, 2>();
+        check_same_as_vector<double, 3>();
+        check_same_as_vector<double, 4>();
+    }
+
+    TEST(cross)
+    {
+        std::vector<rgm::vector<float, 3>> a = values<float, 3>(0);
+        std::vector<rgm::vector<float, 3>> b = values<float, 3>(1);
+        rgm::vec3_stream sa(&a[0], COUNT);
+        rgm::vec3_stream sb(&b[0], COUNT);
+
+        // result in place of the first argument
+        rgm::cross(sa, sb, sa);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            CHECK(rgm::close(rgm::cross(a[i], b[i]), sa.get(i), eps<float>()));
+        }
+    }
+
+    TEST(aos_round_trip)
+    {
+        std::vector<rgm::vector<float, 4>> a = values<float, 4>(0);
+        rgm::vec4_stream s(&a[0], COUNT);
+
+        CHECK_EQUAL(COUNT, s.size());
+        CHECK(s.padded_size() >= COUNT);
+        CHECK_EQUAL(0u, reinterpret_cast<uintptr_t>(s.lane(1)) % rgm::vec4_stream::alignment);
+
+        std::vector<rgm::vector<float, 4>> b(COUNT);
+        s.store(&b[0]);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            CHECK_EQUAL(a[i], b[i]);
+            CHECK_EQUAL(a[i][2], s.lane(2)[i]);
+        }
+    }
+
+    TEST(resize_keeps_elements)
+    {
+        std::vector<rgm::vector<double, 3>> a = values<double, 3>(0);
+        rgm::dvec3_stream s(&a[0], 5);
+        rgm::dvec3_stream c = s;
+
+        s.resize(COUNT);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            CHECK_EQUAL(i < 5 ? a[i] : rgm::dvec3(0.0), s.get(i));
+        }
+
+        s.resize(2);
+        s.resize(3);
+        CHECK_EQUAL(rgm::dvec3(0.0), s.get(2));
+        CHECK_EQUAL(a[4], c.get(4));
+    }
+
+    template <typename T>
+    std::vector<rgm::quaterion<T>> rotations(unsigned int seed)
+    {
+        std::vector<rgm::vector<T, 4>> v = values<T, 4>(seed);
+        std::vector<rgm::quaterion<T>> r(COUNT);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            r[i] = rgm::normalize(v[i]);
+        }
+        // equal and opposite quaternions
+        r[0] = r[1] = rgm::quaterion<T>(0, 0, 0, 1);
+        if (seed != 0)
+        {
+            r[1] = rgm::quaterion<T>(0, 0, 0, -1);
+        }
+        return r;
+    }
+
+    template <typename T>
+    void check_quaternion_interpolation(T tolerance)
+    {
+        std::vector<rgm::quaterion<T>> a = rotations<T>(0);
+        std::vector<rgm::quaterion<T>> b = rotations<T>(1);
+        std::vector<T>                 t(COUNT);
+        rgm::vector_stream<T, 4> sa(&a[0], COUNT);
+        rgm::vector_stream<T, 4> sb(&b[0], COUNT);
+        rgm::vector_stream<T, 1> st(COUNT);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            t[i] = (T)i / (T)(COUNT - 1);
+            st.lane(0)[i] = t[i];
+        }
+
+        rgm::vector_stream<T, 4> r;
+        rgm::nlerp(sa, sb, st, r);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            CHECK(rgm::close(rgm::nlerp(a[i], b[i], t[i]), r.get(i), eps<T>()));
+        }
+
+        rgm::slerp(sa, sb, st, r);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            CHECK(rgm::close(rgm::slerp(a[i], b[i], t[i]), r.get(i), tolerance));
+        }
+
+        rgm::slerp(sa, sb, (T)0.25, r);
+        for (size_t i = 0; i < COUNT; i++)
+        {
+            CHECK(rgm::close(rgm::slerp(a[i], b[i], (T)0.25), r.get(i), tolerance));
+        }
+    }
+
+    // the error bounds documented in stream.h
+    TEST(quaternion_interpolation)
+    {
+        check_quaternion_interpolation<float>(1e-6f);
+        check_quaternion_interpolation<double>(1e-7);
+    }
+
+    // the error bounds documented in stream.h, against the exact result in
+    // double precision for lengths from 1e-3 to 1e3
+    TEST(fast_math_error)
+    {
+        const size_t count = 20000;
+        std::vector<rgm::vec3> v(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            float s = std::pow(10.0f, (float)(i % 61) * 0.1f - 3.0f);
+            v[i] = rgm::vec3(std::sin((float)i) * s, std::cos((float)i * 1.3f) * s, (float)((int)(i % 17) - 8) * s);
+        }
+        v[0] = rgm::vec3(0.0f);
+        rgm::vec3_stream  sv(&v[0], count);
+        rgm::float_stream il, l;
+        rgm::vec3_stream  n, r;
+        rgm::inv_length(sv, il);
+        rgm::length_fast(sv, l);
+        rgm::normalize_fast(sv, n);
+        rgm::rcp(sv, r);
+
+        CHECK_EQUAL(0.0f, l.lane(0)[0]);
+        CHECK_EQUAL(rgm::vec3(0.0f), n.get(0));
+        double length_error    = 0;
+        double normalize_error = 0;
+        double rcp_error       = 0;
+        for (size_t i = 1; i < count; i++)
+        {
+            rgm::dvec3 d(v[i][0], v[i][1], v[i][2]);
+            double     dl = rgm::length(d);
+            length_error  = std::max(length_error, std::abs(l.lane(0)[i] - dl) / dl);
+            length_error  = std::max(length_error, std::abs(il.lane(0)[i] - 1.0 / dl) * dl);
+            for (unsigned int j = 0; j < 3; j++)
+            {
+                normalize_error = std::max(normalize_error, std::abs(n.get(i)[j] - d[j] / dl));
+                if (d[j] != 0)
+                {
+                    rcp_error = std::max(rcp_error, std::abs(r.get(i)[j] - 1.0 / d[j]) * std::abs(d[j]));
+                }
+            }
+        }
+        CHECK(length_error < 4e-7);
+        CHECK(normalize_error < 4e-7);
+        CHECK(rcp_error < 2.5e-7);
+    }
+}
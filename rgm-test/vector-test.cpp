@@ -27,6 +27,67 @@ THE SOFTWARE.
 
 SUITE(vector)
 {
+    // the explicit template arguments select the generic loops
+    template <typename T, unsigned int N>
+    void check_same_as_loops(const rgm::vector<T, N>& a, const rgm::vector<T, N>& b, const rgm::vector<T, N>& w)
+    {
+        CHECK_EQUAL((rgm::operator - <T, N>(a)), -a);
+        CHECK_EQUAL((rgm::operator + <T, N>(a, b)), a + b);
+        CHECK_EQUAL((rgm::operator - <T, N>(a, b)), a - b);
+        CHECK_EQUAL((rgm::operator * <T, N>(a, b)), a * b);
+        CHECK_EQUAL((rgm::operator / <T, N>(a, b)), a / b);
+        CHECK_EQUAL((rgm::operator * <T, N, T>(a, (T)3)), a * (T)3);
+        CHECK_EQUAL((rgm::operator / <T, N, T>(a, (T)3)), a / (T)3);
+        CHECK_EQUAL((rgm::dot<T, N>(a, b)), rgm::dot(a, b));
+        CHECK_EQUAL((rgm::normalize<T, N>(a)), rgm::normalize(a));
+        CHECK_EQUAL((rgm::min<T, N>(a, b)), rgm::min(a, b));
+        CHECK_EQUAL((rgm::max<T, N>(a, b)), rgm::max(a, b));
+        CHECK_EQUAL((rgm::min<T, N>(a, (T)1)), rgm::min(a, (T)1));
+        CHECK_EQUAL((rgm::clamp<T, N>(a, b, b + w)), rgm::clamp(a, b, b + w));
+        CHECK_EQUAL((rgm::mix<T, N>(a, b, w)), rgm::mix(a, b, w));
+        CHECK_EQUAL((rgm::abs<T, N>(a)), rgm::abs(a));
+    }
+
+    TEST(vec4_same_as_loops)
+    {
+        check_same_as_loops<float, 4>(rgm::vec4(1.5f, -2.25f, 3.0f, 0.1f),
+                                      rgm::vec4(-0.5f, 4.0f, 1.0f / 3.0f, 7.0f),
+                                      rgm::vec4(0.25f, 0.5f, 0.75f, 0.3f));
+    }
+
+    TEST(vec3_same_as_loops)
+    {
+        check_same_as_loops<float, 3>(rgm::vec3(1.5f, -2.25f, 0.1f),
+                                      rgm::vec3(-0.5f, 1.0f / 3.0f, 7.0f),
+                                      rgm::vec3(0.25f, 0.75f, 0.3f));
+    }
+
+    TEST(dvec_same_as_loops)
+    {
+        check_same_as_loops<double, 2>(rgm::dvec2(1.5, -2.25),
+                                       rgm::dvec2(1.0 / 3.0, 7.0),
+                                       rgm::dvec2(0.25, 0.3));
+        check_same_as_loops<double, 3>(rgm::dvec3(1.5, -2.25, 0.1),
+                                       rgm::dvec3(-0.5, 1.0 / 3.0, 7.0),
+                                       rgm::dvec3(0.25, 0.75, 0.3));
+        check_same_as_loops<double, 4>(rgm::dvec4(1.5, -2.25, 3.0, 0.1),
+                                       rgm::dvec4(-0.5, 4.0, 1.0 / 3.0, 7.0),
+                                       rgm::dvec4(0.25, 0.5, 0.75, 0.3));
+    }
+
+    TEST(fast_math)
+    {
+        CHECK_EQUAL(0.0f, rgm::length_fast(rgm::vec3(0.0f)));
+        CHECK_EQUAL(rgm::vec3(0.0f), rgm::normalize_fast(rgm::vec3(0.0f)));
+        CHECK(rgm::close(rgm::vec4(0.5f, -4.0f, 0.1f, 1.0f), rgm::rcp(rgm::vec4(2.0f, -0.25f, 10.0f, 1.0f)), 1e-6f));
+        CHECK(rgm::close(rgm::vec3(0.6f, 0.0f, -0.8f), rgm::normalize_fast(rgm::vec3(3.0f, 0.0f, -4.0f)), 1e-6f));
+        CHECK_EQUAL(1.0 / 3.0, rgm::inv_length(rgm::dvec3(1.0, 2.0, -2.0)));
+        CHECK_EQUAL(3.0, rgm::length_fast(rgm::dvec3(1.0, 2.0, -2.0)));
+        CHECK(rgm::close(rgm::normalize(rgm::dvec4(1.0, 2.0, 3.0, 4.0)), rgm::normalize_fast(rgm::dvec4(1.0, 2.0, 3.0, 4.0)), 1e-15));
+        CHECK_EQUAL(0.125, rgm::rcp(8.0));
+        CHECK_EQUAL(0.0, rgm::length_fast(rgm::dvec2(0.0)));
+    }
+
      TEST(init2)
      {
         rgm::vec2 v(1, 2);
@@ -50,4 +111,18 @@ SUITE(vector)
          CHECK_EQUAL(3, v[2]);
          CHECK_EQUAL(4, v[3]);
      }
-}
\ No newline at end of file
+
+     TEST(constant_expression)
+     {
+         constexpr rgm::vec3 a(1, 2, 3);
+         constexpr rgm::vec3 b(4, 5, 6);
+         constexpr rgm::vec3 c = rgm::cross(a, b) * 2.0f + a;
+         static_assert(rgm::dot(a, b) == 32, "dot");
+         static_assert(c[0] == -5 && c[1] == 14 && c[2] == -3, "cross");
+
+         constexpr rgm::dvec4 m = rgm::mix(rgm::dvec4(0.0), rgm::dvec4(4.0), 0.25);
+         static_assert(rgm::min(m, rgm::dvec4(0.5)) == rgm::dvec4(0.5), "mix and min");
+
+         CHECK_EQUAL(rgm::cross(a, b) * 2.0f + a, c);
+     }
+}
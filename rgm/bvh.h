@@ -0,0 +1,762 @@
+/*
+    rgm - Rioki's Graphic Math Library
+
+    Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+#ifndef _RGM_BVH_H_
+#define _RGM_BVH_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "vector.h"
+#include "memory.h"
+#include "ray.h"
+#include "parallel.h"
+
+namespace rgm
+{
+    // Bounding volume hierarchy over axis aligned boxes. The tree is built
+    // top down, splitting each node where the binned surface area heuristic
+    // (SAH) is lowest; leaves hold up to MIN_LEAF primitives, or up to
+    // MAX_LEAF if no split is cheaper. Nodes are stored flat, with the two
+    // children of an inner node next to each other, so that a traversal
+    // step reads one cache line for float and two for double.
+    //
+    // With a thread pool, the top of the tree is split with the binning
+    // spread over the threads, and the subtrees below BUILD_TASK primitives
+    // are then built in parallel. The tree does not depend on the pool or
+    // the number of threads.
+    template <typename T>
+    class bvh
+    {
+    public:
+        struct node_fields
+        {
+            T            lower[3];
+            // number of primitives of a leaf, 0 for inner nodes
+            unsigned int count;
+            T            upper[3];
+            // first child of inner nodes, first entry in indices() of leaves
+            unsigned int offset;
+        };
+
+        // 32 bytes for float, 64 bytes for double. The build works on the
+        // fields, since std::vector does not align beyond alignof(max_align_t)
+        // before C++17.
+        struct alignas(8 * sizeof(T)) node : node_fields {};
+
+        static_assert(sizeof(node) == 8 * sizeof(T) && sizeof(node_fields) == sizeof(node), "bvh nodes need to fill a cache line");
+
+        static const size_t       NONE        = ~static_cast<size_t>(0);
+        static const unsigned int BINS        = 16;
+        static const unsigned int MIN_LEAF    = 4;
+        static const unsigned int MAX_LEAF    = 8;
+        static const unsigned int BUILD_TASK  = 4096;
+        static const unsigned int BUILD_GRAIN = 16384;
+
+        bvh()
+        : count(0), data(0) {}
+
+        bvh(const vector<T, 3>* lower, const vector<T, 3>* upper, size_t size)
+        : count(0), data(0)
+        {
+            build(lower, upper, size);
+        }
+
+        bvh(thread_pool& pool, const vector<T, 3>* lower, const vector<T, 3>* upper, size_t size)
+        : count(0), data(0)
+        {
+            build(pool, lower, upper, size);
+        }
+
+        bvh(const bvh<T>& b)
+        : count(0), data(0), order(b.order)
+        {
+            allocate(b.count);
+            std::copy(b.data, b.data + count, data);
+        }
+
+        bvh(bvh<T>&& b)
+        : count(b.count), data(b.data), order(std::move(b.order))
+        {
+            b.count = 0;
+            b.data  = 0;
+        }
+
+        ~bvh()
+        {
+            aligned_free(data);
+        }
+
+        bvh<T>& operator = (bvh<T> b)
+        {
+            std::swap(count, b.count);
+            std::swap(data, b.data);
+            std::swap(order, b.order);
+            return *this;
+        }
+
+        // Builds the tree over the boxes [lower[i], upper[i]], i < size.
+        void build(const vector<T, 3>* lower, const vector<T, 3>* upper, size_t size)
+        {
+            builder b(0, lower, upper, size);
+            finish(b);
+        }
+
+        void build(thread_pool& pool, const vector<T, 3>* lower, const vector<T, 3>* upper, size_t size)
+        {
+            builder b(&pool, lower, upper, size);
+            finish(b);
+        }
+
+        // Updates the node bounds after the primitives moved, keeping the
+        // tree as it is. This is much faster than a build, but the tree
+        // gets worse as the primitives move away from where they were.
+        void refit(const vector<T, 3>* lower, const vector<T, 3>* upper)
+        {
+            // children always come after their parent
+            for (size_t i = count; i-- > 0;)
+            {
+                node& n = data[i];
+                if (n.count != 0)
+                {
+                    vector<T, 3> lo = lower[order[n.offset]];
+                    vector<T, 3> hi = upper[order[n.offset]];
+                    for (unsigned int k = 1; k < n.count; k++)
+                    {
+                        lo = min(lo, lower[order[n.offset + k]]);
+                        hi = max(hi, upper[order[n.offset + k]]);
+                    }
+                    set(n, lo, hi);
+                }
+                else
+                {
+                    const node& a = data[n.offset];
+                    const node& b = data[n.offset + 1];
+                    for (unsigned int j = 0; j < 3; j++)
+                    {
+                        n.lower[j] = std::min(a.lower[j], b.lower[j]);
+                        n.upper[j] = std::max(a.upper[j], b.upper[j]);
+                    }
+                }
+            }
+        }
+
+        // Number of nodes; the root is node 0.
+        size_t size() const
+        {
+            return count;
+        }
+
+        const node* nodes() const
+        {
+            return data;
+        }
+
+        // Primitive indices, leaves refer to ranges of them.
+        const std::vector<unsigned int>& indices() const
+        {
+            return order;
+        }
+
+        // Finds the closest primitive hit by r in [0, t]. test(i, t) is
+        // called for the primitives whose box the ray passes, roughly near
+        // to far, and returns the distance of the hit with primitive i, or
+        // anything not less than t if it misses. Returns the primitive hit,
+        // with t set to the distance, or NONE.
+        template <typename F>
+        size_t raycast(const ray<T>& r, T& t, F test) const
+        {
+            size_t       hit = NONE;
+            vector<T, 3> inv = vector3<T>((T)1 / r.direction[0], (T)1 / r.direction[1], (T)1 / r.direction[2]);
+            T            tn;
+            if (count == 0 || !slab(data[0], r.origin, inv, t, tn))
+            {
+                return hit;
+            }
+
+            unsigned int stack[MAX_DEPTH];
+            T            stack_t[MAX_DEPTH];
+            unsigned int top = 0;
+            unsigned int n   = 0;
+            for (;;)
+            {
+                const node& a = data[n];
+                if (a.count != 0)
+                {
+                    for (unsigned int k = 0; k < a.count; k++)
+                    {
+                        unsigned int p = order[a.offset + k];
+                        T            d = test(p, t);
+                        if (d < t)
+                        {
+                            t   = d;
+                            hit = p;
+                        }
+                    }
+                }
+                else
+                {
+                    T    t0, t1;
+                    bool h0 = slab(data[a.offset], r.origin, inv, t, t0);
+                    bool h1 = slab(data[a.offset + 1], r.origin, inv, t, t1);
+                    if (h0 && h1)
+                    {
+                        assert(top < MAX_DEPTH);
+                        bool first = t0 <= t1;
+                        stack[top]   = first ? a.offset + 1 : a.offset;
+                        stack_t[top] = first ? t1 : t0;
+                        top++;
+                        n = first ? a.offset : a.offset + 1;
+                        continue;
+                    }
+                    if (h0 || h1)
+                    {
+                        n = h0 ? a.offset : a.offset + 1;
+                        continue;
+                    }
+                }
+
+                // the next node on the stack that is still nearer than t
+                while (top > 0 && stack_t[top - 1] > t)
+                {
+                    top--;
+                }
+                if (top == 0)
+                {
+                    return hit;
+                }
+                n = stack[--top];
+            }
+        }
+
+        // Calls fn(i) for the primitives in the leaves that overlap
+        // [lower, upper]. The tree does not keep the primitive boxes, so
+        // these are candidates, a superset of the primitives whose box
+        // overlaps, and fn does the exact test.
+        template <typename F>
+        void overlap(const vector<T, 3>& lower, const vector<T, 3>& upper, F fn) const
+        {
+            if (count == 0)
+            {
+                return;
+            }
+
+            unsigned int stack[MAX_DEPTH];
+            unsigned int top = 0;
+            stack[top++] = 0;
+            while (top > 0)
+            {
+                const node& a = data[stack[--top]];
+                if (!overlaps(a, lower, upper))
+                {
+                    continue;
+                }
+                if (a.count != 0)
+                {
+                    for (unsigned int k = 0; k < a.count; k++)
+                    {
+                        fn(order[a.offset + k]);
+                    }
+                }
+                else
+                {
+                    assert(top + 2 <= MAX_DEPTH);
+                    stack[top++] = a.offset + 1;
+                    stack[top++] = a.offset;
+                }
+            }
+        }
+
+    private:
+        // Deeper than this, nodes are split in the middle instead of by
+        // SAH, which bounds the depth to about FORCE_MEDIAN + 32 and keeps
+        // the traversal stacks fixed.
+        static const unsigned int FORCE_MEDIAN = 56;
+        static const unsigned int MAX_DEPTH    = 96;
+
+        size_t                    count;
+        node*                     data;
+        std::vector<unsigned int> order;
+
+        struct box
+        {
+            vector<T, 3> lower;
+            vector<T, 3> upper;
+
+            static box empty()
+            {
+                box b;
+                b.lower = vector<T, 3>(std::numeric_limits<T>::max());
+                b.upper = vector<T, 3>(-std::numeric_limits<T>::max());
+                return b;
+            }
+
+            // written out, the loops in min() and max() do not unroll
+            void grow(const vector<T, 3>& lo, const vector<T, 3>& hi)
+            {
+                lower[0] = std::min(lower[0], lo[0]);
+                lower[1] = std::min(lower[1], lo[1]);
+                lower[2] = std::min(lower[2], lo[2]);
+                upper[0] = std::max(upper[0], hi[0]);
+                upper[1] = std::max(upper[1], hi[1]);
+                upper[2] = std::max(upper[2], hi[2]);
+            }
+
+            void grow(const box& b)
+            {
+                grow(b.lower, b.upper);
+            }
+
+            // half the surface area
+            T area() const
+            {
+                T dx = upper[0] - lower[0];
+                T dy = upper[1] - lower[1];
+                T dz = upper[2] - lower[2];
+                return dx * dy + dy * dz + dz * dx;
+            }
+        };
+
+        struct bin
+        {
+            box          bounds;
+            unsigned int count;
+        };
+
+        // bounds of the boxes and of the centroids of a range
+        struct summary
+        {
+            box bounds;
+            box centroids;
+
+            summary()
+            : bounds(box::empty()), centroids(box::empty()) {}
+
+            void merge(const summary& s)
+            {
+                bounds.grow(s.bounds);
+                centroids.grow(s.centroids);
+            }
+        };
+
+        struct task
+        {
+            size_t       index;
+            unsigned int begin;
+            unsigned int end;
+            unsigned int depth;
+            summary      bounds;
+        };
+
+        // The build works on copies of the boxes, which the partitions move
+        // around, so that the passes over a node read memory in order.
+        struct item
+        {
+            vector<T, 3> lower;
+            vector<T, 3> upper;
+            vector<T, 3> center;
+            unsigned int index;
+        };
+
+        struct builder
+        {
+            thread_pool*             pool;
+            std::vector<item>        items;
+            std::vector<node_fields> nodes;
+            std::vector<task>        tasks;
+
+            builder(thread_pool* pool, const vector<T, 3>* lower, const vector<T, 3>* upper, size_t size)
+            : pool(pool), items(size)
+            {
+                assert(size < std::numeric_limits<unsigned int>::max());
+                for_chunks(0, size, [&] (size_t b, size_t e) {
+                    for (size_t i = b; i < e; i++)
+                    {
+                        items[i].lower  = lower[i];
+                        items[i].upper  = upper[i];
+                        items[i].center = (lower[i] + upper[i]) * (T)0.5;
+                        items[i].index  = static_cast<unsigned int>(i);
+                    }
+                });
+            }
+
+            // Calls fn(b, e) on the BUILD_GRAIN chunks of [begin, end),
+            // over the pool if there is one.
+            template <typename F>
+            void for_chunks(size_t begin, size_t end, F fn)
+            {
+                if (pool != 0)
+                {
+                    parallel_for(*pool, begin, end, BUILD_GRAIN, fn);
+                }
+                else
+                {
+                    fn(begin, end);
+                }
+            }
+
+            // Chunked reduction into r, which comes in empty; the parts are
+            // merged in order, so the result does not depend on how the
+            // chunks were scheduled.
+            template <typename R, typename F>
+            void reduce(size_t begin, size_t end, R& r, F fn)
+            {
+                size_t chunks = (end - begin + BUILD_GRAIN - 1) / BUILD_GRAIN;
+                if (pool == 0 || chunks <= 1)
+                {
+                    fn(begin, end, r);
+                    return;
+                }
+                std::vector<R> parts(chunks, r);
+                for_chunks(begin, end, [&] (size_t b, size_t e) {
+                    fn(b, e, parts[(b - begin) / BUILD_GRAIN]);
+                });
+                for (size_t i = 0; i < chunks; i++)
+                {
+                    r.merge(parts[i]);
+                }
+            }
+        };
+
+        // Small nodes use fewer bins, most nodes are small.
+        struct bins_part
+        {
+            unsigned int size;
+            bin          bins[BINS];
+
+            explicit bins_part(unsigned int size)
+            : size(size)
+            {
+                for (unsigned int k = 0; k < size; k++)
+                {
+                    bins[k].bounds = box::empty();
+                    bins[k].count  = 0;
+                }
+            }
+
+            void merge(const bins_part& b)
+            {
+                for (unsigned int k = 0; k < size; k++)
+                {
+                    bins[k].bounds.grow(b.bins[k].bounds);
+                    bins[k].count += b.bins[k].count;
+                }
+            }
+        };
+
+        static void set(node_fields& n, const vector<T, 3>& lower, const vector<T, 3>& upper)
+        {
+            for (unsigned int j = 0; j < 3; j++)
+            {
+                n.lower[j] = lower[j];
+                n.upper[j] = upper[j];
+            }
+        }
+
+        static unsigned int bin_of(T c, T lower, T scale, unsigned int bins)
+        {
+            return std::min(static_cast<unsigned int>((c - lower) * scale), bins - 1);
+        }
+
+        static void grow(summary& s, const item& p)
+        {
+            s.bounds.grow(p.lower, p.upper);
+            s.centroids.grow(p.center, p.center);
+        }
+
+        static summary summarize(builder& b, unsigned int begin, unsigned int end)
+        {
+            const item* items = b.items.data();
+            summary     s;
+            b.reduce(begin, end, s, [&] (size_t i0, size_t i1, summary& r) {
+                for (size_t i = i0; i < i1; i++)
+                {
+                    grow(r, items[i]);
+                }
+            });
+            return s;
+        }
+
+        // Moves the items for which left(p) holds to the front and returns
+        // the end of them; summarizes both sides on the way, which saves
+        // the children a pass over their items.
+        template <typename F>
+        static unsigned int partition(item* items, unsigned int begin, unsigned int end, F left, summary& ls, summary& rs)
+        {
+            unsigned int i = begin;
+            unsigned int j = end;
+            for (;;)
+            {
+                while (i < j && left(items[i]))
+                {
+                    grow(ls, items[i++]);
+                }
+                while (i < j && !left(items[j - 1]))
+                {
+                    grow(rs, items[--j]);
+                }
+                if (i == j)
+                {
+                    return i;
+                }
+                std::swap(items[i], items[j - 1]);
+            }
+        }
+
+        // Builds the subtree of node index over the items [begin, end),
+        // which s summarizes.
+        static void split(builder& b, std::vector<node_fields>& nodes, size_t index, unsigned int begin, unsigned int end, const summary& s, unsigned int depth, bool tasks)
+        {
+            item* items = b.items.data();
+            set(nodes[index], s.bounds.lower, s.bounds.upper);
+
+            unsigned int size = end - begin;
+            if (tasks && size <= BUILD_TASK)
+            {
+                task t = {index, begin, end, depth, s};
+                b.tasks.push_back(t);
+                return;
+            }
+            if (size <= MIN_LEAF)
+            {
+                leaf(nodes[index], begin, size);
+                return;
+            }
+
+            vector<T, 3> extent = s.centroids.upper - s.centroids.lower;
+            unsigned int mid    = begin + size / 2;
+            summary      ls;
+            summary      rs;
+            if (depth < FORCE_MEDIAN && max(extent) > 0)
+            {
+                // binned along the axis where the centroids spread most,
+                // which costs a third of binning along all three and finds
+                // nearly as good splits
+                unsigned int axis = extent[0] >= extent[1] && extent[0] >= extent[2] ? 0 : (extent[1] >= extent[2] ? 1 : 2);
+                unsigned int nb   = std::min(size, BINS);
+                T            lo   = s.centroids.lower[axis];
+                T            sc   = (T)nb / extent[axis];
+
+                bins_part bins(nb);
+                b.reduce(begin, end, bins, [&] (size_t i0, size_t i1, bins_part& r) {
+                    for (size_t i = i0; i < i1; i++)
+                    {
+                        const item& p = items[i];
+                        bin&        k = r.bins[bin_of(p.center[axis], lo, sc, nb)];
+                        k.bounds.grow(p.lower, p.upper);
+                        k.count++;
+                    }
+                });
+
+                // sweep from the right, then from the left, for the cost
+                // of splitting after each bin
+                T            right_cost[BINS];
+                box          r  = box::empty();
+                unsigned int rn = 0;
+                for (unsigned int k = nb - 1; k > 0; k--)
+                {
+                    r.grow(bins.bins[k].bounds);
+                    rn += bins.bins[k].count;
+                    right_cost[k - 1] = r.area() * (T)rn;
+                }
+                T            best     = std::numeric_limits<T>::max();
+                unsigned int best_bin = 0;
+                box          l  = box::empty();
+                unsigned int ln = 0;
+                for (unsigned int k = 0; k + 1 < nb; k++)
+                {
+                    l.grow(bins.bins[k].bounds);
+                    ln += bins.bins[k].count;
+                    T cost = l.area() * (T)ln + right_cost[k];
+                    if (ln != 0 && ln != size && cost < best)
+                    {
+                        best     = cost;
+                        best_bin = k;
+                    }
+                }
+
+                // traversal and intersection costs of 1: a leaf costs size,
+                // a split 1 + the expected number of primitives tested
+                T area = s.bounds.area();
+                if (size <= MAX_LEAF && (T)size * area <= area + best)
+                {
+                    leaf(nodes[index], begin, size);
+                    return;
+                }
+
+                mid = partition(items, begin, end, [&] (const item& p) {
+                    return bin_of(p.center[axis], lo, sc, nb) <= best_bin;
+                }, ls, rs);
+                assert(mid > begin && mid < end);
+            }
+            else if (size <= MAX_LEAF)
+            {
+                leaf(nodes[index], begin, size);
+                return;
+            }
+            else
+            {
+                ls = summarize(b, begin, mid);
+                rs = summarize(b, mid, end);
+            }
+
+            size_t c = nodes.size();
+            nodes.resize(c + 2);
+            nodes[index].count  = 0;
+            nodes[index].offset = static_cast<unsigned int>(c);
+            split(b, nodes, c, begin, mid, ls, depth + 1, tasks);
+            split(b, nodes, c + 1, mid, end, rs, depth + 1, tasks);
+        }
+
+        static void leaf(node_fields& n, unsigned int begin, unsigned int size)
+        {
+            n.count  = size;
+            n.offset = begin;
+        }
+
+        void finish(builder& b)
+        {
+            size_t size = b.items.size();
+            allocate(0);
+            order.clear();
+            if (size == 0)
+            {
+                return;
+            }
+
+            // the top of the tree, down to subtrees of BUILD_TASK primitives
+            b.nodes.resize(1);
+            split(b, b.nodes, 0, 0, static_cast<unsigned int>(size), summarize(b, 0, static_cast<unsigned int>(size)), 0, true);
+
+            std::vector<std::vector<node_fields>> subtrees(b.tasks.size());
+            auto build_task = [&] (size_t i) {
+                const task& t = b.tasks[i];
+                subtrees[i].reserve(2 * (t.end - t.begin) / MAX_LEAF + 1);
+                subtrees[i].resize(1);
+                split(b, subtrees[i], 0, t.begin, t.end, t.bounds, t.depth, false);
+            };
+
+            // the tasks split into disjoint ranges of order and do not
+            // use the pool for themselves
+            thread_pool* pool = b.pool;
+            b.pool = 0;
+            if (pool != 0)
+            {
+                pool->run(b.tasks.size(), build_task);
+            }
+            else
+            {
+                for (size_t i = 0; i < b.tasks.size(); i++)
+                {
+                    build_task(i);
+                }
+            }
+
+            // the subtrees go after the top, without their roots, which
+            // replace the task nodes
+            std::vector<size_t> base(b.tasks.size());
+            size_t total = b.nodes.size();
+            for (size_t i = 0; i < b.tasks.size(); i++)
+            {
+                base[i] = total;
+                total  += subtrees[i].size() - 1;
+            }
+            assert(total < std::numeric_limits<unsigned int>::max());
+
+            allocate(total);
+            for (size_t i = 0; i < b.nodes.size(); i++)
+            {
+                static_cast<node_fields&>(data[i]) = b.nodes[i];
+            }
+            for (size_t i = 0; i < b.tasks.size(); i++)
+            {
+                const std::vector<node_fields>& s = subtrees[i];
+                node* d = data + base[i] - 1;
+                for (size_t j = 0; j < s.size(); j++)
+                {
+                    node_fields& n = j == 0 ? data[b.tasks[i].index] : d[j];
+                    n = s[j];
+                    if (n.count == 0)
+                    {
+                        n.offset += static_cast<unsigned int>(base[i] - 1);
+                    }
+                }
+            }
+
+            order.resize(size);
+            for (size_t i = 0; i < size; i++)
+            {
+                order[i] = b.items[i].index;
+            }
+        }
+
+        void allocate(size_t size)
+        {
+            aligned_free(data);
+            data  = 0;
+            count = size;
+            if (size != 0)
+            {
+                data = static_cast<node*>(aligned_malloc(size * sizeof(node), alignof(node)));
+            }
+        }
+
+        // Entry distance of a ray, given by its origin and the inverse of
+        // its direction, into the box of n, if it is entered in [0, tmax].
+        static bool slab(const node& n, const vector<T, 3>& origin, const vector<T, 3>& inv, T tmax, T& tnear)
+        {
+            T t0 = (T)0;
+            T t1 = tmax;
+            for (unsigned int j = 0; j < 3; j++)
+            {
+                T a = (n.lower[j] - origin[j]) * inv[j];
+                T b = (n.upper[j] - origin[j]) * inv[j];
+                t0 = std::max(t0, std::min(a, b));
+                t1 = std::min(t1, std::max(a, b));
+            }
+            tnear = t0;
+            return t0 <= t1;
+        }
+
+        static bool overlaps(const node& n, const vector<T, 3>& lower, const vector<T, 3>& upper)
+        {
+            return lower[0] <= n.upper[0] && lower[1] <= n.upper[1] && lower[2] <= n.upper[2] &&
+                   upper[0] >= n.lower[0] && upper[1] >= n.lower[1] && upper[2] >= n.lower[2];
+        }
+    };
+
+    template <typename T> const size_t       bvh<T>::NONE;
+    template <typename T> const unsigned int bvh<T>::BINS;
+    template <typename T> const unsigned int bvh<T>::MIN_LEAF;
+    template <typename T> const unsigned int bvh<T>::MAX_LEAF;
+    template <typename T> const unsigned int bvh<T>::BUILD_TASK;
+    template <typename T> const unsigned int bvh<T>::BUILD_GRAIN;
+    template <typename T> const unsigned int bvh<T>::FORCE_MEDIAN;
+    template <typename T> const unsigned int bvh<T>::MAX_DEPTH;
+}
+
+#endif
@@ -0,0 +1,372 @@
+/*
+    rgm - Rioki's Graphic Math Library
+
+    Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+#ifndef _RGM_CULLING_H_
+#define _RGM_CULLING_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "simd.h"
+#include "vector.h"
+#include "matrix.h"
+#include "stream.h"
+#include "parallel.h"
+
+namespace rgm
+{
+    // The six planes of a view frustum, extracted from a view-projection
+    // matrix with the Gribb/Hartmann method for OpenGL clip space
+    // (-w <= x, y, z <= w). A plane (a, b, c, d) has a unit normal (a, b, c)
+    // pointing into the frustum, so a*x + b*y + c*z + d is the signed
+    // distance of a point to it. The planes are in the order left, right,
+    // bottom, top, near and far.
+    template <typename T>
+    class frustum_planes
+    {
+    public:
+        frustum_planes() {}
+
+        explicit frustum_planes(const matrix<T, 4>& viewprojection)
+        {
+            const matrix<T, 4>& m = viewprojection;
+            for (unsigned int i = 0; i < 3; i++)
+            {
+                for (unsigned int k = 0; k < 4; k++)
+                {
+                    planes[2*i][k]     = m.at(k, 3) + m.at(k, i);
+                    planes[2*i + 1][k] = m.at(k, 3) - m.at(k, i);
+                }
+            }
+            for (unsigned int i = 0; i < 6; i++)
+            {
+                vector<T, 4>& p = planes[i];
+                p = p / std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+            }
+        }
+
+        const vector<T, 4>& operator [] (unsigned int i) const
+        {
+            assert(i < 6);
+            return planes[i];
+        }
+
+    private:
+        vector<T, 4> planes[6];
+    };
+
+    // Tests if a sphere is at least partly inside the frustum. The test is
+    // conservative: large spheres near a corner can pass without touching it.
+    template <typename T>
+    bool visible(const frustum_planes<T>& f, const vector<T, 3>& center, T radius)
+    {
+        for (unsigned int i = 0; i < 6; i++)
+        {
+            const vector<T, 4>& p = f[i];
+            // summed in the same order as the batch kernels
+            if (p[0] * center[0] + (p[1] * center[1] + (p[2] * center[2] + (p[3] + radius))) < 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Tests if an axis aligned box is at least partly inside the frustum,
+    // by testing the corner furthest along each plane normal. Same as for
+    // spheres, the test is conservative.
+    template <typename T>
+    bool visible(const frustum_planes<T>& f, const vector<T, 3>& lower, const vector<T, 3>& upper)
+    {
+        for (unsigned int i = 0; i < 6; i++)
+        {
+            const vector<T, 4>& p = f[i];
+            T x = p[0] >= 0 ? upper[0] : lower[0];
+            T y = p[1] >= 0 ? upper[1] : lower[1];
+            T z = p[2] >= 0 ? upper[2] : lower[2];
+            if (p[0] * x + (p[1] * y + (p[2] * z + p[3])) < 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // The culling functions with a thread pool split the objects into
+    // chunks of CULL_GRAIN.
+    const size_t CULL_GRAIN = 8192;
+
+    namespace simd
+    {
+        // The batch kernels take the minimum signed distance over the six
+        // planes and read the visibility off its sign bit, so there is no
+        // branch per object; visible_bits() has bit k set if object i + k
+        // is visible. The lanes past count are padding and always cleared.
+        template <typename T>
+        inline unsigned int visible_bits(typename batch<T>::type d, size_t i, size_t count)
+        {
+            unsigned int bits = ~signmask(d) & ((1u << batch<T>::size) - 1);
+            if (i + batch<T>::size > count)
+            {
+                bits &= (1u << (count - i)) - 1;
+            }
+            return bits;
+        }
+
+        // Signed distance of a batch of points to a plane, plus r.
+        template <typename T>
+        inline typename batch<T>::type plane(const vector<T, 4>& p, typename batch<T>::type x, typename batch<T>::type y,
+                                             typename batch<T>::type z, typename batch<T>::type r)
+        {
+            typedef batch<T> B;
+            return madd(B::splat(p[0]), x, madd(B::splat(p[1]), y, madd(B::splat(p[2]), z, add(B::splat(p[3]), r))));
+        }
+
+        template <typename T>
+        struct sphere_kernel
+        {
+            typedef T value_type;
+
+            const T* x;
+            const T* y;
+            const T* z;
+            const T* r;
+
+            explicit sphere_kernel(const vector_stream<T, 4>& spheres)
+            : x(spheres.lane(0)), y(spheres.lane(1)), z(spheres.lane(2)), r(spheres.lane(3)) {}
+
+            typename batch<T>::type distance(const frustum_planes<T>& f, size_t i) const
+            {
+                typedef batch<T> B;
+                typedef typename B::type P;
+
+                P cx = B::load(x + i);
+                P cy = B::load(y + i);
+                P cz = B::load(z + i);
+                P cr = B::load(r + i);
+
+                P d = plane(f[0], cx, cy, cz, cr);
+                for (unsigned int k = 1; k < 6; k++)
+                {
+                    d = min(d, plane(f[k], cx, cy, cz, cr));
+                }
+                return d;
+            }
+        };
+
+        template <typename T>
+        struct box_kernel
+        {
+            typedef T value_type;
+
+            // per plane, the lanes holding the corner furthest along the normal
+            const T* x[6];
+            const T* y[6];
+            const T* z[6];
+
+            box_kernel(const frustum_planes<T>& f, const vector_stream<T, 3>& lower, const vector_stream<T, 3>& upper)
+            {
+                for (unsigned int k = 0; k < 6; k++)
+                {
+                    x[k] = f[k][0] >= 0 ? upper.lane(0) : lower.lane(0);
+                    y[k] = f[k][1] >= 0 ? upper.lane(1) : lower.lane(1);
+                    z[k] = f[k][2] >= 0 ? upper.lane(2) : lower.lane(2);
+                }
+            }
+
+            typename batch<T>::type distance(const frustum_planes<T>& f, size_t i) const
+            {
+                typedef batch<T> B;
+                typedef typename B::type P;
+
+                P d = plane(f[0], B::load(x[0] + i), B::load(y[0] + i), B::load(z[0] + i), B::splat(0));
+                for (unsigned int k = 1; k < 6; k++)
+                {
+                    d = min(d, plane(f[k], B::load(x[k] + i), B::load(y[k] + i), B::load(z[k] + i), B::splat(0)));
+                }
+                return d;
+            }
+        };
+
+        // The kernels below work on [begin, end) of count objects, where
+        // begin is a multiple of 32 and end is a multiple of 32 or count.
+        template <typename K>
+        inline void visible_mask(const frustum_planes<typename K::value_type>& f, const K& kernel, size_t begin, size_t end, size_t count, unsigned int* r)
+        {
+            typedef typename K::value_type T;
+
+            for (size_t i = begin; i < end; i += batch<T>::size)
+            {
+                // batches never straddle a word, the size is a power of 2
+                r[i / 32] |= visible_bits<T>(kernel.distance(f, i), i, count) << (i % 32);
+            }
+        }
+
+        // Writes the visible indices to out and returns their number. Every
+        // index is written and only the visible ones advance n, so out
+        // needs room for end - begin + batch<T>::size entries.
+        template <typename K>
+        inline size_t visible_indices(const frustum_planes<typename K::value_type>& f, const K& kernel, size_t begin, size_t end, size_t count, unsigned int* out)
+        {
+            typedef typename K::value_type T;
+
+            size_t n = 0;
+            for (size_t i = begin; i < end; i += batch<T>::size)
+            {
+                unsigned int bits = visible_bits<T>(kernel.distance(f, i), i, count);
+                for (unsigned int k = 0; k < batch<T>::size; k++)
+                {
+                    out[n] = static_cast<unsigned int>(i + k);
+                    n += (bits >> k) & 1;
+                }
+            }
+            return n;
+        }
+
+        template <typename K>
+        inline void visible_mask(const frustum_planes<typename K::value_type>& f, const K& kernel, size_t count, std::vector<unsigned int>& r)
+        {
+            r.assign((count + 31) / 32, 0);
+            visible_mask(f, kernel, 0, count, count, r.data());
+        }
+
+        template <typename K>
+        inline void visible_indices(const frustum_planes<typename K::value_type>& f, const K& kernel, size_t count, std::vector<unsigned int>& r)
+        {
+            typedef typename K::value_type T;
+
+            r.resize(count + batch<T>::size);
+            r.resize(visible_indices(f, kernel, 0, count, count, r.data()));
+        }
+
+        // Chunks of CULL_GRAIN objects, a multiple of 32, write whole words
+        // of the mask. For the indices each chunk compacts its own part of
+        // r, and the parts are then moved together in order.
+        template <typename K>
+        inline void visible_mask(thread_pool& pool, const frustum_planes<typename K::value_type>& f, const K& kernel, size_t count, std::vector<unsigned int>& r)
+        {
+            static_assert(CULL_GRAIN % 32 == 0, "chunks need to fill words of the mask");
+
+            r.assign((count + 31) / 32, 0);
+            unsigned int* out = r.data();
+            parallel_for(pool, 0, count, CULL_GRAIN, [&] (size_t b, size_t e) {
+                visible_mask(f, kernel, b, e, count, out);
+            });
+        }
+
+        template <typename K>
+        inline void visible_indices(thread_pool& pool, const frustum_planes<typename K::value_type>& f, const K& kernel, size_t count, std::vector<unsigned int>& r)
+        {
+            typedef typename K::value_type T;
+
+            r.resize(count + batch<T>::size);
+            std::vector<size_t> found((count + CULL_GRAIN - 1) / CULL_GRAIN);
+            unsigned int* out = r.data();
+            parallel_for(pool, 0, count, CULL_GRAIN, [&] (size_t b, size_t e) {
+                found[b / CULL_GRAIN] = visible_indices(f, kernel, b, e, count, out + b);
+            });
+
+            size_t n = 0;
+            for (size_t c = 0; c < found.size(); c++)
+            {
+                // while all chunks so far were fully visible the indices
+                // are already in place, and copying onto itself is undefined
+                if (n != c * CULL_GRAIN)
+                {
+                    std::copy(out + c * CULL_GRAIN, out + c * CULL_GRAIN + found[c], out + n);
+                }
+                n += found[c];
+            }
+            r.resize(n);
+        }
+    }
+
+    // Culls a stream of bounding spheres (x, y, z, radius) against the
+    // frustum. Bit i % 32 of r[i / 32] is set if sphere i is visible.
+    template <typename T>
+    void visible_mask(const frustum_planes<T>& f, const vector_stream<T, 4>& spheres, std::vector<unsigned int>& r)
+    {
+        simd::visible_mask(f, simd::sphere_kernel<T>(spheres), spheres.size(), r);
+    }
+
+    // Culls a stream of axis aligned boxes, given by their lower and upper
+    // corners, against the frustum. Bit i % 32 of r[i / 32] is set if box i
+    // is visible.
+    template <typename T>
+    void visible_mask(const frustum_planes<T>& f, const vector_stream<T, 3>& lower, const vector_stream<T, 3>& upper, std::vector<unsigned int>& r)
+    {
+        assert(lower.size() == upper.size());
+        simd::visible_mask(f, simd::box_kernel<T>(f, lower, upper), lower.size(), r);
+    }
+
+    // Culls a stream of bounding spheres and writes the indices of the
+    // visible ones, in ascending order, to r.
+    template <typename T>
+    void visible_indices(const frustum_planes<T>& f, const vector_stream<T, 4>& spheres, std::vector<unsigned int>& r)
+    {
+        simd::visible_indices(f, simd::sphere_kernel<T>(spheres), spheres.size(), r);
+    }
+
+    // Culls a stream of axis aligned boxes and writes the indices of the
+    // visible ones, in ascending order, to r.
+    template <typename T>
+    void visible_indices(const frustum_planes<T>& f, const vector_stream<T, 3>& lower, const vector_stream<T, 3>& upper, std::vector<unsigned int>& r)
+    {
+        assert(lower.size() == upper.size());
+        simd::visible_indices(f, simd::box_kernel<T>(f, lower, upper), lower.size(), r);
+    }
+
+    // The same, with the objects split over the threads of a pool. The
+    // results are the same as without.
+    template <typename T>
+    void visible_mask(thread_pool& pool, const frustum_planes<T>& f, const vector_stream<T, 4>& spheres, std::vector<unsigned int>& r)
+    {
+        simd::visible_mask(pool, f, simd::sphere_kernel<T>(spheres), spheres.size(), r);
+    }
+
+    template <typename T>
+    void visible_mask(thread_pool& pool, const frustum_planes<T>& f, const vector_stream<T, 3>& lower, const vector_stream<T, 3>& upper, std::vector<unsigned int>& r)
+    {
+        assert(lower.size() == upper.size());
+        simd::visible_mask(pool, f, simd::box_kernel<T>(f, lower, upper), lower.size(), r);
+    }
+
+    template <typename T>
+    void visible_indices(thread_pool& pool, const frustum_planes<T>& f, const vector_stream<T, 4>& spheres, std::vector<unsigned int>& r)
+    {
+        simd::visible_indices(pool, f, simd::sphere_kernel<T>(spheres), spheres.size(), r);
+    }
+
+    template <typename T>
+    void visible_indices(thread_pool& pool, const frustum_planes<T>& f, const vector_stream<T, 3>& lower, const vector_stream<T, 3>& upper, std::vector<unsigned int>& r)
+    {
+        assert(lower.size() == upper.size());
+        simd::visible_indices(pool, f, simd::box_kernel<T>(f, lower, upper), lower.size(), r);
+    }
+}
+
+#endif
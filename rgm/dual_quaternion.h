@@ -0,0 +1,429 @@
+/*
+    rgm - Rioki's Graphic Math Library
+
+    Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+#ifndef _RGM_DUAL_QUATERNION_H_
+#define _RGM_DUAL_QUATERNION_H_
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+#include "simd.h"
+#include "vector.h"
+#include "matrix.h"
+#include "quaternion.h"
+#include "stream.h"
+#include "parallel.h"
+
+namespace rgm
+{
+    // Rigid transformation as dual quaternion real + e dual, where real is
+    // the rotation and dual = 0.5 (translation, 0) real. Like matrices,
+    // a * b applies b first. Unlike matrices, rigid transformations blend
+    // without shrinking the mesh, which makes them a good fit for skinning,
+    // and take 8 instead of 16 elements per bone.
+    template <typename T>
+    class dual_quaternion
+    {
+    public:
+        quaterion<T> real;
+        quaterion<T> dual;
+
+        // identity
+        constexpr dual_quaternion()
+        : real(0, 0, 0, 1), dual(0, 0, 0, 0) {}
+
+        constexpr dual_quaternion(const quaterion<T>& real, const quaterion<T>& dual)
+        : real(real), dual(dual) {}
+
+        // Rotation by the unit quaternion rotation, followed by translation.
+        constexpr dual_quaternion(const quaterion<T>& rotation, const vector<T, 3>& translation)
+        : real(rotation), dual(quaterion<T>(translation, 0) * rotation * (T)0.5) {}
+    };
+
+    template <typename T>
+    constexpr dual_quaternion<T> operator * (const dual_quaternion<T>& a, const dual_quaternion<T>& b)
+    {
+        return dual_quaternion<T>(a.real * b.real, quaterion<T>(a.real * b.dual + a.dual * b.real));
+    }
+
+    // The quaternion conjugate of both parts; for unit dual quaternions
+    // this is the inverse.
+    template <typename T>
+    constexpr dual_quaternion<T> conjugate(const dual_quaternion<T>& q)
+    {
+        return dual_quaternion<T>(conjugate(q.real), conjugate(q.dual));
+    }
+
+    template <typename T>
+    constexpr dual_quaternion<T> inverse(const dual_quaternion<T>& q)
+    {
+        return conjugate(q);
+    }
+
+    // Scales q to a unit dual quaternion and removes the part of dual that
+    // is not orthogonal to real, so that q is a rigid transformation again,
+    // e.g. after blending or many compositions.
+    template <typename T>
+    dual_quaternion<T> normalize(const dual_quaternion<T>& q)
+    {
+        T            l = length(q.real);
+        quaterion<T> r = q.real / l;
+        quaterion<T> d = q.dual / l;
+        return dual_quaternion<T>(r, quaterion<T>(d - r * dot(r, d)));
+    }
+
+    template <typename T>
+    constexpr quaterion<T> rotation(const dual_quaternion<T>& q)
+    {
+        return q.real;
+    }
+
+    template <typename T>
+    constexpr vector<T, 3> translation(const dual_quaternion<T>& q)
+    {
+        return vector3<T>(q.dual * conjugate(q.real) * (T)2);
+    }
+
+    // Rotates the direction d by the unit dual quaternion q.
+    template <typename T>
+    constexpr vector<T, 3> transform_direction(const dual_quaternion<T>& q, const vector<T, 3>& d)
+    {
+        vector3<T> v = vector3<T>(q.real);
+        return d + cross(v, cross(v, d) + d * q.real[3]) * (T)2;
+    }
+
+    // Rotates and translates the point p by the unit dual quaternion q.
+    template <typename T>
+    constexpr vector<T, 3> transform_point(const dual_quaternion<T>& q, const vector<T, 3>& p)
+    {
+        return transform_direction(q, p) + translation(q);
+    }
+
+    template <typename T>
+    constexpr matrix<T, 4> dualquat2mat4(const dual_quaternion<T>& q)
+    {
+        matrix<T, 4> m = quat2mat4(q.real);
+        vector<T, 3> t = translation(q);
+        m.at(3, 0) = t[0];
+        m.at(3, 1) = t[1];
+        m.at(3, 2) = t[2];
+        return m;
+    }
+
+    // The rigid transformation m, which must not scale or shear.
+    template <typename T>
+    dual_quaternion<T> mat42dualquat(const matrix<T, 4>& m)
+    {
+        return dual_quaternion<T>(mat42quat(m), vector3<T>(m.at(3, 0), m.at(3, 1), m.at(3, 2)));
+    }
+
+    // Dual quaternion linear blending (Kavan et al. 2007): the weighted sum
+    // of count unit dual quaternions, normalized. Quaternions on the other
+    // hemisphere than the first are negated, so the blend takes the
+    // shortest path. The weights need not sum to 1.
+    template <typename T>
+    dual_quaternion<T> blend(const dual_quaternion<T>* q, const T* weights, size_t count)
+    {
+        assert(count > 0);
+        quaterion<T> r = quaterion<T>(0);
+        quaterion<T> d = quaterion<T>(0);
+        for (size_t i = 0; i < count; i++)
+        {
+            T w = dot(q[i].real, q[0].real) < 0 ? -weights[i] : weights[i];
+            r += q[i].real * w;
+            d += q[i].dual * w;
+        }
+        return normalize(dual_quaternion<T>(r, d));
+    }
+
+    typedef dual_quaternion<float>  dualquat;
+    typedef dual_quaternion<double> ddualquat;
+
+    static_assert(std::is_trivially_copyable<dualquat>::value && sizeof(dualquat) == 8 * sizeof(float), "dual quaternions must be trivially copyable and packed");
+
+    // Skinning with a thread pool splits the vertices into chunks of
+    // SKIN_GRAIN.
+    const size_t SKIN_GRAIN = 2048;
+
+    namespace simd
+    {
+        // batch<T>::size 3 element vectors, one register per component.
+        template <typename T>
+        struct vectors
+        {
+            typedef typename batch<T>::type P;
+
+            P x, y, z;
+        };
+
+        template <typename T>
+        inline vectors<T> cross(const vectors<T>& a, const vectors<T>& b)
+        {
+            vectors<T> r;
+            r.x = sub(mul(a.y, b.z), mul(a.z, b.y));
+            r.y = sub(mul(a.z, b.x), mul(a.x, b.z));
+            r.z = sub(mul(a.x, b.y), mul(a.y, b.x));
+            return r;
+        }
+
+        // v + 2 r x (r x v + w v), the rotation of v by the unit
+        // quaternion q = (r, w).
+        template <typename T>
+        inline vectors<T> rotate(const quaternions<T>& q, const vectors<T>& v)
+        {
+            vectors<T> r = {q.x, q.y, q.z};
+            vectors<T> c = cross(r, v);
+            c.x = madd(v.x, q.w, c.x);
+            c.y = madd(v.y, q.w, c.y);
+            c.z = madd(v.z, q.w, c.z);
+            vectors<T> e   = cross(r, c);
+            typename batch<T>::type two = batch<T>::splat(2);
+            vectors<T> o;
+            o.x = madd(e.x, two, v.x);
+            o.y = madd(e.y, two, v.y);
+            o.z = madd(e.z, two, v.z);
+            return o;
+        }
+
+        // 2 (w d - dw r + r x d), the translation of the unit dual
+        // quaternion (q, d).
+        template <typename T>
+        inline vectors<T> translation(const quaternions<T>& q, const quaternions<T>& d)
+        {
+            vectors<T> r  = {q.x, q.y, q.z};
+            vectors<T> dv = {d.x, d.y, d.z};
+            vectors<T> c  = cross(r, dv);
+            typename batch<T>::type two = batch<T>::splat(2);
+            vectors<T> t;
+            t.x = mul(two, sub(madd(q.w, d.x, c.x), mul(d.w, q.x)));
+            t.y = mul(two, sub(madd(q.w, d.y, c.y), mul(d.w, q.y)));
+            t.z = mul(two, sub(madd(q.w, d.z, c.z), mul(d.w, q.z)));
+            return t;
+        }
+
+        // Gathers bone k of batch<T>::size vertices starting at vertex i.
+        // Vertices past count, in the padding, use bone 0 instead of
+        // reading bones at indices that may have any value.
+        template <typename T>
+        inline void gather_bones(const dual_quaternion<T>* bones, const unsigned int* indices, size_t i, size_t count,
+                          quaternions<T>& real, quaternions<T>& dual)
+        {
+            const T* reals[batch<T>::size];
+            const T* duals[batch<T>::size];
+            for (unsigned int l = 0; l < batch<T>::size; l++)
+            {
+                const dual_quaternion<T>& b = bones[i + l < count ? indices[i + l] : 0];
+                reals[l] = b.real.c_array();
+                duals[l] = b.dual.c_array();
+            }
+            typename batch<T>::type c[4];
+            batch<T>::load_transposed4(reals, c);
+            real.x = c[0];
+            real.y = c[1];
+            real.z = c[2];
+            real.w = c[3];
+            batch<T>::load_transposed4(duals, c);
+            dual.x = c[0];
+            dual.y = c[1];
+            dual.z = c[2];
+            dual.w = c[3];
+        }
+
+        // Blends the 4 bones of batch<T>::size vertices starting at vertex
+        // i, like blend().
+        template <typename T>
+        inline void blend_bones(const dual_quaternion<T>* bones, const unsigned int* const* indices, const T* const* weights,
+                         size_t i, size_t count, quaternions<T>& real, quaternions<T>& dual)
+        {
+            typedef batch<T> B;
+            typedef typename B::type P;
+
+            quaternions<T> first;
+            quaternions<T> d;
+            gather_bones(bones, indices[0], i, count, first, d);
+            P w = B::load(weights[0] + i);
+            real.x = mul(first.x, w);
+            real.y = mul(first.y, w);
+            real.z = mul(first.z, w);
+            real.w = mul(first.w, w);
+            dual.x = mul(d.x, w);
+            dual.y = mul(d.y, w);
+            dual.z = mul(d.z, w);
+            dual.w = mul(d.w, w);
+
+            for (unsigned int k = 1; k < 4; k++)
+            {
+                quaternions<T> r;
+                gather_bones(bones, indices[k], i, count, r, d);
+                w = flipsign(B::load(weights[k] + i), madd(first.w, r.w, madd(first.z, r.z, madd(first.y, r.y, mul(first.x, r.x)))));
+                real.x = madd(r.x, w, real.x);
+                real.y = madd(r.y, w, real.y);
+                real.z = madd(r.z, w, real.z);
+                real.w = madd(r.w, w, real.w);
+                dual.x = madd(d.x, w, dual.x);
+                dual.y = madd(d.y, w, dual.y);
+                dual.z = madd(d.z, w, dual.z);
+                dual.w = madd(d.w, w, dual.w);
+            }
+
+            // the translation and rotate() only need real to be of unit
+            // length, not the dual part to be orthogonal
+            P l = div(B::splat(1), sqrt(madd(real.w, real.w, madd(real.z, real.z, madd(real.y, real.y, mul(real.x, real.x))))));
+            real.x = mul(real.x, l);
+            real.y = mul(real.y, l);
+            real.z = mul(real.z, l);
+            real.w = mul(real.w, l);
+            dual.x = mul(dual.x, l);
+            dual.y = mul(dual.y, l);
+            dual.z = mul(dual.z, l);
+            dual.w = mul(dual.w, l);
+        }
+
+        template <typename T>
+        inline vectors<T> load_vectors(const T* const* v, size_t i)
+        {
+            vectors<T> r;
+            r.x = batch<T>::load(v[0] + i);
+            r.y = batch<T>::load(v[1] + i);
+            r.z = batch<T>::load(v[2] + i);
+            return r;
+        }
+
+        template <typename T>
+        inline void store_vectors(T* const* v, size_t i, const vectors<T>& r)
+        {
+            batch<T>::store(v[0] + i, r.x);
+            batch<T>::store(v[1] + i, r.y);
+            batch<T>::store(v[2] + i, r.z);
+        }
+
+        // Without a pool the vertices are skinned in one pass, with a pool
+        // in chunks of SKIN_GRAIN, a multiple of every batch size.
+        template <typename T>
+        void skin(const dual_quaternion<T>* bones, const vector_stream<unsigned int, 4>& indices, const vector_stream<T, 4>& weights,
+                  const vector_stream<T, 3>& positions, const vector_stream<T, 3>* normals, vector_stream<T, 3>& rp, vector_stream<T, 3>* rn,
+                  thread_pool* pool)
+        {
+            assert(indices.size() == positions.size() && weights.size() == positions.size());
+            assert(normals == 0 || normals->size() == positions.size());
+
+            size_t count = positions.size();
+            rp.resize(count);
+            if (rn != 0)
+            {
+                rn->resize(count);
+            }
+
+            const unsigned int* pi[4];
+            const T*            pw[4];
+            for (unsigned int k = 0; k < 4; k++)
+            {
+                pi[k] = indices.lane(k);
+                pw[k] = weights.lane(k);
+            }
+            const T* pp[3];
+            const T* pn[3];
+            T*       prp[3];
+            T*       prn[3];
+            for (unsigned int j = 0; j < 3; j++)
+            {
+                pp[j]  = positions.lane(j);
+                pn[j]  = normals != 0 ? normals->lane(j) : 0;
+                prp[j] = rp.lane(j);
+                prn[j] = rn != 0 ? rn->lane(j) : 0;
+            }
+
+            auto range = [&] (size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i += batch<T>::size)
+                {
+                    quaternions<T> real;
+                    quaternions<T> dual;
+                    blend_bones(bones, pi, pw, i, count, real, dual);
+
+                    vectors<T> p = rotate(real, load_vectors(pp, i));
+                    vectors<T> t = translation(real, dual);
+                    p.x = add(p.x, t.x);
+                    p.y = add(p.y, t.y);
+                    p.z = add(p.z, t.z);
+                    store_vectors(prp, i, p);
+
+                    if (rn != 0)
+                    {
+                        store_vectors(prn, i, rotate(real, load_vectors(pn, i)));
+                    }
+                }
+            };
+
+            if (pool != 0)
+            {
+                parallel_for(*pool, 0, positions.padded_size(), SKIN_GRAIN, range);
+            }
+            else
+            {
+                range(0, positions.padded_size());
+            }
+        }
+    }
+
+    // Dual quaternion skinning of a vertex stream. Vertex i is transformed
+    // by the blend of the bones indices[k] with weights[k], k < 4; unused
+    // influences need a weight of 0, and the weights need not sum to 1.
+    // Same as transform_point(blend(...), p) for every vertex, but the
+    // blend and the transformation run on batch<T>::size vertices at once.
+    template <typename T>
+    void skin(const dual_quaternion<T>* bones, const vector_stream<unsigned int, 4>& indices, const vector_stream<T, 4>& weights,
+              const vector_stream<T, 3>& positions, vector_stream<T, 3>& r)
+    {
+        simd::skin<T>(bones, indices, weights, positions, 0, r, 0, 0);
+    }
+
+    // Skins positions and normals with the same blend.
+    template <typename T>
+    void skin(const dual_quaternion<T>* bones, const vector_stream<unsigned int, 4>& indices, const vector_stream<T, 4>& weights,
+              const vector_stream<T, 3>& positions, const vector_stream<T, 3>& normals,
+              vector_stream<T, 3>& rpositions, vector_stream<T, 3>& rnormals)
+    {
+        simd::skin<T>(bones, indices, weights, positions, &normals, rpositions, &rnormals, 0);
+    }
+
+    // The same, with the vertices split over the threads of a pool.
+    template <typename T>
+    void skin(thread_pool& pool, const dual_quaternion<T>* bones, const vector_stream<unsigned int, 4>& indices, const vector_stream<T, 4>& weights,
+              const vector_stream<T, 3>& positions, vector_stream<T, 3>& r)
+    {
+        simd::skin<T>(bones, indices, weights, positions, 0, r, 0, &pool);
+    }
+
+    template <typename T>
+    void skin(thread_pool& pool, const dual_quaternion<T>* bones, const vector_stream<unsigned int, 4>& indices, const vector_stream<T, 4>& weights,
+              const vector_stream<T, 3>& positions, const vector_stream<T, 3>& normals,
+              vector_stream<T, 3>& rpositions, vector_stream<T, 3>& rnormals)
+    {
+        simd::skin<T>(bones, indices, weights, positions, &normals, rpositions, &rnormals, &pool);
+    }
+}
+
+#endif
@@ -0,0 +1,426 @@
+/*
+    rgm - Rioki's Graphic Math Library
+
+    Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+#ifndef _RGM_EXPRESSION_H_
+#define _RGM_EXPRESSION_H_
+
+#include <type_traits>
+
+#include "simd.h"
+#include "vector.h"
+#include "matrix.h"
+
+namespace rgm
+{
+    // Opt-in expression templates for element wise arithmetic. The plain
+    // operators build a full temporary for every step; an expression started
+    // with lazy() instead records the operations and computes each element
+    // of the result once, in a single loop, when it is assigned:
+    //
+    //     vec4 r = lazy(a) * (1 - w) + lazy(b) * w;
+    //
+    // Vectors support + - * / element wise and * / with a scalar; matrices
+    // only + - and * / with a scalar, since * between matrices is the
+    // product. The expression refers to its operands, so it must be
+    // evaluated before they go away; do not keep it in an auto variable.
+    //
+    // Vectors with a SIMD register type are computed in registers, one
+    // instruction per operation; everything else element by element.
+    namespace expr
+    {
+        template <typename V>
+        struct traits;
+
+        template <typename T, unsigned int N>
+        struct traits< vector<T, N> >
+        {
+            typedef T value_type;
+            static const unsigned int size = N;
+
+            static T* data(vector<T, N>& v)
+            {
+                return &v[0];
+            }
+        };
+
+        template <typename T, unsigned int N>
+        struct traits< matrix<T, N> >
+        {
+            typedef T value_type;
+            static const unsigned int size = N * N;
+
+            static T* data(matrix<T, N>& m)
+            {
+                return &m[0][0];
+            }
+        };
+
+        template <typename V, typename = void>
+        struct kernel
+        {
+            template <typename E>
+            static void run(const E& e, typename traits<V>::value_type* p)
+            {
+                for (unsigned int i = 0; i < traits<V>::size; i++)
+                {
+                    p[i] = e.element(i);
+                }
+            }
+        };
+
+#ifdef RGM_SSE2
+        template <typename T, unsigned int N>
+        struct kernel<vector<T, N>, typename std::enable_if<sizeof(typename simd::packed<T, N>::type) != 0>::type>
+        {
+            template <typename E>
+            static void run(const E& e, T* p)
+            {
+                typedef simd::packed<T, N> S;
+                S::store(p, e.template packet<S>());
+            }
+        };
+#endif
+
+        // Base of all nodes; E is the node and V the type of the result.
+        template <typename E, typename V>
+        class expression
+        {
+        public:
+            typedef V                              result_type;
+            typedef typename traits<V>::value_type value_type;
+
+            const E& self() const
+            {
+                return static_cast<const E&>(*this);
+            }
+
+            V evaluate() const
+            {
+                V r((simd::no_init()));
+                kernel<V>::run(self(), traits<V>::data(r));
+                return r;
+            }
+
+            // Converts to V and the types derived from it, such as vec3.
+            template <typename R, typename = typename std::enable_if<std::is_base_of<V, R>::value>::type>
+            operator R () const
+            {
+                return R(evaluate());
+            }
+        };
+
+        template <typename V>
+        class terminal : public expression<terminal<V>, V>
+        {
+        public:
+            typedef typename traits<V>::value_type value_type;
+
+            explicit terminal(const V& v)
+            : p(v.c_array()) {}
+
+            explicit terminal(const value_type* p)
+            : p(p) {}
+
+            value_type element(unsigned int i) const
+            {
+                return p[i];
+            }
+
+            template <typename S>
+            typename S::type packet() const
+            {
+                return S::load(p);
+            }
+
+        private:
+            const value_type* p;
+        };
+
+        template <typename V>
+        class scalar : public expression<scalar<V>, V>
+        {
+        public:
+            typedef typename traits<V>::value_type value_type;
+
+            explicit scalar(value_type v)
+            : v(v) {}
+
+            value_type element(unsigned int) const
+            {
+                return v;
+            }
+
+            template <typename S>
+            typename S::type packet() const
+            {
+                return S::splat(v);
+            }
+
+        private:
+            value_type v;
+        };
+
+        template <typename Op, typename A>
+        class unary : public expression<unary<Op, A>, typename A::result_type>
+        {
+        public:
+            typedef typename A::value_type value_type;
+
+            explicit unary(const A& a)
+            : a(a) {}
+
+            value_type element(unsigned int i) const
+            {
+                return Op::apply(a.element(i));
+            }
+
+            template <typename S>
+            typename S::type packet() const
+            {
+                return Op::apply(a.template packet<S>());
+            }
+
+        private:
+            A a;
+        };
+
+        template <typename Op, typename A, typename B>
+        class binary : public expression<binary<Op, A, B>, typename A::result_type>
+        {
+        public:
+            typedef typename A::value_type value_type;
+
+            binary(const A& a, const B& b)
+            : a(a), b(b) {}
+
+            value_type element(unsigned int i) const
+            {
+                return Op::apply(a.element(i), b.element(i));
+            }
+
+            template <typename S>
+            typename S::type packet() const
+            {
+                return Op::apply(a.template packet<S>(), b.template packet<S>());
+            }
+
+        private:
+            A a;
+            B b;
+        };
+
+        struct negate
+        {
+            template <typename T>
+            static T apply(T a)
+            {
+                return simd::neg(a);
+            }
+        };
+
+        struct plus
+        {
+            template <typename T>
+            static T apply(T a, T b)
+            {
+                return simd::add(a, b);
+            }
+        };
+
+        struct minus
+        {
+            template <typename T>
+            static T apply(T a, T b)
+            {
+                return simd::sub(a, b);
+            }
+        };
+
+        struct multiplies
+        {
+            template <typename T>
+            static T apply(T a, T b)
+            {
+                return simd::mul(a, b);
+            }
+        };
+
+        struct divides
+        {
+            template <typename T>
+            static T apply(T a, T b)
+            {
+                return simd::div(a, b);
+            }
+        };
+
+        template <typename T>
+        struct identity
+        {
+            typedef T type;
+        };
+
+        // The operands that are not expressions; the types are not deduced,
+        // so that vec3 and friends convert to their base and literals to the
+        // element type.
+        template <typename V>
+        using operand = const typename identity<V>::type&;
+
+        template <typename V>
+        using element = typename traits<V>::value_type;
+    }
+
+    template <typename T, unsigned int N>
+    expr::terminal< vector<T, N> > lazy(const vector<T, N>& v)
+    {
+        return expr::terminal< vector<T, N> >(v);
+    }
+
+    template <typename T, unsigned int N>
+    expr::terminal< matrix<T, N> > lazy(const matrix<T, N>& m)
+    {
+        return expr::terminal< matrix<T, N> >(m);
+    }
+
+    // A column of a matrix, as a vector.
+    template <typename T, unsigned int N>
+    expr::terminal< vector<T, N> > lazy(const const_row<T, N>& c)
+    {
+        return expr::terminal< vector<T, N> >(c.c_array());
+    }
+
+    template <typename E, typename V>
+    V eval(const expr::expression<E, V>& e)
+    {
+        return e.evaluate();
+    }
+    template <typename E, typename V>
+    expr::unary<expr::negate, E> operator - (const expr::expression<E, V>& a)
+    {
+        return expr::unary<expr::negate, E>(a.self());
+    }
+
+    template <typename E1, typename E2, typename V>
+    expr::binary<expr::plus, E1, E2> operator + (const expr::expression<E1, V>& a, const expr::expression<E2, V>& b)
+    {
+        return expr::binary<expr::plus, E1, E2>(a.self(), b.self());
+    }
+
+    template <typename E, typename V>
+    expr::binary<expr::plus, E, expr::terminal<V>> operator + (const expr::expression<E, V>& a, expr::operand<V> b)
+    {
+        return expr::binary<expr::plus, E, expr::terminal<V>>(a.self(), expr::terminal<V>(b));
+    }
+
+    template <typename E, typename V>
+    expr::binary<expr::plus, expr::terminal<V>, E> operator + (expr::operand<V> a, const expr::expression<E, V>& b)
+    {
+        return expr::binary<expr::plus, expr::terminal<V>, E>(expr::terminal<V>(a), b.self());
+    }
+
+    template <typename E1, typename E2, typename V>
+    expr::binary<expr::minus, E1, E2> operator - (const expr::expression<E1, V>& a, const expr::expression<E2, V>& b)
+    {
+        return expr::binary<expr::minus, E1, E2>(a.self(), b.self());
+    }
+
+    template <typename E, typename V>
+    expr::binary<expr::minus, E, expr::terminal<V>> operator - (const expr::expression<E, V>& a, expr::operand<V> b)
+    {
+        return expr::binary<expr::minus, E, expr::terminal<V>>(a.self(), expr::terminal<V>(b));
+    }
+
+    template <typename E, typename V>
+    expr::binary<expr::minus, expr::terminal<V>, E> operator - (expr::operand<V> a, const expr::expression<E, V>& b)
+    {
+        return expr::binary<expr::minus, expr::terminal<V>, E>(expr::terminal<V>(a), b.self());
+    }
+
+    template <typename E, typename V>
+    expr::binary<expr::multiplies, E, expr::scalar<V>> operator * (const expr::expression<E, V>& a, expr::element<V> s)
+    {
+        return expr::binary<expr::multiplies, E, expr::scalar<V>>(a.self(), expr::scalar<V>(s));
+    }
+
+    template <typename E, typename V>
+    expr::binary<expr::multiplies, expr::scalar<V>, E> operator * (expr::element<V> s, const expr::expression<E, V>& a)
+    {
+        return expr::binary<expr::multiplies, expr::scalar<V>, E>(expr::scalar<V>(s), a.self());
+    }
+
+    template <typename E, typename V>
+    expr::binary<expr::divides, E, expr::scalar<V>> operator / (const expr::expression<E, V>& a, expr::element<V> s)
+    {
+        return expr::binary<expr::divides, E, expr::scalar<V>>(a.self(), expr::scalar<V>(s));
+    }
+
+    // Element wise products and quotients, for vectors only.
+    template <typename E1, typename E2, typename T, unsigned int N>
+    expr::binary<expr::multiplies, E1, E2> operator * (const expr::expression<E1, vector<T, N>>& a, const expr::expression<E2, vector<T, N>>& b)
+    {
+        return expr::binary<expr::multiplies, E1, E2>(a.self(), b.self());
+    }
+
+    template <typename E, typename T, unsigned int N>
+    expr::binary<expr::multiplies, E, expr::terminal<vector<T, N>>> operator * (const expr::expression<E, vector<T, N>>& a, expr::operand<vector<T, N>> b)
+    {
+        return expr::binary<expr::multiplies, E, expr::terminal<vector<T, N>>>(a.self(), expr::terminal<vector<T, N>>(b));
+    }
+
+    template <typename E, typename T, unsigned int N>
+    expr::binary<expr::multiplies, expr::terminal<vector<T, N>>, E> operator * (expr::operand<vector<T, N>> a, const expr::expression<E, vector<T, N>>& b)
+    {
+        return expr::binary<expr::multiplies, expr::terminal<vector<T, N>>, E>(expr::terminal<vector<T, N>>(a), b.self());
+    }
+
+    template <typename E1, typename E2, typename T, unsigned int N>
+    expr::binary<expr::divides, E1, E2> operator / (const expr::expression<E1, vector<T, N>>& a, const expr::expression<E2, vector<T, N>>& b)
+    {
+        return expr::binary<expr::divides, E1, E2>(a.self(), b.self());
+    }
+
+    template <typename E, typename T, unsigned int N>
+    expr::binary<expr::divides, E, expr::terminal<vector<T, N>>> operator / (const expr::expression<E, vector<T, N>>& a, expr::operand<vector<T, N>> b)
+    {
+        return expr::binary<expr::divides, E, expr::terminal<vector<T, N>>>(a.self(), expr::terminal<vector<T, N>>(b));
+    }
+
+    template <typename E, typename T, unsigned int N>
+    expr::binary<expr::divides, expr::terminal<vector<T, N>>, E> operator / (expr::operand<vector<T, N>> a, const expr::expression<E, vector<T, N>>& b)
+    {
+        return expr::binary<expr::divides, expr::terminal<vector<T, N>>, E>(expr::terminal<vector<T, N>>(a), b.self());
+    }
+
+    // Lazy mix, the same as mix() in vector.h without the temporaries.
+    template <typename E1, typename E2, typename T, unsigned int N>
+    expr::binary<expr::plus,
+                 expr::binary<expr::multiplies, E1, expr::scalar<vector<T, N>>>,
+                 expr::binary<expr::multiplies, E2, expr::scalar<vector<T, N>>>>
+    mix(const expr::expression<E1, vector<T, N>>& a, const expr::expression<E2, vector<T, N>>& b, T wb)
+    {
+        return a * (1 - wb) + b * wb;
+    }
+}
+
+#endif
@@ -28,26 +28,31 @@
 #include "vector.h"
 #include "matrix.h"
 #include "quaternion.h"
+#include "expression.h"
+#include "parallel.h"
+#include "stream.h"
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include <cmath>
+#include <cstddef>
+#include <limits>
 
 namespace rgm
 {
     template <typename T>
-    T radians(T degrees) 
+    constexpr T radians(T degrees) 
     {
         return degrees * ((T)M_PI / (T)180.0);
     };
 
     template <typename T>
-    T degrees(T radians) 
+    constexpr T degrees(T radians) 
     {
         return radians * ((T)180.0 / (T)M_PI);
     };
 
     template <typename T>
-    matrix4<T> frustum(T left, T right, T bottom, T top, T znear, T zfar)
+    constexpr matrix4<T> frustum(T left, T right, T bottom, T top, T znear, T zfar)
     {
         T temp1 = (T)2 * znear;
         T temp2 = right - left;
@@ -69,7 +74,7 @@ namespace rgm
     }
 
     template <typename T>
-    matrix4<T> ortho(T l, T r, T b, T t, T n, T f)
+    constexpr matrix4<T> ortho(T l, T r, T b, T t, T n, T f)
     {
         return matrix4<T>(   2.0/(r-l),       0.0,        0.0, -(r+l)/(r-l),
                                    0.0, 2.0/(t-b),        0.0, -(t+b)/(t-b),
@@ -87,7 +92,7 @@ namespace rgm
         vector<T, 3> up2     = cross(side, forward);
 
         matrix4<T>   r(    side[0],     side[1],     side[2], (T)0,
-                             up[0],       up[1],       up[2], (T)0,
+                            up2[0],      up2[1],      up2[2], (T)0,
                         forward[0],  forward[1],  forward[2], (T)0,
                               (T)0,        (T)0,        (T)0, (T)1);
         r = translate(r, -position);
@@ -96,14 +101,14 @@ namespace rgm
     }
 
     template <typename T>
-    matrix<T, 4> translate(const matrix<T, 4>& m, const vector<T, 3>& p)
+    constexpr matrix<T, 4> translate(const matrix<T, 4>& m, const vector<T, 3>& p)
     {
         matrix<T, 4> m2(m);
         
-        m2[3][0] = m[0][0] * p[0] + m[1][0] * p[1] + m[2][0] * p[2] + m[3][0];
-        m2[3][1] = m[0][1] * p[0] + m[1][1] * p[1] + m[2][1] * p[2] + m[3][1];
-        m2[3][2] = m[0][2] * p[0] + m[1][2] * p[1] + m[2][2] * p[2] + m[3][2];
-        m2[3][3] = m[0][3] * p[0] + m[1][3] * p[1] + m[2][3] * p[2] + m[3][3];
+        m2.at(3, 0) = m.at(0, 0) * p[0] + m.at(1, 0) * p[1] + m.at(2, 0) * p[2] + m.at(3, 0);
+        m2.at(3, 1) = m.at(0, 1) * p[0] + m.at(1, 1) * p[1] + m.at(2, 1) * p[2] + m.at(3, 1);
+        m2.at(3, 2) = m.at(0, 2) * p[0] + m.at(1, 2) * p[1] + m.at(2, 2) * p[2] + m.at(3, 2);
+        m2.at(3, 3) = m.at(0, 3) * p[0] + m.at(1, 3) * p[1] + m.at(2, 3) * p[2] + m.at(3, 3);
 
         return m2;
     }
@@ -133,16 +138,16 @@ namespace rgm
         d[2][2] = c + t[2] * axis[2];
         
         matrix<T, 4> r;
-        r[0] = m[0] * d[0][0] + m[1] * d[0][1] + m[2] * d[0][2];
-        r[1] = m[0] * d[1][0] + m[1] * d[1][1] + m[2] * d[1][2];
-        r[2] = m[0] * d[2][0] + m[1] * d[2][1] + m[2] * d[2][2];
+        r[0] = lazy(m.column(0)) * d[0][0] + lazy(m.column(1)) * d[0][1] + lazy(m.column(2)) * d[0][2];
+        r[1] = lazy(m.column(0)) * d[1][0] + lazy(m.column(1)) * d[1][1] + lazy(m.column(2)) * d[1][2];
+        r[2] = lazy(m.column(0)) * d[2][0] + lazy(m.column(1)) * d[2][1] + lazy(m.column(2)) * d[2][2];
         r[3] = m[3];
         
         return r;
     }
 
     template <typename T>
-    matrix<T, 4> rotate(const matrix<T, 4>& m, const quaterion<T>& q)
+    constexpr matrix<T, 4> rotate(const matrix<T, 4>& m, const quaterion<T>& q)
     {
 
         T x = q[0];
@@ -159,16 +164,27 @@ namespace rgm
         T zz = z * z;
         T zw = z * w;
 
-        matrix4<T> r((T)1.0 - (T)2.0*(yy + zz),          (T)2.0*(xy + zw),          (T)2.0*(xz - yw), (T)0.0,
-                              (T)2.0*(xy - zw), (T)1.0 - (T)2.0*(xx + zz),          (T)2.0*(yz + xw), (T)0.0,
-                              (T)2.0*(xz + yw),          (T)2.0*(yz - xw), (T)1.0 - (T)2.0*(xx + yy), (T)0.0,
-                                        (T)0.0,                    (T)0.0,                    (T)0.0, (T)1.0);
-        r = transpose(r); // FIXME rewrite the above
-        return m * r;
+        T d00 = (T)1 - (T)2 * (yy + zz);
+        T d01 = (T)2 * (xy + zw);
+        T d02 = (T)2 * (xz - yw);
+        T d10 = (T)2 * (xy - zw);
+        T d11 = (T)1 - (T)2 * (xx + zz);
+        T d12 = (T)2 * (yz + xw);
+        T d20 = (T)2 * (xz + yw);
+        T d21 = (T)2 * (yz - xw);
+        T d22 = (T)1 - (T)2 * (xx + yy);
+
+        // only the 3x3 block of the rotation is not identity
+        matrix<T, 4> r;
+        r[0] = m[0] * d00 + m[1] * d01 + m[2] * d02;
+        r[1] = m[0] * d10 + m[1] * d11 + m[2] * d12;
+        r[2] = m[0] * d20 + m[1] * d21 + m[2] * d22;
+        r[3] = m[3];
+        return r;
     }
 
     template <typename T>
-    matrix<T, 4> scale(const matrix<T, 4>& m, const vector<T, 3>& v)
+    constexpr matrix<T, 4> scale(const matrix<T, 4>& m, const vector<T, 3>& v)
     {
         matrix<T, 4> r;
         r[0] = m[0] * v[0];
@@ -178,13 +194,521 @@ namespace rgm
         return r;    
     }
 
+    // Translation, rotation and scale of a model matrix.
+    template <typename T>
+    struct trs
+    {
+        vector<T, 3> translation;
+        quaterion<T> rotation;
+        vector<T, 3> scale;
+    };
+
+    // Model matrix that scales by s, rotates by the unit quaternion q and
+    // then translates by t; the same as
+    // scale(rotate(translate(matrix<T, 4>(1), t), q), s), but the 12 values
+    // that are not constant are written directly.
+    template <typename T>
+    matrix<T, 4> compose_trs(const vector<T, 3>& t, const quaterion<T>& q, const vector<T, 3>& s)
+    {
+        T x  = q[0];
+        T y  = q[1];
+        T z  = q[2];
+        T w  = q[3];
+        T xx = x * x;
+        T xy = x * y;
+        T xz = x * z;
+        T xw = x * w;
+        T yy = y * y;
+        T yz = y * z;
+        T yw = y * w;
+        T zz = z * z;
+        T zw = z * w;
+
+        matrix<T, 4> r((simd::no_init()));
+        T* p = &r[0][0];
+        p[0]  = ((T)1 - (T)2 * (yy + zz)) * s[0];
+        p[1]  = (T)2 * (xy + zw) * s[0];
+        p[2]  = (T)2 * (xz - yw) * s[0];
+        p[3]  = 0;
+        p[4]  = (T)2 * (xy - zw) * s[1];
+        p[5]  = ((T)1 - (T)2 * (xx + zz)) * s[1];
+        p[6]  = (T)2 * (yz + xw) * s[1];
+        p[7]  = 0;
+        p[8]  = (T)2 * (xz + yw) * s[2];
+        p[9]  = (T)2 * (yz - xw) * s[2];
+        p[10] = ((T)1 - (T)2 * (xx + yy)) * s[2];
+        p[11] = 0;
+        p[12] = t[0];
+        p[13] = t[1];
+        p[14] = t[2];
+        p[15] = 1;
+        return r;
+    }
+
+    template <typename T>
+    matrix<T, 4> compose_trs(const trs<T>& v)
+    {
+        return compose_trs(v.translation, v.rotation, v.scale);
+    }
+
+    // Inverse of compose_trs for an affine matrix without shear and with
+    // non-zero scale. A mirroring matrix gets a negative x scale.
+    template <typename T>
+    trs<T> decompose_trs(const matrix<T, 4>& a)
+    {
+        const T* m = a.c_array();
+
+        T sx = std::sqrt(m[0] * m[0] + m[1] * m[1] + m[2]  * m[2]);
+        T sy = std::sqrt(m[4] * m[4] + m[5] * m[5] + m[6]  * m[6]);
+        T sz = std::sqrt(m[8] * m[8] + m[9] * m[9] + m[10] * m[10]);
+        T d  = m[0] * (m[5] * m[10] - m[6] * m[9]) + m[1] * (m[6] * m[8] - m[4] * m[10]) + m[2] * (m[4] * m[9] - m[5] * m[8]);
+        if (d < 0)
+        {
+            sx = -sx;
+        }
+
+        matrix<T, 4> u((simd::no_init()));
+        T* p = &u[0][0];
+        for (unsigned int i = 0; i < 3; i++)
+        {
+            p[i]     = m[i]     / sx;
+            p[i + 4] = m[i + 4] / sy;
+            p[i + 8] = m[i + 8] / sz;
+        }
+
+        trs<T> r;
+        r.translation = vector3<T>(m[12], m[13], m[14]);
+        r.rotation    = normalize(mat42quat(u));
+        r.scale       = vector3<T>(sx, sy, sz);
+        return r;
+    }
+
+    // Batch versions, e.g. for the local transforms of a scene kept as
+    // separate arrays.
+    template <typename T>
+    void compose_trs(const vector<T, 3>* t, const quaterion<T>* q, const vector<T, 3>* s, matrix<T, 4>* r, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            r[i] = compose_trs(t[i], q[i], s[i]);
+        }
+    }
+
+    template <typename T>
+    void decompose_trs(const matrix<T, 4>* m, vector<T, 3>* t, quaterion<T>* q, vector<T, 3>* s, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            trs<T> v = decompose_trs(m[i]);
+            t[i] = v.translation;
+            q[i] = v.rotation;
+            s[i] = v.scale;
+        }
+    }
+
+    // Inverse of an affine transform, i.e. a matrix with the last row
+    // (0, 0, 0, 1) as built by translate, rotate, scale and lookat. Only the
+    // 3x3 block is inverted and the translation is transformed back.
+    template <typename T>
+    matrix<T, 4> inverse_affine(const matrix<T, 4>& a)
+    {
+        const T* m = a.c_array();
+
+        T c0 = m[5] * m[10] - m[6] * m[9];
+        T c1 = m[6] * m[8]  - m[4] * m[10];
+        T c2 = m[4] * m[9]  - m[5] * m[8];
+        T id = 1 / (m[0] * c0 + m[1] * c1 + m[2] * c2);
+
+        matrix<T, 4> r((simd::no_init()));
+        T* p = &r[0][0];
+        p[0]  = c0 * id;
+        p[1]  = (m[2] * m[9]  - m[1] * m[10]) * id;
+        p[2]  = (m[1] * m[6]  - m[2] * m[5])  * id;
+        p[3]  = 0;
+        p[4]  = c1 * id;
+        p[5]  = (m[0] * m[10] - m[2] * m[8])  * id;
+        p[6]  = (m[2] * m[4]  - m[0] * m[6])  * id;
+        p[7]  = 0;
+        p[8]  = c2 * id;
+        p[9]  = (m[1] * m[8]  - m[0] * m[9])  * id;
+        p[10] = (m[0] * m[5]  - m[1] * m[4])  * id;
+        p[11] = 0;
+        p[12] = -(p[0] * m[12] + p[4] * m[13] + p[8]  * m[14]);
+        p[13] = -(p[1] * m[12] + p[5] * m[13] + p[9]  * m[14]);
+        p[14] = -(p[2] * m[12] + p[6] * m[13] + p[10] * m[14]);
+        p[15] = 1;
+        return r;
+    }
+
+    // Inverse of a rigid body transform, i.e. an affine transform with an
+    // orthonormal 3x3 block (rotation and translation only); the rotation
+    // is transposed.
+    template <typename T>
+    matrix<T, 4> inverse_rigid(const matrix<T, 4>& a)
+    {
+        const T* m = a.c_array();
+
+        matrix<T, 4> r((simd::no_init()));
+        T* p = &r[0][0];
+        p[0]  = m[0];
+        p[1]  = m[4];
+        p[2]  = m[8];
+        p[3]  = 0;
+        p[4]  = m[1];
+        p[5]  = m[5];
+        p[6]  = m[9];
+        p[7]  = 0;
+        p[8]  = m[2];
+        p[9]  = m[6];
+        p[10] = m[10];
+        p[11] = 0;
+        p[12] = -(m[0] * m[12] + m[1] * m[13] + m[2]  * m[14]);
+        p[13] = -(m[4] * m[12] + m[5] * m[13] + m[6]  * m[14]);
+        p[14] = -(m[8] * m[12] + m[9] * m[13] + m[10] * m[14]);
+        p[15] = 1;
+        return r;
+    }
+
+    // Batch versions; r may be the same array as m.
+    template <typename T>
+    void inverse_affine(const matrix<T, 4>* m, matrix<T, 4>* r, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            r[i] = inverse_affine(m[i]);
+        }
+    }
+
+    template <typename T>
+    void inverse_rigid(const matrix<T, 4>* m, matrix<T, 4>* r, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            r[i] = inverse_rigid(m[i]);
+        }
+    }
+
+    namespace simd
+    {
+        // Writes the normal matrix of the 4x4 matrix m to the 3x3 matrix r.
+        // The functions below use this directly instead of returning a
+        // matrix, which the compiler copies through the stack.
+        template <typename T>
+        void normal_matrix(const T* m, T* r)
+        {
+            T c0 = m[5] * m[10] - m[6] * m[9];
+            T c1 = m[6] * m[8]  - m[4] * m[10];
+            T c2 = m[4] * m[9]  - m[5] * m[8];
+            T id = 1 / (m[0] * c0 + m[1] * c1 + m[2] * c2);
+
+            r[0] = c0 * id;
+            r[1] = c1 * id;
+            r[2] = c2 * id;
+            r[3] = (m[9] * m[2] - m[10] * m[1]) * id;
+            r[4] = (m[10] * m[0] - m[8] * m[2]) * id;
+            r[5] = (m[8] * m[1] - m[9] * m[0])  * id;
+            r[6] = (m[1] * m[6] - m[2] * m[5])  * id;
+            r[7] = (m[2] * m[4] - m[0] * m[6])  * id;
+            r[8] = (m[0] * m[5] - m[1] * m[4])  * id;
+        }
+
+#ifdef RGM_SSE2
+        // The cross products are done on whole columns as
+        // a x b = (a * b.yzx - a.yzx * b).yzx. The columns are stored
+        // overlapping, each overwrites the w of the last one.
+        inline void normal_matrix(const float* m, float* r)
+        {
+            float4 a  = _mm_loadu_ps(m);
+            float4 b  = _mm_loadu_ps(m + 4);
+            float4 c  = _mm_loadu_ps(m + 8);
+            float4 a1 = swizzle<1, 2, 0, 3>(a);
+            float4 b1 = swizzle<1, 2, 0, 3>(b);
+            float4 c1 = swizzle<1, 2, 0, 3>(c);
+
+            float4 bc = swizzle<1, 2, 0, 3>(sub(mul(b, c1), mul(b1, c)));
+            float4 ca = swizzle<1, 2, 0, 3>(sub(mul(c, a1), mul(c1, a)));
+            float4 ab = swizzle<1, 2, 0, 3>(sub(mul(a, b1), mul(a1, b)));
+            float4 id = _mm_set1_ps(1.0f / sum(mul(a, bc), 3));
+
+            _mm_storeu_ps(r, mul(bc, id));
+            _mm_storeu_ps(r + 3, mul(ca, id));
+            packed<float, 3>::store(r + 6, mul(ab, id));
+        }
+#endif
+    }
+
+    // Matrix that transforms the normals of a model with the model matrix
+    // m: the inverse transpose of its 3x3 block. For columns a, b and c
+    // that is (b x c, c x a, a x b) / det, the cofactor matrix, so no
+    // general inverse is needed. Not usable if the block is singular.
+    template <typename T>
+    matrix<T, 3> normal_matrix(const matrix<T, 4>& m)
+    {
+        matrix<T, 3> r((simd::no_init()));
+        simd::normal_matrix(m.c_array(), &r[0][0]);
+        return r;
+    }
+
+    // Normal matrix of a transform with a uniform scale s, i.e. s times a
+    // rotation: the 3x3 block divided by s^2.
+    template <typename T>
+    matrix<T, 3> normal_matrix_uniform(const matrix<T, 4>& a)
+    {
+        const T* m = a.c_array();
+
+        T is = 1 / (m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+
+        matrix<T, 3> r((simd::no_init()));
+        T* p = &r[0][0];
+        p[0] = m[0] * is;
+        p[1] = m[1] * is;
+        p[2] = m[2] * is;
+        p[3] = m[4] * is;
+        p[4] = m[5] * is;
+        p[5] = m[6] * is;
+        p[6] = m[8] * is;
+        p[7] = m[9] * is;
+        p[8] = m[10] * is;
+        return r;
+    }
+
+    // Normal matrix of a rigid body transform: the rotation itself.
     template <typename T>
-    vector<T, 3> transform(const matrix<T, 4>& m, const vector<T, 3>& v)
+    matrix<T, 3> normal_matrix_rigid(const matrix<T, 4>& a)
+    {
+        return matrix3<T>(a);
+    }
+
+    // Batch version; e.g. once per frame for all objects of a scene.
+    template <typename T>
+    void normal_matrix(const matrix<T, 4>* m, matrix<T, 3>* r, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            simd::normal_matrix(m[i].c_array(), &r[i][0][0]);
+        }
+    }
+
+    namespace simd
+    {
+        // transform_normals() on the elements [begin, end) of the padded
+        // lanes; begin is a multiple of the batch size.
+        template <typename T>
+        void transform_normals(const matrix<T, 3>& n, const vector_stream<T, 3>& v, vector_stream<T, 3>& r, size_t begin, size_t end)
+        {
+            typedef batch<T> B;
+            typedef typename B::type P;
+
+            const T* px = v.lane(0);
+            const T* py = v.lane(1);
+            const T* pz = v.lane(2);
+            T*       rx = r.lane(0);
+            T*       ry = r.lane(1);
+            T*       rz = r.lane(2);
+
+            const T* m = n.c_array();
+            P m0 = B::splat(m[0]);
+            P m1 = B::splat(m[1]);
+            P m2 = B::splat(m[2]);
+            P m3 = B::splat(m[3]);
+            P m4 = B::splat(m[4]);
+            P m5 = B::splat(m[5]);
+            P m6 = B::splat(m[6]);
+            P m7 = B::splat(m[7]);
+            P m8 = B::splat(m[8]);
+            P one  = B::splat(1);
+            P tiny = B::splat(std::numeric_limits<T>::min());
+            for (size_t i = begin; i < end; i += B::size)
+            {
+                P x = B::load(px + i);
+                P y = B::load(py + i);
+                P z = B::load(pz + i);
+                P tx = madd(m6, z, madd(m3, y, mul(m0, x)));
+                P ty = madd(m7, z, madd(m4, y, mul(m1, x)));
+                P tz = madd(m8, z, madd(m5, y, mul(m2, x)));
+                P s  = madd(tz, tz, madd(ty, ty, mul(tx, tx)));
+                P l  = div(one, sqrt(max(s, tiny)));
+                B::store(rx + i, mul(tx, l));
+                B::store(ry + i, mul(ty, l));
+                B::store(rz + i, mul(tz, l));
+            }
+        }
+    }
+
+    // Transforms a stream of normals with the normal matrix n and
+    // renormalizes them in the same pass, i.e. element i is
+    // normalize(n * v[i]). Since the result is renormalized, the scale of
+    // n does not matter: for a uniformly scaled model the 3x3 block of the
+    // model matrix can be used directly. Zero normals stay zero. r may be
+    // the same stream as v.
+    template <typename T>
+    void transform_normals(const matrix<T, 3>& n, const vector_stream<T, 3>& v, vector_stream<T, 3>& r)
+    {
+        r.resize(v.size());
+        simd::transform_normals(n, v, r, 0, v.padded_size());
+    }
+
+    template <typename T>
+    constexpr vector<T, 3> transform(const matrix<T, 4>& m, const vector<T, 3>& v)
     {
         return vector3<T>(m * vector4<T>(v, 0.0f));
     }
 
 
+    // Transforms count vectors of 3 elements as m * (x, y, z, w), without
+    // division by the result's w. The vectors are read from in and written
+    // to out with a stride in bytes, so they can be members of interleaved
+    // vertex data; in and out may be the same buffer.
+    template <typename T>
+    void transform_stride(const matrix<T, 4>& m, T w, const T* in, size_t in_stride, T* out, size_t out_stride, size_t count)
+    {
+        const T* a = m.c_array();
+        const unsigned char* src = reinterpret_cast<const unsigned char*>(in);
+        unsigned char*       dst = reinterpret_cast<unsigned char*>(out);
+        for (size_t i = 0; i < count; i++)
+        {
+            const T* p = reinterpret_cast<const T*>(src + i * in_stride);
+            T*       r = reinterpret_cast<T*>(dst + i * out_stride);
+            T x = p[0];
+            T y = p[1];
+            T z = p[2];
+            r[0] = a[0] * x + a[4] * y + a[8]  * z + a[12] * w;
+            r[1] = a[1] * x + a[5] * y + a[9]  * z + a[13] * w;
+            r[2] = a[2] * x + a[6] * y + a[10] * z + a[14] * w;
+        }
+    }
+
+#ifdef RGM_SSE2
+    namespace simd
+    {
+        // The columns stay in registers and each vector is one broadcast
+        // multiply add per element.
+        template <typename T>
+        void transform_stride(const matrix<T, 4>& m, T w, const T* in, size_t in_stride, T* out, size_t out_stride, size_t count)
+        {
+            typedef packed<T, 4> S4;
+            typedef packed<T, 3> S3;
+            typedef typename S4::type P;
+
+            const T* a = m.c_array();
+            P c0 = S4::load(a);
+            P c1 = S4::load(a + 4);
+            P c2 = S4::load(a + 8);
+            P c3 = mul(S4::load(a + 12), S4::splat(w));
+
+            const unsigned char* src = reinterpret_cast<const unsigned char*>(in);
+            unsigned char*       dst = reinterpret_cast<unsigned char*>(out);
+            for (size_t i = 0; i < count; i++)
+            {
+                const T* p = reinterpret_cast<const T*>(src + i * in_stride);
+                P r = madd(c0, S4::splat(p[0]), madd(c1, S4::splat(p[1]), madd(c2, S4::splat(p[2]), c3)));
+                S3::store(reinterpret_cast<T*>(dst + i * out_stride), r);
+            }
+        }
+    }
+
+    // The products are summed in a different order than above and are
+    // fused with FMA, so the results can differ in the last bits.
+    inline void transform_stride(const matrix<float, 4>& m, float w, const float* in, size_t in_stride, float* out, size_t out_stride, size_t count)
+    {
+        simd::transform_stride(m, w, in, in_stride, out, out_stride, count);
+    }
+
+    inline void transform_stride(const matrix<double, 4>& m, double w, const double* in, size_t in_stride, double* out, size_t out_stride, size_t count)
+    {
+        simd::transform_stride(m, w, in, in_stride, out, out_stride, count);
+    }
+#endif
+
+    // Batch transform of points (w = 1) and directions (w = 0).
+    template <typename T>
+    void transform_points(const matrix<T, 4>& m, const vector<T, 3>* in, vector<T, 3>* out, size_t count)
+    {
+        if (count != 0)
+        {
+            transform_stride(m, (T)1, in[0].c_array(), sizeof(vector<T, 3>), &out[0][0], sizeof(vector<T, 3>), count);
+        }
+    }
+
+    template <typename T>
+    void transform_directions(const matrix<T, 4>& m, const vector<T, 3>* in, vector<T, 3>* out, size_t count)
+    {
+        if (count != 0)
+        {
+            transform_stride(m, (T)0, in[0].c_array(), sizeof(vector<T, 3>), &out[0][0], sizeof(vector<T, 3>), count);
+        }
+    }
+
+    template <typename T>
+    void transform_points(const matrix<T, 4>& m, const T* in, size_t in_stride, T* out, size_t out_stride, size_t count)
+    {
+        transform_stride(m, (T)1, in, in_stride, out, out_stride, count);
+    }
+
+    template <typename T>
+    void transform_directions(const matrix<T, 4>& m, const T* in, size_t in_stride, T* out, size_t out_stride, size_t count)
+    {
+        transform_stride(m, (T)0, in, in_stride, out, out_stride, count);
+    }
+
+    // The same, with large batches split over the threads of a pool.
+    const size_t TRANSFORM_GRAIN = 4096;
+
+    template <typename T>
+    void transform_points(thread_pool& pool, const matrix<T, 4>& m, const T* in, size_t in_stride, T* out, size_t out_stride, size_t count)
+    {
+        const unsigned char* src = reinterpret_cast<const unsigned char*>(in);
+        unsigned char*       dst = reinterpret_cast<unsigned char*>(out);
+        parallel_for(pool, 0, count, TRANSFORM_GRAIN, [&] (size_t b, size_t e) {
+            transform_stride(m, (T)1, reinterpret_cast<const T*>(src + b * in_stride), in_stride, reinterpret_cast<T*>(dst + b * out_stride), out_stride, e - b);
+        });
+    }
+
+    template <typename T>
+    void transform_directions(thread_pool& pool, const matrix<T, 4>& m, const T* in, size_t in_stride, T* out, size_t out_stride, size_t count)
+    {
+        const unsigned char* src = reinterpret_cast<const unsigned char*>(in);
+        unsigned char*       dst = reinterpret_cast<unsigned char*>(out);
+        parallel_for(pool, 0, count, TRANSFORM_GRAIN, [&] (size_t b, size_t e) {
+            transform_stride(m, (T)0, reinterpret_cast<const T*>(src + b * in_stride), in_stride, reinterpret_cast<T*>(dst + b * out_stride), out_stride, e - b);
+        });
+    }
+
+    template <typename T>
+    void transform_points(thread_pool& pool, const matrix<T, 4>& m, const vector<T, 3>* in, vector<T, 3>* out, size_t count)
+    {
+        if (count != 0)
+        {
+            transform_points(pool, m, in[0].c_array(), sizeof(vector<T, 3>), &out[0][0], sizeof(vector<T, 3>), count);
+        }
+    }
+
+    template <typename T>
+    void transform_directions(thread_pool& pool, const matrix<T, 4>& m, const vector<T, 3>* in, vector<T, 3>* out, size_t count)
+    {
+        if (count != 0)
+        {
+            transform_directions(pool, m, in[0].c_array(), sizeof(vector<T, 3>), &out[0][0], sizeof(vector<T, 3>), count);
+        }
+    }
+
+    template <typename T>
+    void normal_matrix(thread_pool& pool, const matrix<T, 4>* m, matrix<T, 3>* r, size_t count)
+    {
+        parallel_for(pool, 0, count, TRANSFORM_GRAIN, [&] (size_t b, size_t e) {
+            normal_matrix(m + b, r + b, e - b);
+        });
+    }
+
+    template <typename T>
+    void transform_normals(thread_pool& pool, const matrix<T, 3>& n, const vector_stream<T, 3>& v, vector_stream<T, 3>& r)
+    {
+        r.resize(v.size());
+        parallel_for(pool, 0, v.padded_size(), TRANSFORM_GRAIN, [&] (size_t b, size_t e) {
+            simd::transform_normals(n, v, r, b, e);
+        });
+    }
+
     template <typename T>
     vector<T, 3> transform(const quaterion<T>& q, const vector<T, 3>& v)
     {
@@ -237,7 +761,7 @@ namespace rgm
         T vz = (2 * window[2]) - 1;
 
         vector<T, 4> v = temp * vector4<T>(vx, vy, vz, 1);
-        //v = 
+        v = v / v[3];
 
         return vector3<T>(v);
     }
@@ -0,0 +1,227 @@
+/*
+    rgm - Rioki's Graphic Math Library
+
+    Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+#ifndef _RGM_HIERARCHY_H_
+#define _RGM_HIERARCHY_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#include "vector.h"
+#include "matrix.h"
+#include "quaternion.h"
+#include "gl.h"
+#include "memory.h"
+#include "parallel.h"
+
+namespace rgm
+{
+    // Parent/child transformations, each node with a local translation,
+    // rotation and scale. The world matrix of a node is
+    // world(parent) * translate * rotate * scale. Nodes are added after
+    // their parent, so the arrays are sorted topologically, and changing
+    // a node marks it dirty; update() then recomputes only the dirty nodes
+    // and their descendants.
+    template <typename T>
+    class transform_hierarchy
+    {
+    public:
+        static const unsigned int NONE = ~0u;
+
+        size_t size() const
+        {
+            return parents.size();
+        }
+
+        // Adds a node below parent, or a root for NONE, and returns its
+        // index. The new node is dirty.
+        unsigned int add(unsigned int parent, const vector<T, 3>& translation, const quaterion<T>& rotation, const vector<T, 3>& scale)
+        {
+            assert(parent == NONE || parent < size());
+            unsigned int i = static_cast<unsigned int>(size());
+            parents.push_back(parent);
+            depths.push_back(parent == NONE ? 0 : depths[parent] + 1);
+            translations.push_back(translation);
+            rotations.push_back(rotation);
+            scales.push_back(scale);
+            worlds.push_back(matrix<T, 4>(1));
+            dirty.push_back(1);
+            levels.clear();
+            return i;
+        }
+
+        unsigned int parent(unsigned int i) const
+        {
+            return parents[i];
+        }
+
+        const vector<T, 3>& translation(unsigned int i) const
+        {
+            return translations[i];
+        }
+
+        const quaterion<T>& rotation(unsigned int i) const
+        {
+            return rotations[i];
+        }
+
+        const vector<T, 3>& scale(unsigned int i) const
+        {
+            return scales[i];
+        }
+
+        void set_translation(unsigned int i, const vector<T, 3>& v)
+        {
+            translations[i] = v;
+            dirty[i] = 1;
+        }
+
+        void set_rotation(unsigned int i, const quaterion<T>& q)
+        {
+            rotations[i] = q;
+            dirty[i] = 1;
+        }
+
+        void set_scale(unsigned int i, const vector<T, 3>& v)
+        {
+            scales[i] = v;
+            dirty[i] = 1;
+        }
+
+        // The world matrix as of the last update().
+        const matrix<T, 4>& world(unsigned int i) const
+        {
+            return worlds[i];
+        }
+
+        // Recomputes the world matrices of the dirty nodes and their
+        // descendants, in one pass over the nodes in order, and returns
+        // how many were recomputed.
+        size_t update()
+        {
+            size_t n = 0;
+            for (size_t i = 0; i < size(); i++)
+            {
+                n += update_node(i);
+            }
+            std::fill(dirty.begin(), dirty.end(), 0);
+            return n;
+        }
+
+        // The same, one depth level after the other, with the nodes of a
+        // level spread over the pool. The nodes of a level only depend on
+        // the level above, so the result is the same as for update().
+        size_t update(thread_pool& pool)
+        {
+            if (levels.empty())
+            {
+                sort_levels();
+            }
+
+            std::atomic<size_t> n{0};
+            for (size_t l = 0; l + 1 < level_starts.size(); l++)
+            {
+                const unsigned int* level = levels.data() + level_starts[l];
+                parallel_for(pool, 0, level_starts[l + 1] - level_starts[l], UPDATE_GRAIN, [&] (size_t b, size_t e) {
+                    size_t c = 0;
+                    for (size_t k = b; k < e; k++)
+                    {
+                        c += update_node(level[k]);
+                    }
+                    n += c;
+                });
+            }
+            std::fill(dirty.begin(), dirty.end(), 0);
+            return n;
+        }
+
+    private:
+        static const size_t UPDATE_GRAIN = 2048;
+
+        // cache line aligned, so that reading the world matrix of a parent
+        // touches as few lines as possible
+        typedef std::vector<aligned_matrix4<T>, aligned_allocator<aligned_matrix4<T>>> matrix_array;
+
+        std::vector<unsigned int>  parents;
+        std::vector<unsigned int>  depths;
+        std::vector<vector<T, 3>>  translations;
+        std::vector<quaterion<T>>  rotations;
+        std::vector<vector<T, 3>>  scales;
+        matrix_array               worlds;
+        std::vector<unsigned char> dirty;
+        // node indices by depth, level l is [level_starts[l], level_starts[l + 1])
+        std::vector<unsigned int>  levels;
+        std::vector<size_t>        level_starts;
+
+        // The parent is already done and keeps its flag until the end of
+        // the update, so the flag tells if the parent changed.
+        size_t update_node(size_t i)
+        {
+            unsigned int p = parents[i];
+            if (p != NONE && dirty[p] != 0)
+            {
+                dirty[i] = 1;
+            }
+            if (dirty[i] == 0)
+            {
+                return 0;
+            }
+
+            matrix<T, 4> local = compose_trs(translations[i], rotations[i], scales[i]);
+            worlds[i] = p != NONE ? worlds[p] * local : local;
+            return 1;
+        }
+
+        void sort_levels()
+        {
+            level_starts.assign(1, 0);
+            for (size_t i = 0; i < size(); i++)
+            {
+                if (depths[i] + 2 > level_starts.size())
+                {
+                    level_starts.resize(depths[i] + 2, 0);
+                }
+                level_starts[depths[i] + 1]++;
+            }
+            for (size_t l = 1; l < level_starts.size(); l++)
+            {
+                level_starts[l] += level_starts[l - 1];
+            }
+            std::vector<size_t> next(level_starts.begin(), level_starts.end() - 1);
+            levels.resize(size());
+            for (size_t i = 0; i < size(); i++)
+            {
+                levels[next[depths[i]]++] = static_cast<unsigned int>(i);
+            }
+        }
+    };
+
+    template <typename T> const unsigned int transform_hierarchy<T>::NONE;
+    template <typename T> const size_t       transform_hierarchy<T>::UPDATE_GRAIN;
+}
+
+#endif
@@ -0,0 +1,533 @@
+/*
+    rgm - Rioki's Graphic Math Library
+
+    Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+#ifndef _RGM_INTERSECT_H_
+#define _RGM_INTERSECT_H_
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "simd.h"
+#include "vector.h"
+#include "stream.h"
+#include "ray.h"
+
+namespace rgm
+{
+    // Returned by the closest hit functions if nothing is hit, the same as
+    // bvh<T>::NONE.
+    const size_t NO_HIT = ~static_cast<size_t>(0);
+
+    namespace simd
+    {
+        // batch<T> for one element, so that the scalar functions share the
+        // kernels and give the same results as the batch functions.
+        template <typename T>
+        struct single
+        {
+            typedef T type;
+            static const unsigned int size = 1;
+            static type splat(T v) { return v; }
+        };
+
+        // The kernels work on batches of rays against batches of primitives,
+        // with the vectors split into registers of x, y and z. Either side
+        // can be the same value in every lane, which gives one ray against
+        // batch size primitives or batch size rays against one primitive.
+        // Each kernel returns the distance of the hit or tmax for the lanes
+        // that miss, and sets h to a register with the sign bit set in the
+        // lanes that hit. The tests are differences that are negative for
+        // hits, as for the clip flags, so that signmask() and select() read
+        // them without comparisons.
+
+        template <typename B>
+        inline typename B::type dot3(const typename B::type* a, const typename B::type* b)
+        {
+            return madd(a[0], b[0], madd(a[1], b[1], mul(a[2], b[2])));
+        }
+
+        template <typename B>
+        inline void cross3(const typename B::type* a, const typename B::type* b, typename B::type* r)
+        {
+            r[0] = sub(mul(a[1], b[2]), mul(a[2], b[1]));
+            r[1] = sub(mul(a[2], b[0]), mul(a[0], b[2]));
+            r[2] = sub(mul(a[0], b[1]), mul(a[1], b[0]));
+        }
+
+        // One slab of the box test. A NaN from a ray that lies in one of the
+        // planes and is parallel to them is ignored by min and max.
+        template <typename B>
+        inline void slab(typename B::type o, typename B::type inv, typename B::type lower, typename B::type upper,
+                         typename B::type& t0, typename B::type& t1)
+        {
+            typename B::type a = mul(sub(lower, o), inv);
+            typename B::type b = mul(sub(upper, o), inv);
+            t0 = max(t0, min(a, b));
+            t1 = min(t1, max(a, b));
+        }
+
+        // Entry distance into axis aligned boxes, if they are entered in
+        // [0, tmax]; the rays are given by their origin and the inverse of
+        // their direction. Rays that start inside enter at 0.
+        template <typename B>
+        inline typename B::type box_hit(const typename B::type* o, const typename B::type* inv,
+                                        const typename B::type* lower, const typename B::type* upper,
+                                        typename B::type tmax, typename B::type& h)
+        {
+            typedef typename B::type P;
+
+            P t0 = B::splat(0);
+            P t1 = tmax;
+            slab<B>(o[0], inv[0], lower[0], upper[0], t0, t1);
+            slab<B>(o[1], inv[1], lower[1], upper[1], t0, t1);
+            slab<B>(o[2], inv[2], lower[2], upper[2], t0, t1);
+            // t0 <= t1 hits, so that flat boxes are hit too
+            h = neg(sub(t1, t0));
+            return select(h, t0, tmax);
+        }
+
+        // Möller-Trumbore test against triangles (a, b, c), from both sides.
+        // The hit point is a + u (b - a) + v (c - a). The tests are done on
+        // u, v and t scaled by the determinant, so that there is one division
+        // and only for the results; u and v are unspecified for the lanes
+        // that miss. Triangles whose determinant is not a normal number,
+        // that are seen edge on or degenerate, are missed.
+        template <typename T, typename B>
+        inline typename B::type triangle_hit(const typename B::type* o, const typename B::type* d,
+                                             const typename B::type* a, const typename B::type* b, const typename B::type* c,
+                                             typename B::type tmax, typename B::type& u, typename B::type& v, typename B::type& h)
+        {
+            typedef typename B::type P;
+
+            P e1[3] = {sub(b[0], a[0]), sub(b[1], a[1]), sub(b[2], a[2])};
+            P e2[3] = {sub(c[0], a[0]), sub(c[1], a[1]), sub(c[2], a[2])};
+            P s[3]  = {sub(o[0], a[0]), sub(o[1], a[1]), sub(o[2], a[2])};
+            P p[3];
+            P q[3];
+            cross3<B>(d, e2, p);
+            cross3<B>(s, e1, q);
+
+            P det = dot3<B>(e1, p);
+            P du  = flipsign(dot3<B>(s, p), det);
+            P dv  = flipsign(dot3<B>(d, q), det);
+            P dt  = flipsign(dot3<B>(e2, q), det);
+            det   = abs(det);
+
+            // 0 <= u, 0 <= v, u + v <= 1, 0 <= t < tmax and a usable det
+            h = max(max(neg(du), neg(dv)), max(sub(add(du, dv), det), neg(dt)));
+            h = max(h, max(sub(dt, mul(tmax, det)), sub(B::splat(std::numeric_limits<T>::min()), det)));
+
+            P r = div(B::splat(1), det);
+            u = mul(du, r);
+            v = mul(dv, r);
+            return select(h, mul(dt, r), tmax);
+        }
+
+        // Distance to spheres, where the ray enters them or, if it starts
+        // inside, leaves them.
+        template <typename B>
+        inline typename B::type sphere_hit(const typename B::type* o, const typename B::type* d,
+                                           const typename B::type* center, typename B::type radius,
+                                           typename B::type tmax, typename B::type& h)
+        {
+            typedef typename B::type P;
+
+            P oc[3] = {sub(o[0], center[0]), sub(o[1], center[1]), sub(o[2], center[2])};
+            P a     = dot3<B>(d, d);
+            P b     = dot3<B>(oc, d);
+            P c     = sub(dot3<B>(oc, oc), mul(radius, radius));
+            P disc  = sub(mul(b, b), mul(a, c));
+            P sq    = sqrt(max(disc, B::splat(0)));
+            P r     = div(B::splat(1), a);
+            P t0    = mul(sub(neg(b), sq), r);
+            P t1    = mul(sub(sq, b), r);
+            P t     = select(t0, t1, t0);
+
+            h = max(max(neg(disc), neg(t)), sub(t, tmax));
+            return select(h, t, tmax);
+        }
+
+        // Bits of the lanes of the batch at i that hit; the lanes past
+        // count are padding and always cleared.
+        template <typename T>
+        inline unsigned int hit_bits(typename batch<T>::type h, size_t i, size_t count)
+        {
+            unsigned int bits = signmask(h);
+            if (i + batch<T>::size > count)
+            {
+                bits &= (1u << (count - i)) - 1;
+            }
+            return bits;
+        }
+
+        template <typename T>
+        inline void splat3(const vector<T, 3>& v, typename batch<T>::type* r)
+        {
+            r[0] = batch<T>::splat(v[0]);
+            r[1] = batch<T>::splat(v[1]);
+            r[2] = batch<T>::splat(v[2]);
+        }
+
+        template <typename T>
+        inline void load3(const vector_stream<T, 3>& s, size_t i, typename batch<T>::type* r)
+        {
+            r[0] = batch<T>::load(s.lane(0) + i);
+            r[1] = batch<T>::load(s.lane(1) + i);
+            r[2] = batch<T>::load(s.lane(2) + i);
+        }
+
+        template <typename T>
+        inline void inverse3(const vector<T, 3>& v, typename batch<T>::type* r)
+        {
+            r[0] = batch<T>::splat((T)1 / v[0]);
+            r[1] = batch<T>::splat((T)1 / v[1]);
+            r[2] = batch<T>::splat((T)1 / v[2]);
+        }
+    }
+
+    // Entry distance of r into the box [lower, upper] if it is entered in
+    // [0, tmax], otherwise tmax; rays that start inside enter at 0. This is
+    // the test bvh::raycast expects, so it can be passed to it as is. The
+    // distances are in units of the direction; tmax needs to be finite.
+    template <typename T>
+    T intersect_box(const ray<T>& r, const vector<T, 3>& lower, const vector<T, 3>& upper, T tmax)
+    {
+        T inv[3] = {(T)1 / r.direction[0], (T)1 / r.direction[1], (T)1 / r.direction[2]};
+        T h;
+        return simd::box_hit<simd::single<T>>(r.origin.c_array(), inv, lower.c_array(), upper.c_array(), tmax, h);
+    }
+
+    // Distance to the triangle (a, b, c), seen from either side, if it is
+    // hit in [0, tmax), otherwise tmax. On a hit, u and v are set to the
+    // barycentrics of the hit point a + u (b - a) + v (c - a).
+    template <typename T>
+    T intersect_triangle(const ray<T>& r, const vector<T, 3>& a, const vector<T, 3>& b, const vector<T, 3>& c, T tmax, T& u, T& v)
+    {
+        T hu, hv, h;
+        T t = simd::triangle_hit<T, simd::single<T>>(r.origin.c_array(), r.direction.c_array(), a.c_array(), b.c_array(), c.c_array(), tmax, hu, hv, h);
+        if (std::signbit(h))
+        {
+            u = hu;
+            v = hv;
+        }
+        return t;
+    }
+
+    template <typename T>
+    T intersect_triangle(const ray<T>& r, const vector<T, 3>& a, const vector<T, 3>& b, const vector<T, 3>& c, T tmax)
+    {
+        T u, v;
+        return intersect_triangle(r, a, b, c, tmax, u, v);
+    }
+
+    // Distance to the sphere if it is hit in [0, tmax), otherwise tmax. A
+    // ray that starts inside hits it where it leaves.
+    template <typename T>
+    T intersect_sphere(const ray<T>& r, const vector<T, 3>& center, T radius, T tmax)
+    {
+        T h;
+        return simd::sphere_hit<simd::single<T>>(r.origin.c_array(), r.direction.c_array(), center.c_array(), radius, tmax, h);
+    }
+
+    // One ray against streams of primitives, a batch of primitives at a
+    // time. The results are written per primitive: the distance, or tmax
+    // for misses, to t or to the first lane of hits, and bit i % 32 of
+    // mask[i / 32] is set if primitive i is hit. They are the same as those
+    // of the functions above, up to rounding where FMA is used.
+
+    // Boxes given by their lower and upper corners.
+    template <typename T>
+    void intersect_boxes(const ray<T>& r, const vector_stream<T, 3>& lower, const vector_stream<T, 3>& upper, T tmax,
+                         vector_stream<T, 1>& t, std::vector<unsigned int>& mask)
+    {
+        typedef simd::batch<T> B;
+        typedef typename B::type P;
+        assert(lower.size() == upper.size());
+
+        size_t count = lower.size();
+        t.resize(count);
+        mask.assign((count + 31) / 32, 0);
+
+        P o[3], inv[3];
+        simd::splat3(r.origin, o);
+        simd::inverse3(r.direction, inv);
+        P pmax = B::splat(tmax);
+        for (size_t i = 0; i < count; i += B::size)
+        {
+            P l[3], u[3], h;
+            simd::load3(lower, i, l);
+            simd::load3(upper, i, u);
+            B::store(t.lane(0) + i, simd::box_hit<B>(o, inv, l, u, pmax, h));
+            // batches never straddle a word, the size is a power of 2
+            mask[i / 32] |= simd::hit_bits<T>(h, i, count) << (i % 32);
+        }
+    }
+
+    // Triangles given by their corners a, b and c. The lanes of hits are
+    // the distance t and the barycentrics u and v, which are unspecified
+    // for the triangles that are missed.
+    template <typename T>
+    void intersect_triangles(const ray<T>& r, const vector_stream<T, 3>& a, const vector_stream<T, 3>& b, const vector_stream<T, 3>& c, T tmax,
+                             vector_stream<T, 3>& hits, std::vector<unsigned int>& mask)
+    {
+        typedef simd::batch<T> B;
+        typedef typename B::type P;
+        assert(a.size() == b.size() && a.size() == c.size());
+
+        size_t count = a.size();
+        hits.resize(count);
+        mask.assign((count + 31) / 32, 0);
+
+        P o[3], d[3];
+        simd::splat3(r.origin, o);
+        simd::splat3(r.direction, d);
+        P pmax = B::splat(tmax);
+        for (size_t i = 0; i < count; i += B::size)
+        {
+            P pa[3], pb[3], pc[3], u, v, h;
+            simd::load3(a, i, pa);
+            simd::load3(b, i, pb);
+            simd::load3(c, i, pc);
+            B::store(hits.lane(0) + i, simd::triangle_hit<T, B>(o, d, pa, pb, pc, pmax, u, v, h));
+            B::store(hits.lane(1) + i, u);
+            B::store(hits.lane(2) + i, v);
+            mask[i / 32] |= simd::hit_bits<T>(h, i, count) << (i % 32);
+        }
+    }
+
+    // Spheres given as (x, y, z, radius), as for culling.
+    template <typename T>
+    void intersect_spheres(const ray<T>& r, const vector_stream<T, 4>& spheres, T tmax,
+                           vector_stream<T, 1>& t, std::vector<unsigned int>& mask)
+    {
+        typedef simd::batch<T> B;
+        typedef typename B::type P;
+
+        size_t count = spheres.size();
+        t.resize(count);
+        mask.assign((count + 31) / 32, 0);
+
+        P o[3], d[3];
+        simd::splat3(r.origin, o);
+        simd::splat3(r.direction, d);
+        P pmax = B::splat(tmax);
+        for (size_t i = 0; i < count; i += B::size)
+        {
+            P center[3], h;
+            center[0] = B::load(spheres.lane(0) + i);
+            center[1] = B::load(spheres.lane(1) + i);
+            center[2] = B::load(spheres.lane(2) + i);
+            B::store(t.lane(0) + i, simd::sphere_hit<B>(o, d, center, B::load(spheres.lane(3) + i), pmax, h));
+            mask[i / 32] |= simd::hit_bits<T>(h, i, count) << (i % 32);
+        }
+    }
+
+    // Closest triangle hit by r in [0, t). Returns its index, with t, u and
+    // v set to the hit, or NO_HIT, leaving them as they are. Hits in the
+    // same batch are resolved in order, so ties go to the lower index.
+    template <typename T>
+    size_t closest_triangle(const ray<T>& r, const vector_stream<T, 3>& a, const vector_stream<T, 3>& b, const vector_stream<T, 3>& c,
+                            T& t, T& u, T& v)
+    {
+        typedef simd::batch<T> B;
+        typedef typename B::type P;
+        assert(a.size() == b.size() && a.size() == c.size());
+
+        size_t count = a.size();
+        size_t hit   = NO_HIT;
+
+        P o[3], d[3];
+        simd::splat3(r.origin, o);
+        simd::splat3(r.direction, d);
+        P pmax = B::splat(t);
+        for (size_t i = 0; i < count; i += B::size)
+        {
+            P pa[3], pb[3], pc[3], pu, pv, h;
+            simd::load3(a, i, pa);
+            simd::load3(b, i, pb);
+            simd::load3(c, i, pc);
+            P pt = simd::triangle_hit<T, B>(o, d, pa, pb, pc, pmax, pu, pv, h);
+            unsigned int bits = simd::hit_bits<T>(h, i, count);
+            if (bits != 0)
+            {
+                alignas(32) T ht[B::size], hu[B::size], hv[B::size];
+                B::store(ht, pt);
+                B::store(hu, pu);
+                B::store(hv, pv);
+                for (unsigned int k = 0; k < B::size; k++)
+                {
+                    if ((bits >> k & 1) != 0 && ht[k] < t)
+                    {
+                        t   = ht[k];
+                        u   = hu[k];
+                        v   = hv[k];
+                        hit = i + k;
+                    }
+                }
+                // later batches only need to beat the closest hit so far
+                pmax = B::splat(t);
+            }
+        }
+        return hit;
+    }
+
+    // Closest sphere hit by r in [0, t). Returns its index, with t set to
+    // the hit, or NO_HIT, leaving t as it is.
+    template <typename T>
+    size_t closest_sphere(const ray<T>& r, const vector_stream<T, 4>& spheres, T& t)
+    {
+        typedef simd::batch<T> B;
+        typedef typename B::type P;
+
+        size_t count = spheres.size();
+        size_t hit   = NO_HIT;
+
+        P o[3], d[3];
+        simd::splat3(r.origin, o);
+        simd::splat3(r.direction, d);
+        P pmax = B::splat(t);
+        for (size_t i = 0; i < count; i += B::size)
+        {
+            P center[3], h;
+            center[0] = B::load(spheres.lane(0) + i);
+            center[1] = B::load(spheres.lane(1) + i);
+            center[2] = B::load(spheres.lane(2) + i);
+            P pt = simd::sphere_hit<B>(o, d, center, B::load(spheres.lane(3) + i), pmax, h);
+            unsigned int bits = simd::hit_bits<T>(h, i, count);
+            if (bits != 0)
+            {
+                alignas(32) T ht[B::size];
+                B::store(ht, pt);
+                for (unsigned int k = 0; k < B::size; k++)
+                {
+                    if ((bits >> k & 1) != 0 && ht[k] < t)
+                    {
+                        t   = ht[k];
+                        hit = i + k;
+                    }
+                }
+                pmax = B::splat(t);
+            }
+        }
+        return hit;
+    }
+
+    // Streams of rays, e.g. from unprojector::rays(), against one
+    // primitive, a batch of rays at a time; bit i % 32 of mask[i / 32] is
+    // set if ray i hits.
+
+    // Entry distances of the rays into the box, in [0, tmax[i]], or
+    // tmax[i] for the rays that miss, e.g. to decide which rays of a packet
+    // descend into a node.
+    template <typename T>
+    void intersect_box(const vector_stream<T, 3>& origins, const vector_stream<T, 3>& directions, const vector<T, 3>& lower, const vector<T, 3>& upper,
+                       const vector_stream<T, 1>& tmax, vector_stream<T, 1>& t, std::vector<unsigned int>& mask)
+    {
+        typedef simd::batch<T> B;
+        typedef typename B::type P;
+        assert(origins.size() == directions.size() && origins.size() == tmax.size());
+
+        size_t count = origins.size();
+        t.resize(count);
+        mask.assign((count + 31) / 32, 0);
+
+        P l[3], u[3];
+        simd::splat3(lower, l);
+        simd::splat3(upper, u);
+        P one = B::splat(1);
+        for (size_t i = 0; i < count; i += B::size)
+        {
+            P o[3], inv[3], h;
+            simd::load3(origins, i, o);
+            inv[0] = simd::div(one, B::load(directions.lane(0) + i));
+            inv[1] = simd::div(one, B::load(directions.lane(1) + i));
+            inv[2] = simd::div(one, B::load(directions.lane(2) + i));
+            B::store(t.lane(0) + i, simd::box_hit<B>(o, inv, l, u, B::load(tmax.lane(0) + i), h));
+            mask[i / 32] |= simd::hit_bits<T>(h, i, count) << (i % 32);
+        }
+    }
+
+    // Closest hit per ray: the lanes of hits are t, u and v of the closest
+    // hit of each ray so far, with t set to the far limit of the ray before
+    // the first triangle. Rays that hit the triangle in [0, t) get the new
+    // hit, so that calling this for each triangle of a mesh, and recording
+    // the rays set in mask, leaves the closest hits in hits.
+    template <typename T>
+    void intersect_triangle(const vector_stream<T, 3>& origins, const vector_stream<T, 3>& directions,
+                            const vector<T, 3>& a, const vector<T, 3>& b, const vector<T, 3>& c,
+                            vector_stream<T, 3>& hits, std::vector<unsigned int>& mask)
+    {
+        typedef simd::batch<T> B;
+        typedef typename B::type P;
+        assert(origins.size() == directions.size() && origins.size() == hits.size());
+
+        size_t count = origins.size();
+        mask.assign((count + 31) / 32, 0);
+
+        P pa[3], pb[3], pc[3];
+        simd::splat3(a, pa);
+        simd::splat3(b, pb);
+        simd::splat3(c, pc);
+        for (size_t i = 0; i < count; i += B::size)
+        {
+            P o[3], d[3], u, v, h;
+            simd::load3(origins, i, o);
+            simd::load3(directions, i, d);
+            B::store(hits.lane(0) + i, simd::triangle_hit<T, B>(o, d, pa, pb, pc, B::load(hits.lane(0) + i), u, v, h));
+            B::store(hits.lane(1) + i, simd::select(h, u, B::load(hits.lane(1) + i)));
+            B::store(hits.lane(2) + i, simd::select(h, v, B::load(hits.lane(2) + i)));
+            mask[i / 32] |= simd::hit_bits<T>(h, i, count) << (i % 32);
+        }
+    }
+
+    // Closest hit per ray, the same as for triangles with t alone.
+    template <typename T>
+    void intersect_sphere(const vector_stream<T, 3>& origins, const vector_stream<T, 3>& directions, const vector<T, 3>& center, T radius,
+                          vector_stream<T, 1>& t, std::vector<unsigned int>& mask)
+    {
+        typedef simd::batch<T> B;
+        typedef typename B::type P;
+        assert(origins.size() == directions.size() && origins.size() == t.size());
+
+        size_t count = origins.size();
+        mask.assign((count + 31) / 32, 0);
+
+        P pc[3];
+        simd::splat3(center, pc);
+        P pr = B::splat(radius);
+        for (size_t i = 0; i < count; i += B::size)
+        {
+            P o[3], d[3], h;
+            simd::load3(origins, i, o);
+            simd::load3(directions, i, d);
+            B::store(t.lane(0) + i, simd::sphere_hit<B>(o, d, pc, pr, B::load(t.lane(0) + i), h));
+            mask[i / 32] |= simd::hit_bits<T>(h, i, count) << (i % 32);
+        }
+    }
+}
+
+#endif
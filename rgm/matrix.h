@@ -28,6 +28,9 @@
 #include <cassert>
 #include <iostream>
 #include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <type_traits>
 
 #include "vector.h"
 
@@ -38,13 +41,13 @@ namespace rgm
     {
     public:
 
-        row(T* d)
+        constexpr row(T* d)
         : data(d) {}
 
-        row(const row<T, N>& r)
+        constexpr row(const row<T, N>& r)
         : data(r.data) {}
 
-        const row<T, N>& operator = (const vector<T, N>& v)
+        constexpr const row<T, N>& operator = (const vector<T, N>& v)
         {
             for (unsigned int j = 0; j < N; j++)
             {
@@ -54,7 +57,7 @@ namespace rgm
             return *this;
         }
 
-        const row<T, N>& operator = (const row<T, N>& v)
+        constexpr const row<T, N>& operator = (const row<T, N>& v)
         {
             for (unsigned int j = 0; j < N; j++)
             {
@@ -64,19 +67,19 @@ namespace rgm
             return *this;
         }
 
-        T& operator [] (unsigned int j)
+        constexpr T& operator [] (unsigned int j)
         {
             assert(j < N);
             return data[j];
         }
 
-        T operator [] (unsigned int j) const
+        constexpr T operator [] (unsigned int j) const
         {
             assert(j < N);
             return data[j];
         }
 
-        operator vector<T, N>()
+        constexpr operator vector<T, N>()
         {
             vector<T, N> r;
 
@@ -88,7 +91,7 @@ namespace rgm
             return r;
         }
 
-        const T* c_array() const
+        constexpr const T* c_array() const
         {
             return data;
         }
@@ -97,14 +100,55 @@ namespace rgm
         T* data;
     };
 
+    // Read only view of a column, returned by matrix::column(); unlike the
+    // const operator [] it refers to the matrix instead of copying it.
+    template <typename T, unsigned int N>
+    class const_row
+    {
+    public:
+
+        constexpr explicit const_row(const T* d)
+        : data(d) {}
+
+        constexpr const T& operator [] (unsigned int j) const
+        {
+            assert(j < N);
+            return data[j];
+        }
+
+        constexpr operator vector<T, N>() const
+        {
+            vector<T, N> r;
+
+            for (unsigned int j = 0; j < N; j++)
+            {
+                r[j] = data[j];
+            }
+
+            return r;
+        }
+
+        constexpr const T* c_array() const
+        {
+            return data;
+        }
+
+    private:
+        const T* data;
+    };
+
     template <typename T, unsigned int N>
     class matrix
     {
     public:
 
-        matrix() {}
+        constexpr matrix()
+        : data() {}
 
-        explicit matrix(T v)
+        explicit matrix(simd::no_init) {}
+
+        constexpr explicit matrix(T v)
+        : data()
         {
             for (unsigned int i = 0; i < N; i++)
             {
@@ -122,30 +166,19 @@ namespace rgm
             }
         }
 
-        matrix(const matrix<T, N>& m)
-        {
-            for (unsigned int i = 0; i < N*N; i++)
-            {
-                data[i] = m.data[i];
-            }
-        }
+        // Defaulted, so that matrices are trivially copyable and arrays of
+        // them are copied with memcpy.
+        matrix(const matrix<T, N>&) = default;
 
-        const matrix<T, N>& operator = (const matrix<T, N>& m)
-        {
-            for (unsigned int i = 0; i < N*N; i++)
-            {
-                data[i] = m.data[i];
-            }
-            return *this;
-        }
+        matrix<T, N>& operator = (const matrix<T, N>&) = default;
 
-        row<T, N> operator [] (unsigned int i)
+        constexpr row<T, N> operator [] (unsigned int i)
         {
             assert(i < N);
             return row<T, N>(&data[i * N]);
         }
 
-        vector<T, N> operator [] (unsigned int i) const
+        constexpr vector<T, N> operator [] (unsigned int i) const
         {
             assert(i < N);
             vector<T, N> r;
@@ -158,7 +191,27 @@ namespace rgm
             return r;
         }
 
-        const T* c_array() const
+        // Element j of column i, the same as m[i][j] without the proxy or
+        // the copy of the column.
+        constexpr T& at(unsigned int i, unsigned int j)
+        {
+            assert(i < N && j < N);
+            return data[i * N + j];
+        }
+
+        constexpr const T& at(unsigned int i, unsigned int j) const
+        {
+            assert(i < N && j < N);
+            return data[i * N + j];
+        }
+
+        constexpr const_row<T, N> column(unsigned int i) const
+        {
+            assert(i < N);
+            return const_row<T, N>(&data[i * N]);
+        }
+
+        constexpr const T* c_array() const
         {
             return data;
         }
@@ -172,12 +225,12 @@ namespace rgm
     {
     public:
 
-        matrix2() {}
+        constexpr matrix2() {}
 
-        explicit matrix2(T v)
+        constexpr explicit matrix2(T v)
         : matrix<T, 2>(v) {}
 
-        matrix2(T v0, T v2,
+        constexpr matrix2(T v0, T v2,
                 T v1, T v3)
         {
             data[0] = v0;
@@ -186,7 +239,7 @@ namespace rgm
             data[3] = v3;
         }
 
-        matrix2(const vector<T, 2>& x, const vector<T, 2>& y)
+        constexpr matrix2(const vector<T, 2>& x, const vector<T, 2>& y)
         {
             data[0] = x[0];
             data[1] = x[1];
@@ -194,16 +247,16 @@ namespace rgm
             data[3] = y[1];
         }
 
-        matrix2(const matrix<T, 2>& v)
+        constexpr matrix2(const matrix<T, 2>& v)
         : matrix<T, 2>(v) {}
 
-        matrix2(const matrix<T, 3>& v)
+        constexpr matrix2(const matrix<T, 3>& v)
         {
-            data[0] = v[0][0];
-            data[1] = v[0][1];
+            data[0] = v.at(0, 0);
+            data[1] = v.at(0, 1);
 
-            data[2] = v[1][0];
-            data[3] = v[1][1];
+            data[2] = v.at(1, 0);
+            data[3] = v.at(1, 1);
         }  
         
 
@@ -216,12 +269,12 @@ namespace rgm
     {
     public:
 
-        matrix3() {}
+        constexpr matrix3() {}
 
-        explicit matrix3(T v)
+        constexpr explicit matrix3(T v)
         : matrix<T, 3>(v) {}
 
-        matrix3(T v0, T v3, T v6,
+        constexpr matrix3(T v0, T v3, T v6,
                 T v1, T v4, T v7,
                 T v2, T v5, T v8)
         {
@@ -236,7 +289,7 @@ namespace rgm
             data[8] = v8;
         }
 
-        matrix3(const vector<T, 3>& x, const vector<T, 3>& y, const vector<T, 3>& z)
+        constexpr matrix3(const vector<T, 3>& x, const vector<T, 3>& y, const vector<T, 3>& z)
         {
             data[0] = x[0];
             data[1] = x[1];
@@ -249,22 +302,22 @@ namespace rgm
             data[8] = z[2];
         }
 
-        matrix3(const matrix<T, 3>& v)
+        constexpr matrix3(const matrix<T, 3>& v)
         : matrix<T, 3>(v) {}
 
-        matrix3(const matrix<T, 4>& v)
+        constexpr matrix3(const matrix<T, 4>& v)
         {
-            data[0] = v[0][0];
-            data[1] = v[0][1];
-            data[2] = v[0][2];
+            data[0] = v.at(0, 0);
+            data[1] = v.at(0, 1);
+            data[2] = v.at(0, 2);
 
-            data[3] = v[1][0];
-            data[4] = v[1][1];
-            data[5] = v[1][2];
+            data[3] = v.at(1, 0);
+            data[4] = v.at(1, 1);
+            data[5] = v.at(1, 2);
 
-            data[6] = v[2][0];
-            data[7] = v[2][1];
-            data[8] = v[2][2];
+            data[6] = v.at(2, 0);
+            data[7] = v.at(2, 1);
+            data[8] = v.at(2, 2);
         }  
         
     protected:
@@ -276,15 +329,15 @@ namespace rgm
     {
     public:
 
-        matrix4() {}
+        constexpr matrix4() {}
 
-        explicit matrix4(T v)
+        constexpr explicit matrix4(T v)
         : matrix<T, 4>(v) {}
 
-        matrix4(float v0, float v4, float v8, float v12,
-                float v1, float v5, float v9, float v13,
-                float v2, float v6, float v10, float v14,
-                float v3, float v7, float v11, float v15)
+        constexpr matrix4(T v0, T v4, T v8,  T v12,
+                T v1, T v5, T v9,  T v13,
+                T v2, T v6, T v10, T v14,
+                T v3, T v7, T v11, T v15)
         {
             data[0]  = v0;
             data[1]  = v1;
@@ -304,7 +357,7 @@ namespace rgm
             data[15] = v15;
         }
 
-        matrix4(const vector<T, 4>& x, const vector<T, 4>& y, const vector<T, 4>& z, const vector<T, 4>& p)
+        constexpr matrix4(const vector<T, 4>& x, const vector<T, 4>& y, const vector<T, 4>& z, const vector<T, 4>& p)
         {
             data[0]  = x[0];
             data[1]  = x[1];
@@ -324,7 +377,7 @@ namespace rgm
             data[15] = p[3];
         }
 
-        matrix4(const matrix<T, 4>& v)
+        constexpr matrix4(const matrix<T, 4>& v)
             : matrix<T, 4>(v) {}
 
     protected:
@@ -332,13 +385,13 @@ namespace rgm
     };
 
     template <typename T, unsigned int N>
-    bool operator == (const matrix<T, N>& a, const matrix<T, N>& b)
+    constexpr bool operator == (const matrix<T, N>& a, const matrix<T, N>& b)
     {
         for (unsigned int i = 0; i < N; i++)
         {
             for (unsigned int j = 0; j < N; j++)
             {
-                if (a[i][j] != b[i][j])
+                if (a.at(i, j) != b.at(i, j))
                 {
                     return false;
                 }
@@ -348,61 +401,61 @@ namespace rgm
     }
 
     template <typename T, unsigned int N>
-    bool operator != (const matrix<T, N>& a, const matrix<T, N>& b)
+    constexpr bool operator != (const matrix<T, N>& a, const matrix<T, N>& b)
     {
         return !(a == b);
     }
 
     template <typename T, unsigned int N>
-    matrix<T, N> operator + (const matrix<T, N>& a)
+    constexpr matrix<T, N> operator + (const matrix<T, N>& a)
     {
         return a;
     }
 
     template <typename T, unsigned int N>
-    matrix<T, N> operator - (const matrix<T, N>& a)
+    constexpr matrix<T, N> operator - (const matrix<T, N>& a)
     {
         matrix<T, N> r;
         for (unsigned int i = 0; i < N; i++)
         {
             for (unsigned int j = 0; j < N; j++)
             {
-                r[i][j] = -a[i][j];
+                r.at(i, j) = -a.at(i, j);
             }
         }
         return r;
     }
 
     template <typename T, unsigned int N>
-    matrix<T, N> operator + (const matrix<T, N>& a, const matrix<T, N>& b)
+    constexpr matrix<T, N> operator + (const matrix<T, N>& a, const matrix<T, N>& b)
     {
         matrix<T, N> r;
         for (unsigned int i = 0; i < N; i++)
         {
             for (unsigned int j = 0; j < N; j++)
             {
-                r[i][j] = a[i][j] + b[i][j];
+                r.at(i, j) = a.at(i, j) + b.at(i, j);
             }
         }
         return r;
     }
 
     template <typename T, unsigned int N>
-    matrix<T, N> operator - (const matrix<T, N>& a, const matrix<T, N>& b)
+    constexpr matrix<T, N> operator - (const matrix<T, N>& a, const matrix<T, N>& b)
     {
         matrix<T, N> r;
         for (unsigned int i = 0; i < N; i++)
         {
             for (unsigned int j = 0; j < N; j++)
             {
-                r[i][j] = a[i][j] - b[i][j];
+                r.at(i, j) = a.at(i, j) - b.at(i, j);
             }
         }
         return r;
     }
 
     template <typename T, unsigned int N>
-    matrix<T, N> operator * (const matrix<T, N>& a, const matrix<T, N>& b)
+    constexpr matrix<T, N> operator * (const matrix<T, N>& a, const matrix<T, N>& b)
     {
         matrix<T, N> r((T)0);
 
@@ -412,7 +465,7 @@ namespace rgm
             {
                 for (unsigned int k = 0; k < N; k++)
                 {
-                    r[i][j] += a[k][j] * b[i][k];
+                    r.at(i, j) += a.at(k, j) * b.at(i, k);
                 }
             }
         }
@@ -421,7 +474,7 @@ namespace rgm
     }
 
     template <typename T, unsigned int N>
-    vector<T, N> operator * (const matrix<T, N>& m, const vector<T, N>& v)
+    constexpr vector<T, N> operator * (const matrix<T, N>& m, const vector<T, N>& v)
     {
         vector<T, N> r((T)0);
 
@@ -429,15 +482,94 @@ namespace rgm
         {
             for (unsigned int j = 0; j < N; j++)
             {
-                r[i] += m[j][i] * v[j];
+                r[i] += m.at(j, i) * v[j];
             }
         }
 
         return r;
     }
 
+#ifdef RGM_SSE2
+    namespace simd
+    {
+        // SIMD versions of the float and double 4x4 products. Each column of
+        // the result is built from the columns of the left matrix, scaled by
+        // the broadcast elements of the right one, accumulated in the same
+        // order as the generic loops. Without FMA the results are the same as
+        // the loops. With FMA (RGM_FMA) each element is computed with one
+        // rounding less, both are within 4 * eps * sum(abs(a[k][j] * b[i][k]))
+        // of the exact value, so they differ by at most twice that.
+        template <typename T>
+        matrix<T, 4> product(const matrix<T, 4>& a, const matrix<T, 4>& b)
+        {
+            typedef packed<T, 4> S;
+            typedef typename S::type P;
+            const T* pa = a.c_array();
+            const T* pb = b.c_array();
+
+            P a0 = S::load(pa);
+            P a1 = S::load(pa + 4);
+            P a2 = S::load(pa + 8);
+            P a3 = S::load(pa + 12);
+
+            matrix<T, 4> r((no_init()));
+            for (unsigned int i = 0; i < 4; i++)
+            {
+                const T* bi = pb + 4 * i;
+                P c = mul(a0, S::splat(bi[0]));
+                c = madd(a1, S::splat(bi[1]), c);
+                c = madd(a2, S::splat(bi[2]), c);
+                c = madd(a3, S::splat(bi[3]), c);
+                S::store(&r.at(i, 0), c);
+            }
+
+            return r;
+        }
+
+        template <typename T>
+        vector<T, 4> product(const matrix<T, 4>& m, const vector<T, 4>& v)
+        {
+            typedef packed<T, 4> S;
+            typedef typename S::type P;
+            const T* pm = m.c_array();
+
+            P c = mul(S::load(pm), S::splat(v[0]));
+            c = madd(S::load(pm + 4),  S::splat(v[1]), c);
+            c = madd(S::load(pm + 8),  S::splat(v[2]), c);
+            c = madd(S::load(pm + 12), S::splat(v[3]), c);
+
+            vector<T, 4> r;
+            S::store(&r[0], c);
+            return r;
+        }
+    }
+
+    // In constant expressions the products defer to the loops. The kernels
+    // are separate functions so that both branches return a temporary and
+    // the result is still constructed in place.
+    template <typename T, typename P = typename simd::packed<T, 4>::type>
+    RGM_SIMD_CONSTEXPR matrix<T, 4> operator * (const matrix<T, 4>& a, const matrix<T, 4>& b)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return operator * <T, 4>(a, b);
+        }
+        return simd::product(a, b);
+    }
+
+    template <typename T, typename P = typename simd::packed<T, 4>::type>
+    RGM_SIMD_CONSTEXPR vector<T, 4> operator * (const matrix<T, 4>& m, const vector<T, 4>& v)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return operator * <T, 4>(m, v);
+        }
+        return simd::product(m, v);
+    }
+#endif
+
     template <typename T, unsigned int N>
-    matrix<T, N> operator * (const matrix<T, N>& m, T s)
+    constexpr matrix<T, N> operator * (const matrix<T, N>& m, T s)
     {
         matrix<T, N> r;
 
@@ -445,7 +577,7 @@ namespace rgm
         {
             for (unsigned int j = 0; j < N; j++)
             {
-                r[i][j] = m[j][i] * s;
+                r.at(i, j) = m.at(i, j) * s;
             }
         }
 
@@ -453,13 +585,13 @@ namespace rgm
     }
 
     template <typename T, unsigned int N>
-    matrix<T, N> operator * (T s, const matrix<T, N>& m)
+    constexpr matrix<T, N> operator * (T s, const matrix<T, N>& m)
     {
         return m * s;
     }
 
     template <typename T, unsigned int N>
-    matrix<T, N> matrixCompMult(const matrix<T, N>& a, const matrix<T, N>& b)
+    constexpr matrix<T, N> matrixCompMult(const matrix<T, N>& a, const matrix<T, N>& b)
     {
         matrix<T, N> r((T)0);
 
@@ -467,7 +599,7 @@ namespace rgm
         {
             for (unsigned int j = 0; j < N; j++)
             {
-                r[i][j] = a[i][j] * b[i][j];
+                r.at(i, j) = a.at(i, j) * b.at(i, j);
             }
         }
 
@@ -475,46 +607,107 @@ namespace rgm
     }
 
     template <typename T>
-    T det(const matrix<T, 1>& a)
+    constexpr T det(const matrix<T, 1>& a)
+    {
+        return a.c_array()[0];
+    }
+
+    template <typename T>
+    constexpr T det(const matrix<T, 2>& a)
+    {
+        const T* m = a.c_array();
+        return m[0] * m[3] - m[2] * m[1];
+    }
+
+    template <typename T>
+    constexpr T det(const matrix<T, 3>& a)
     {
-        return a[0][0];;
+        const T* m = a.c_array();
+        return m[0] * (m[4] * m[8] - m[5] * m[7])
+             + m[1] * (m[5] * m[6] - m[3] * m[8])
+             + m[2] * (m[3] * m[7] - m[4] * m[6]);
     }
 
     template <typename T>
-    T det(const matrix<T, 2>& a)
+    constexpr T det(const matrix<T, 4>& a)
     {
-        return a[0][0] * a[1][1] - a[1][0] * a[0][1];
+        const T* m = a.c_array();
+
+        T s0 = m[0] * m[5]  - m[4] * m[1];
+        T s1 = m[0] * m[6]  - m[4] * m[2];
+        T s2 = m[0] * m[7]  - m[4] * m[3];
+        T s3 = m[1] * m[6]  - m[5] * m[2];
+        T s4 = m[1] * m[7]  - m[5] * m[3];
+        T s5 = m[2] * m[7]  - m[6] * m[3];
+
+        T c5 = m[10] * m[15] - m[14] * m[11];
+        T c4 = m[9]  * m[15] - m[13] * m[11];
+        T c3 = m[9]  * m[14] - m[13] * m[10];
+        T c2 = m[8]  * m[15] - m[12] * m[11];
+        T c1 = m[8]  * m[14] - m[12] * m[10];
+        T c0 = m[8]  * m[13] - m[12] * m[9];
+
+        return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
     }
 
+    // LU decomposition with partial pivoting, for the sizes without a
+    // closed form.
     template <typename T, unsigned int N>
-    T det(const matrix<T, N>& a)
+    constexpr T det(const matrix<T, N>& a)
     {
-        assert(N > 2);
-        T d = 0;
-        for (unsigned int j1 = 0; j1 < N; j1++)
+        T m[N * N] = {};
+        for (unsigned int i = 0; i < N * N; i++)
+        {
+            m[i] = a.c_array()[i];
+        }
+
+        T d = 1;
+        for (unsigned int k = 0; k < N; k++)
         {
-            matrix<T, N - 1> m;
-            for (unsigned int i = 1; i < N; i++)
+            unsigned int p = k;
+            for (unsigned int j = k + 1; j < N; j++)
             {
-                unsigned int j2 = 0;
-                for (unsigned int j = 0; j < N; j++)
+                T mj = m[k * N + j] < 0 ? -m[k * N + j] : m[k * N + j];
+                T mp = m[k * N + p] < 0 ? -m[k * N + p] : m[k * N + p];
+                if (mj > mp)
                 {
-                    if (j == j1)
-                    {
-                        continue;
-                    }
+                    p = j;
+                }
+            }
+
+            if (m[k * N + p] == 0)
+            {
+                return 0;
+            }
+
+            if (p != k)
+            {
+                for (unsigned int i = 0; i < N; i++)
+                {
+                    T t = m[i * N + k];
+                    m[i * N + k] = m[i * N + p];
+                    m[i * N + p] = t;
+                }
+                d = -d;
+            }
 
-                    m[i - 1][j2] = a[i][j];
-                    j2++;
+            T pivot = m[k * N + k];
+            d *= pivot;
+
+            for (unsigned int j = k + 1; j < N; j++)
+            {
+                T f = m[k * N + j] / pivot;
+                for (unsigned int i = k + 1; i < N; i++)
+                {
+                    m[i * N + j] -= f * m[i * N + k];
                 }
             }
-            d += (T)std::pow(-1.0, j1 + 2.0) * a[0][j1] * det(m);
         }
         return d;
     }
 
     template <typename T, unsigned int N>
-    matrix<T, N> cofct(const matrix<T, N>& a)
+    constexpr matrix<T, N> cofct(const matrix<T, N>& a)
     {
         matrix<T, N> b;
         matrix<T, N - 1> c;
@@ -539,12 +732,12 @@ namespace rgm
                             continue;
                         }
                             
-                        c[i1][j1] = a[ii][jj];
+                        c.at(i1, j1) = a.at(ii, jj);
                         j1++;
                     }
                     i1++;
                 }
-                b[i][j] = (T)std::pow(-1.0, i + j + 2.0) * det(c);
+                b.at(i, j) = (i + j) % 2 == 0 ? det(c) : -det(c);
             }
         }
         
@@ -552,7 +745,7 @@ namespace rgm
     }
 
     template <typename T, unsigned int N>
-    matrix<T, N> transpose(const matrix<T, N>& m)
+    constexpr matrix<T, N> transpose(const matrix<T, N>& m)
     {
         matrix<T, N> r((T)0);
 
@@ -560,7 +753,7 @@ namespace rgm
         {
             for (unsigned int j = 0; j < N; j++)
             {
-                r[j][i] = m[i][j];
+                r.at(j, i) = m.at(i, j);
             }
         }
 
@@ -568,17 +761,272 @@ namespace rgm
     }
      
     template <typename T, unsigned int N>
-    matrix<T, N> adj(const matrix<T, N>& m)
+    constexpr matrix<T, N> adj(const matrix<T, N>& m)
+    {
+        return transpose(cofct(m));
+    }
+
+    // The inverse; invertible is set to false if the determinant or a pivot
+    // is exactly zero, the returned matrix is then not usable.
+    //
+    // The closed forms below are written against the column major storage;
+    // since inv(transpose(m)) == transpose(inv(m)), the textbook row major
+    // formulas apply unchanged.
+    template <typename T>
+    matrix<T, 2> inv(const matrix<T, 2>& a, bool& invertible)
+    {
+        const T* m = a.c_array();
+
+        T d = m[0] * m[3] - m[2] * m[1];
+        invertible = d != 0;
+        T id = 1 / d;
+
+        matrix<T, 2> r((simd::no_init()));
+        r[0][0] =  m[3] * id;
+        r[0][1] = -m[1] * id;
+        r[1][0] = -m[2] * id;
+        r[1][1] =  m[0] * id;
+        return r;
+    }
+
+    template <typename T>
+    matrix<T, 3> inv(const matrix<T, 3>& a, bool& invertible)
     {
-        return trans(cofct(m));
+        const T* m = a.c_array();
+
+        T c0 = m[4] * m[8] - m[5] * m[7];
+        T c1 = m[5] * m[6] - m[3] * m[8];
+        T c2 = m[3] * m[7] - m[4] * m[6];
+
+        T d = m[0] * c0 + m[1] * c1 + m[2] * c2;
+        invertible = d != 0;
+        T id = 1 / d;
+
+        matrix<T, 3> r((simd::no_init()));
+        r[0][0] = c0 * id;
+        r[0][1] = (m[2] * m[7] - m[1] * m[8]) * id;
+        r[0][2] = (m[1] * m[5] - m[2] * m[4]) * id;
+        r[1][0] = c1 * id;
+        r[1][1] = (m[0] * m[8] - m[2] * m[6]) * id;
+        r[1][2] = (m[2] * m[3] - m[0] * m[5]) * id;
+        r[2][0] = c2 * id;
+        r[2][1] = (m[1] * m[6] - m[0] * m[7]) * id;
+        r[2][2] = (m[0] * m[4] - m[1] * m[3]) * id;
+        return r;
+    }
+
+    template <typename T>
+    matrix<T, 4> inv(const matrix<T, 4>& a, bool& invertible)
+    {
+        const T* m = a.c_array();
+
+        T s0 = m[0] * m[5]  - m[4] * m[1];
+        T s1 = m[0] * m[6]  - m[4] * m[2];
+        T s2 = m[0] * m[7]  - m[4] * m[3];
+        T s3 = m[1] * m[6]  - m[5] * m[2];
+        T s4 = m[1] * m[7]  - m[5] * m[3];
+        T s5 = m[2] * m[7]  - m[6] * m[3];
+
+        T c5 = m[10] * m[15] - m[14] * m[11];
+        T c4 = m[9]  * m[15] - m[13] * m[11];
+        T c3 = m[9]  * m[14] - m[13] * m[10];
+        T c2 = m[8]  * m[15] - m[12] * m[11];
+        T c1 = m[8]  * m[14] - m[12] * m[10];
+        T c0 = m[8]  * m[13] - m[12] * m[9];
+
+        T d = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+        invertible = d != 0;
+        T id = 1 / d;
+
+        matrix<T, 4> r((simd::no_init()));
+        r[0][0] = ( m[5]  * c5 - m[6]  * c4 + m[7]  * c3) * id;
+        r[0][1] = (-m[1]  * c5 + m[2]  * c4 - m[3]  * c3) * id;
+        r[0][2] = ( m[13] * s5 - m[14] * s4 + m[15] * s3) * id;
+        r[0][3] = (-m[9]  * s5 + m[10] * s4 - m[11] * s3) * id;
+
+        r[1][0] = (-m[4]  * c5 + m[6]  * c2 - m[7]  * c1) * id;
+        r[1][1] = ( m[0]  * c5 - m[2]  * c2 + m[3]  * c1) * id;
+        r[1][2] = (-m[12] * s5 + m[14] * s2 - m[15] * s1) * id;
+        r[1][3] = ( m[8]  * s5 - m[10] * s2 + m[11] * s1) * id;
+
+        r[2][0] = ( m[4]  * c4 - m[5]  * c2 + m[7]  * c0) * id;
+        r[2][1] = (-m[0]  * c4 + m[1]  * c2 - m[3]  * c0) * id;
+        r[2][2] = ( m[12] * s4 - m[13] * s2 + m[15] * s0) * id;
+        r[2][3] = (-m[8]  * s4 + m[9]  * s2 - m[11] * s0) * id;
+
+        r[3][0] = (-m[4]  * c3 + m[5]  * c1 - m[6]  * c0) * id;
+        r[3][1] = ( m[0]  * c3 - m[1]  * c1 + m[2]  * c0) * id;
+        r[3][2] = (-m[12] * s3 + m[13] * s1 - m[14] * s0) * id;
+        r[3][3] = ( m[8]  * s3 - m[9]  * s1 + m[10] * s0) * id;
+        return r;
+    }
+
+#ifdef RGM_SSE2
+    namespace simd
+    {
+        template <int X, int Y, int Z, int W>
+        float4 shuffle(float4 a, float4 b)
+        {
+            return _mm_shuffle_ps(a, b, _MM_SHUFFLE(W, Z, Y, X));
+        }
+
+        template <int X, int Y, int Z, int W>
+        float4 swizzle(float4 a)
+        {
+            return _mm_shuffle_ps(a, a, _MM_SHUFFLE(W, Z, Y, X));
+        }
+
+        // products of 2x2 matrices held in one register as (m00, m01, m10, m11)
+        inline float4 mat2_mul(float4 a, float4 b)
+        {
+            return add(mul(a, swizzle<0, 3, 0, 3>(b)), mul(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+        }
+
+        // adj(a) * b
+        inline float4 mat2_adj_mul(float4 a, float4 b)
+        {
+            return sub(mul(swizzle<3, 3, 0, 0>(a), b), mul(swizzle<1, 1, 2, 2>(a), swizzle<2, 3, 0, 1>(b)));
+        }
+
+        // a * adj(b)
+        inline float4 mat2_mul_adj(float4 a, float4 b)
+        {
+            return sub(mul(a, swizzle<3, 0, 3, 0>(b)), mul(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+        }
+    }
+
+    // SIMD inverse for mat4 by 2x2 blocks:
+    //
+    //   M = | A B |   inv(M) = 1/|M| | X Y |
+    //       | C D |                  | Z W |
+    //
+    // with the adjugates of the blocks X = |D|A - B(D#C), ... and
+    // |M| = |A||D| + |B||C| - tr((A#B)(D#C)).
+    inline matrix<float, 4> inv(const matrix<float, 4>& m, bool& invertible)
+    {
+        const float* p = m.c_array();
+        simd::float4 m0 = _mm_loadu_ps(p);
+        simd::float4 m1 = _mm_loadu_ps(p + 4);
+        simd::float4 m2 = _mm_loadu_ps(p + 8);
+        simd::float4 m3 = _mm_loadu_ps(p + 12);
+
+        simd::float4 a = _mm_movelh_ps(m0, m1);
+        simd::float4 b = _mm_movehl_ps(m1, m0);
+        simd::float4 c = _mm_movelh_ps(m2, m3);
+        simd::float4 d = _mm_movehl_ps(m3, m2);
+
+        // (|A|, |B|, |C|, |D|)
+        simd::float4 dets = simd::sub(simd::mul(simd::shuffle<0, 2, 0, 2>(m0, m2), simd::shuffle<1, 3, 1, 3>(m1, m3)),
+                                      simd::mul(simd::shuffle<1, 3, 1, 3>(m0, m2), simd::shuffle<0, 2, 0, 2>(m1, m3)));
+        simd::float4 det_a = simd::swizzle<0, 0, 0, 0>(dets);
+        simd::float4 det_b = simd::swizzle<1, 1, 1, 1>(dets);
+        simd::float4 det_c = simd::swizzle<2, 2, 2, 2>(dets);
+        simd::float4 det_d = simd::swizzle<3, 3, 3, 3>(dets);
+
+        simd::float4 d_c = simd::mat2_adj_mul(d, c);
+        simd::float4 a_b = simd::mat2_adj_mul(a, b);
+
+        simd::float4 x = simd::sub(simd::mul(det_d, a), simd::mat2_mul(b, d_c));
+        simd::float4 w = simd::sub(simd::mul(det_a, d), simd::mat2_mul(c, a_b));
+        simd::float4 y = simd::sub(simd::mul(det_b, c), simd::mat2_mul_adj(d, a_b));
+        simd::float4 z = simd::sub(simd::mul(det_c, b), simd::mat2_mul_adj(a, d_c));
+
+        simd::float4 tr = simd::mul(a_b, simd::swizzle<0, 2, 1, 3>(d_c));
+        tr = simd::add(tr, simd::swizzle<2, 3, 0, 1>(tr));
+        tr = simd::add(tr, simd::swizzle<1, 0, 3, 2>(tr));
+
+        simd::float4 det_m = simd::sub(simd::add(simd::mul(det_a, det_d), simd::mul(det_b, det_c)), tr);
+        invertible = _mm_cvtss_f32(det_m) != 0;
+
+        // the signs of the adjugate
+        simd::float4 rdet = simd::div(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det_m);
+        x = simd::mul(x, rdet);
+        y = simd::mul(y, rdet);
+        z = simd::mul(z, rdet);
+        w = simd::mul(w, rdet);
+
+        matrix<float, 4> r((simd::no_init()));
+        float* pr = &r.at(0, 0);
+        _mm_storeu_ps(pr,      simd::shuffle<3, 1, 3, 1>(x, y));
+        _mm_storeu_ps(pr + 4,  simd::shuffle<2, 0, 2, 0>(x, y));
+        _mm_storeu_ps(pr + 8,  simd::shuffle<3, 1, 3, 1>(z, w));
+        _mm_storeu_ps(pr + 12, simd::shuffle<2, 0, 2, 0>(z, w));
+        return r;
+    }
+#endif
+
+    // Gauss-Jordan elimination with partial pivoting, for the sizes
+    // without a closed form.
+    template <typename T, unsigned int N>
+    matrix<T, N> inv(const matrix<T, N>& a, bool& invertible)
+    {
+        T m[N * N];
+        for (unsigned int i = 0; i < N * N; i++)
+        {
+            m[i] = a.c_array()[i];
+        }
+
+        matrix<T, N> r((T)1);
+        T* pr = &r.at(0, 0);
+
+        invertible = true;
+        for (unsigned int k = 0; k < N; k++)
+        {
+            unsigned int p = k;
+            for (unsigned int j = k + 1; j < N; j++)
+            {
+                if (std::abs(m[k * N + j]) > std::abs(m[k * N + p]))
+                {
+                    p = j;
+                }
+            }
+
+            if (m[k * N + p] == 0)
+            {
+                invertible = false;
+                return r;
+            }
+
+            if (p != k)
+            {
+                for (unsigned int i = 0; i < N; i++)
+                {
+                    std::swap(m[i * N + k], m[i * N + p]);
+                    std::swap(pr[i * N + k], pr[i * N + p]);
+                }
+            }
+
+            T ipivot = 1 / m[k * N + k];
+            for (unsigned int i = 0; i < N; i++)
+            {
+                m[i * N + k]  *= ipivot;
+                pr[i * N + k] *= ipivot;
+            }
+
+            for (unsigned int j = 0; j < N; j++)
+            {
+                if (j == k)
+                {
+                    continue;
+                }
+
+                T f = m[k * N + j];
+                for (unsigned int i = 0; i < N; i++)
+                {
+                    m[i * N + j]  -= f * m[i * N + k];
+                    pr[i * N + j] -= f * pr[i * N + k];
+                }
+            }
+        }
+
+        return r;
     }
 
     template <typename T, unsigned int N>
     matrix<T, N> inv(const matrix<T, N>& m)
     {
-        // WTF?! either the cofct is wrong or the adj 
-        //return (1 / det(m)) * adj(m);
-        return (1 / det(m)) * cofct(m);
+        bool invertible;
+        return inv(m, invertible);
     }
 
     template <typename T, unsigned int N>
@@ -589,7 +1037,7 @@ namespace rgm
         {
             for (size_t j = 0; j < N; ++j)
             {
-                result[i][j] = std::abs(m[i][j]);
+                result.at(i, j) = std::abs(m.at(i, j));
             }
         }
         return result;
@@ -598,12 +1046,11 @@ namespace rgm
     template <typename T, unsigned int N>
     bool close(const matrix<T, N>& a, const matrix<T, N>& b, T eps)
     {
-        auto c = abs(a - b);
-        for (size_t i = 0; i < N; ++i)
+        for (unsigned int i = 0; i < N; ++i)
         {
-            for (size_t j = 0; j < N; ++j)
+            for (unsigned int j = 0; j < N; ++j)
             { 
-                if (c[i][j] > eps)
+                if (std::abs(a.at(i, j) - b.at(i, j)) > eps)
                 {
                     return false;
                 }
@@ -620,7 +1067,7 @@ namespace rgm
         {
             for (unsigned int i = 0; i < N; i++)
             {
-                os << m[i][j];
+                os << m.at(i, j);
                 if (i != N - 1)
                 {
                     os << ", ";
@@ -654,6 +1101,10 @@ namespace rgm
     typedef matrix2<double> dmat2;
     typedef matrix3<double> dmat3;
     typedef matrix4<double> dmat4;
+
+    static_assert(std::is_trivially_copyable<mat4>::value && std::is_trivially_copyable<dmat3>::value, "matrices must be trivially copyable");
+    static_assert(std::is_standard_layout<mat4>::value && std::is_standard_layout<dmat3>::value, "matrices must be standard layout");
+    static_assert(sizeof(mat4) == 16 * sizeof(float) && sizeof(dmat3) == 9 * sizeof(double), "matrices must not be padded");
 }
 
 #endif
@@ -0,0 +1,278 @@
+/*
+    rgm - Rioki's Graphic Math Library
+
+    Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+#ifndef _RGM_MEMORY_H_
+#define _RGM_MEMORY_H_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#include "vector.h"
+#include "matrix.h"
+
+namespace rgm
+{
+    // Allocates size bytes aligned to alignment, which must be a power of
+    // two. Throws std::bad_alloc like new; release with aligned_free.
+    inline void* aligned_malloc(size_t size, size_t alignment)
+    {
+        assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+        // the pointer returned by new is kept in front of the block
+        unsigned char* m = static_cast<unsigned char*>(::operator new(size + alignment + sizeof(void*) - 1));
+        uintptr_t      a = (reinterpret_cast<uintptr_t>(m) + sizeof(void*) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+        reinterpret_cast<void**>(a)[-1] = m;
+        return reinterpret_cast<void*>(a);
+    }
+
+    inline void aligned_free(void* p)
+    {
+        if (p != 0)
+        {
+            ::operator delete(static_cast<void**>(p)[-1]);
+        }
+    }
+
+    // Allocator for standard containers with an alignment of A bytes, by
+    // default the 32 bytes of the widest SIMD register, e.g.
+    // std::vector<mat4, aligned_allocator<mat4>>. Needed for over-aligned
+    // types like amat4, since C++14 containers only align to 16 bytes.
+    template <typename T, size_t A = (alignof(T) > 32 ? alignof(T) : 32)>
+    class aligned_allocator
+    {
+    public:
+        static_assert(A >= alignof(T), "aligned_allocator can not align less than the type");
+
+        typedef T value_type;
+
+        template <typename U>
+        struct rebind
+        {
+            typedef aligned_allocator<U, A> other;
+        };
+
+        aligned_allocator() {}
+
+        template <typename U>
+        aligned_allocator(const aligned_allocator<U, A>&) {}
+
+        T* allocate(size_t n)
+        {
+            return static_cast<T*>(aligned_malloc(n * sizeof(T), A));
+        }
+
+        void deallocate(T* p, size_t)
+        {
+            aligned_free(p);
+        }
+    };
+
+    template <typename T, typename U, size_t A>
+    bool operator == (const aligned_allocator<T, A>&, const aligned_allocator<U, A>&)
+    {
+        return true;
+    }
+
+    template <typename T, typename U, size_t A>
+    bool operator != (const aligned_allocator<T, A>&, const aligned_allocator<U, A>&)
+    {
+        return false;
+    }
+
+    // Bump allocator for transient arrays that live for one frame. All
+    // memory is handed back at once with reset(), which does not touch the
+    // heap as long as the frame fit into the capacity. Allocations beyond
+    // the capacity get their own block; the next reset() then grows the
+    // arena, so that a steady frame needs no heap operations.
+    class frame_arena
+    {
+    public:
+        static const size_t alignment = 32;
+
+        explicit frame_arena(size_t capacity = 0)
+        : block(0), block_size(0), offset(0), spill_size(0)
+        {
+            grow(capacity);
+        }
+
+        frame_arena(const frame_arena&) = delete;
+        frame_arena& operator = (const frame_arena&) = delete;
+
+        ~frame_arena()
+        {
+            release_spills();
+            aligned_free(block);
+        }
+
+        // Returns size bytes aligned to align, a power of two; by default
+        // the alignment of the widest SIMD register.
+        void* allocate(size_t size, size_t align = alignment)
+        {
+            size_t start = (offset + align - 1) & ~(align - 1);
+            if (align <= BLOCK_ALIGNMENT && start + size <= block_size)
+            {
+                offset = start + size;
+                return block + start;
+            }
+            return spill(size, align);
+        }
+
+        // Makes all memory available again; the pointers handed out so far
+        // become invalid.
+        void reset()
+        {
+            if (!spills.empty())
+            {
+                size_t size = block_size + spill_size;
+                release_spills();
+                grow(size);
+            }
+            offset = 0;
+        }
+
+        size_t capacity() const
+        {
+            return block_size;
+        }
+
+        // Bytes handed out since the last reset, including the padding for
+        // alignment and the blocks beyond the capacity.
+        size_t size() const
+        {
+            return offset + spill_size;
+        }
+
+    private:
+        // alignment of the block, so that cache line aligned types fit
+        static const size_t BLOCK_ALIGNMENT = 64;
+
+        unsigned char*     block;
+        size_t             block_size;
+        size_t             offset;
+        std::vector<void*> spills;
+        size_t             spill_size;
+
+        void grow(size_t size)
+        {
+            aligned_free(block);
+            block      = 0;
+            block_size = (size + alignment - 1) & ~(alignment - 1);
+            if (block_size != 0)
+            {
+                block = static_cast<unsigned char*>(aligned_malloc(block_size, BLOCK_ALIGNMENT));
+            }
+        }
+
+        void* spill(size_t size, size_t align)
+        {
+            void* p = aligned_malloc(size, align > alignment ? align : alignment);
+            spills.push_back(p);
+            spill_size += size + align;
+            return p;
+        }
+
+        void release_spills()
+        {
+            for (void* p : spills)
+            {
+                aligned_free(p);
+            }
+            spills.clear();
+            spill_size = 0;
+        }
+    };
+
+    // Allocator for standard containers that takes its memory from a
+    // frame_arena. Deallocation does nothing; the memory is reclaimed by
+    // the arena's reset(), so the container must not be used after it.
+    template <typename T>
+    class arena_allocator
+    {
+    public:
+        typedef T value_type;
+
+        explicit arena_allocator(frame_arena& a)
+        : arena(&a) {}
+
+        template <typename U>
+        arena_allocator(const arena_allocator<U>& a)
+        : arena(a.arena) {}
+
+        T* allocate(size_t n)
+        {
+            return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T) > frame_arena::alignment ? alignof(T) : frame_arena::alignment));
+        }
+
+        void deallocate(T*, size_t) {}
+
+    private:
+        template <typename U> friend class arena_allocator;
+        template <typename U, typename V> friend bool operator == (const arena_allocator<U>&, const arena_allocator<V>&);
+
+        frame_arena* arena;
+    };
+
+    template <typename T, typename U>
+    bool operator == (const arena_allocator<T>& a, const arena_allocator<U>& b)
+    {
+        return a.arena == b.arena;
+    }
+
+    template <typename T, typename U>
+    bool operator != (const arena_allocator<T>& a, const arena_allocator<U>& b)
+    {
+        return !(a == b);
+    }
+
+    // Variants of vector4 and matrix4 aligned to their size, at most to a
+    // cache line, so that SIMD loads of them never split a cache line.
+    // They convert to and from the plain types and work with all of the
+    // functions; arrays of them on the heap need an aligned_allocator.
+    template <typename T>
+    class alignas(sizeof(T) * 4) aligned_vector4 : public vector4<T>
+    {
+    public:
+        using vector4<T>::vector4;
+
+        constexpr aligned_vector4() {}
+    };
+
+    template <typename T>
+    class alignas(sizeof(T) * 16 < 64 ? sizeof(T) * 16 : 64) aligned_matrix4 : public matrix4<T>
+    {
+    public:
+        using matrix4<T>::matrix4;
+
+        constexpr aligned_matrix4() {}
+    };
+
+    typedef aligned_vector4<float>  avec4;
+    typedef aligned_vector4<double> advec4;
+    typedef aligned_matrix4<float>  amat4;
+    typedef aligned_matrix4<double> admat4;
+}
+
+#endif
@@ -0,0 +1,457 @@
+/*
+    rgm - Rioki's Graphic Math Library
+
+    Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+#ifndef _RGM_PACKING_H_
+#define _RGM_PACKING_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "simd.h"
+#include "vector.h"
+#include "quaternion.h"
+
+namespace rgm
+{
+namespace simd
+{
+    // IEEE 754 binary16 conversion, rounding to nearest even. The portable
+    // versions give the same results as F16C, except that all NaNs become
+    // the same quiet NaN (F. Giesen, "Half to float done quic").
+    inline uint16_t to_half_bits(float v)
+    {
+#ifdef RGM_F16C
+        return static_cast<uint16_t>(_mm_cvtsi128_si32(_mm_cvtps_ph(_mm_set_ss(v), _MM_FROUND_TO_NEAREST_INT)));
+#else
+        uint32_t u;
+        std::memcpy(&u, &v, sizeof(u));
+        uint32_t sign = u & 0x80000000u;
+        u ^= sign;
+
+        uint32_t r;
+        if (u >= 0x47800000u)
+        {
+            // at least 2^16, infinity or NaN
+            r = u > 0x7f800000u ? 0x7e00 : 0x7c00;
+        }
+        else if (u < 0x38800000u)
+        {
+            // below 2^-14, subnormal or zero; the addition does the rounding
+            const uint32_t magic = 0x3f000000u;
+            float m;
+            std::memcpy(&m, &magic, sizeof(m));
+            float f;
+            std::memcpy(&f, &u, sizeof(f));
+            f += m;
+            std::memcpy(&r, &f, sizeof(r));
+            r -= magic;
+        }
+        else
+        {
+            uint32_t odd = (u >> 13) & 1;
+            u += 0xc8000fffu + odd;
+            r = u >> 13;
+        }
+        return static_cast<uint16_t>(r | (sign >> 16));
+#endif
+    }
+
+    inline float from_half_bits(uint16_t h)
+    {
+#ifdef RGM_F16C
+        return _mm_cvtss_f32(_mm_cvtph_ps(_mm_cvtsi32_si128(h)));
+#else
+        uint32_t u   = static_cast<uint32_t>(h & 0x7fff) << 13;
+        uint32_t exp = u & 0x0f800000u;
+        u += 0x38000000u;
+        if (exp == 0x0f800000u)
+        {
+            // infinity or NaN
+            u += 0x38000000u;
+        }
+        else if (exp == 0)
+        {
+            // subnormal or zero, renormalized by the subtraction
+            const uint32_t magic = 0x38800000u;
+            float m;
+            std::memcpy(&m, &magic, sizeof(m));
+            u += 0x00800000u;
+            float f;
+            std::memcpy(&f, &u, sizeof(f));
+            f -= m;
+            std::memcpy(&u, &f, sizeof(u));
+        }
+        u |= static_cast<uint32_t>(h & 0x8000) << 16;
+        float r;
+        std::memcpy(&r, &u, sizeof(r));
+        return r;
+#endif
+    }
+
+    // Converts count floats, 8 at a time with F16C.
+    inline void to_half_bits(const float* in, uint16_t* out, size_t count)
+    {
+        size_t i = 0;
+#ifdef RGM_F16C
+        for (; i + 8 <= count; i += 8)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT));
+        }
+#endif
+        for (; i < count; i++)
+        {
+            out[i] = to_half_bits(in[i]);
+        }
+    }
+
+    inline void from_half_bits(const uint16_t* in, float* out, size_t count)
+    {
+        size_t i = 0;
+#ifdef RGM_F16C
+        for (; i + 8 <= count; i += 8)
+        {
+            _mm256_storeu_ps(out + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i))));
+        }
+#endif
+        for (; i < count; i++)
+        {
+            out[i] = from_half_bits(in[i]);
+        }
+    }
+}
+
+    // Half precision float for storage; the arithmetic is done in float.
+    // It has 11 significant bits and a range of 6.1e-5 to 65504, below
+    // that it is subnormal down to 6e-8. Larger values become infinity.
+    class half
+    {
+    public:
+
+        half()
+        : bits(0) {}
+
+        explicit half(float v)
+        : bits(simd::to_half_bits(v)) {}
+
+        operator float () const
+        {
+            return simd::from_half_bits(bits);
+        }
+
+        static half from_bits(uint16_t b)
+        {
+            half h;
+            h.bits = b;
+            return h;
+        }
+
+        uint16_t to_bits() const
+        {
+            return bits;
+        }
+
+    private:
+        uint16_t bits;
+    };
+
+    static_assert(sizeof(half) == 2, "half must be 16 bits");
+
+    // Vector of halfs, half the size of the float vector.
+    template <unsigned int N>
+    class half_vector
+    {
+    public:
+
+        half_vector() {}
+
+        explicit half_vector(const vector<float, N>& v)
+        {
+            for (unsigned int i = 0; i < N; i++)
+            {
+                data[i] = half(v[i]);
+            }
+        }
+
+        vector<float, N> unpack() const
+        {
+            vector<float, N> r;
+            for (unsigned int i = 0; i < N; i++)
+            {
+                r[i] = data[i];
+            }
+            return r;
+        }
+
+        half& operator [] (unsigned int i)
+        {
+            assert(i < N);
+            return data[i];
+        }
+
+        half operator [] (unsigned int i) const
+        {
+            assert(i < N);
+            return data[i];
+        }
+
+    private:
+        half data[N];
+    };
+
+    typedef half_vector<2> hvec2;
+    typedef half_vector<3> hvec3;
+    typedef half_vector<4> hvec4;
+
+    // Octahedral encoding of unit vectors: the vector is projected onto
+    // the octahedron |x| + |y| + |z| = 1, the lower half is folded over
+    // the upper one and the resulting square [-1, 1]^2 is quantized.
+    // The error is nearly uniform over the sphere; in the worst case it
+    // is 0.004 degrees with oct_snorm16 and 1 degree with oct_unorm8.
+    namespace detail
+    {
+        // Rounds half away from zero like std::lround, which is a library
+        // call unless math errno is disabled.
+        inline int round_int(float x)
+        {
+            return static_cast<int>(x < 0 ? x - 0.5f : x + 0.5f);
+        }
+
+        // the components other than the largest, for quat48
+        static const unsigned char quat48_others[4][3] = { { 1, 2, 3 }, { 0, 2, 3 }, { 0, 1, 3 }, { 0, 1, 2 } };
+
+        inline void oct_encode(const vector<float, 3>& n, float& u, float& v)
+        {
+            float s = 1.0f / (std::abs(n[0]) + std::abs(n[1]) + std::abs(n[2]));
+            float x = n[0] * s;
+            float y = n[1] * s;
+            if (n[2] < 0)
+            {
+                float fx = 1.0f - std::abs(y);
+                float fy = 1.0f - std::abs(x);
+                x = x < 0 ? -fx : fx;
+                y = y < 0 ? -fy : fy;
+            }
+            u = x;
+            v = y;
+        }
+
+        inline vector<float, 3> oct_decode(float u, float v)
+        {
+            float z = 1.0f - std::abs(u) - std::abs(v);
+            float t = std::max(-z, 0.0f);
+            float x = u < 0 ? u + t : u - t;
+            float y = v < 0 ? v + t : v - t;
+            float s = 1.0f / std::sqrt(x * x + y * y + z * z);
+            return vector3<float>(x * s, y * s, z * s);
+        }
+    }
+
+    // Unit vector in 32 bits, 16 per coordinate.
+    class oct_snorm16
+    {
+    public:
+
+        oct_snorm16()
+        : u(0), v(0) {}
+
+        explicit oct_snorm16(const vector<float, 3>& n)
+        {
+            float x, y;
+            detail::oct_encode(n, x, y);
+            u = static_cast<int16_t>(detail::round_int(x * 32767.0f));
+            v = static_cast<int16_t>(detail::round_int(y * 32767.0f));
+        }
+
+        vector<float, 3> unpack() const
+        {
+            return detail::oct_decode(u * (1.0f / 32767.0f), v * (1.0f / 32767.0f));
+        }
+
+    private:
+        int16_t u;
+        int16_t v;
+    };
+
+    // Unit vector in 16 bits, 8 per coordinate.
+    class oct_unorm8
+    {
+    public:
+
+        oct_unorm8()
+        : u(0), v(0) {}
+
+        explicit oct_unorm8(const vector<float, 3>& n)
+        {
+            float x, y;
+            detail::oct_encode(n, x, y);
+            u = static_cast<uint8_t>(detail::round_int((x + 1.0f) * 127.5f));
+            v = static_cast<uint8_t>(detail::round_int((y + 1.0f) * 127.5f));
+        }
+
+        vector<float, 3> unpack() const
+        {
+            return detail::oct_decode(u * (2.0f / 255.0f) - 1.0f, v * (2.0f / 255.0f) - 1.0f);
+        }
+
+    private:
+        uint8_t u;
+        uint8_t v;
+    };
+
+    // Unit quaternion in 48 bits ("smallest three"): the index of the
+    // largest component in 2 bits and the other three in 15 bits each.
+    // These lie in [-1/sqrt(2), 1/sqrt(2)], the largest is restored from
+    // the unit length. Since q and -q are the same rotation, the largest
+    // component is stored as positive. The three are off by at most
+    // 2.2e-5; with the error this causes in the largest, the components
+    // of the unpacked quaternion are within 6e-5.
+    class quat48
+    {
+    public:
+
+        quat48()
+        : data() {}
+
+        explicit quat48(const quaterion<float>& q)
+        {
+            float        a[4] = { std::abs(q[0]), std::abs(q[1]), std::abs(q[2]), std::abs(q[3]) };
+            unsigned int l01  = a[1] > a[0] ? 1 : 0;
+            unsigned int l23  = a[3] > a[2] ? 3 : 2;
+            unsigned int l    = a[l23] > a[l01] ? l23 : l01;
+
+            const unsigned char* o = detail::quat48_others[l];
+            float s = q[l] < 0 ? -SCALE : SCALE;
+            uint64_t bits = l
+                | static_cast<uint64_t>(quantize(q[o[0]] * s)) << 2
+                | static_cast<uint64_t>(quantize(q[o[1]] * s)) << 17
+                | static_cast<uint64_t>(quantize(q[o[2]] * s)) << 32;
+            data[0] = static_cast<uint16_t>(bits);
+            data[1] = static_cast<uint16_t>(bits >> 16);
+            data[2] = static_cast<uint16_t>(bits >> 32);
+        }
+
+        quaterion<float> unpack() const
+        {
+            uint64_t     bits = data[0] | static_cast<uint64_t>(data[1]) << 16 | static_cast<uint64_t>(data[2]) << 32;
+            unsigned int l    = bits & 3;
+            float        x    = dequantize(bits >> 2);
+            float        y    = dequantize(bits >> 17);
+            float        z    = dequantize(bits >> 32);
+
+            const unsigned char* o = detail::quat48_others[l];
+            float c[4];
+            c[o[0]] = x;
+            c[o[1]] = y;
+            c[o[2]] = z;
+            c[l]    = std::sqrt(std::max(1.0f - x * x - y * y - z * z, 0.0f));
+            return quaterion<float>(c[0], c[1], c[2], c[3]);
+        }
+
+    private:
+        // maps [-1/sqrt(2), 1/sqrt(2)] to [-0.5, 0.5]
+        static constexpr float SCALE = 0.70710678f;
+        static constexpr float MAX   = 32767.0f;
+
+        static unsigned int quantize(float c)
+        {
+            return static_cast<unsigned int>(std::min(std::max(c + 0.5f, 0.0f), 1.0f) * MAX + 0.5f);
+        }
+
+        static float dequantize(uint64_t bits)
+        {
+            return ((bits & 0x7fff) * (1.0f / MAX) - 0.5f) * (1.0f / SCALE);
+        }
+
+        uint16_t data[3];
+    };
+
+    static_assert(sizeof(quat48) == 6, "quat48 must be 48 bits");
+
+    // Batch conversion of arrays, e.g. of vertex or animation data; in
+    // and out must not overlap. The halfs use F16C if it is enabled.
+    template <unsigned int N>
+    void pack(const vector<float, N>* in, half_vector<N>* out, size_t count)
+    {
+        static_assert(sizeof(half_vector<N>) == N * 2, "half_vector must not be padded");
+        if (count != 0)
+        {
+            simd::to_half_bits(in[0].c_array(), reinterpret_cast<uint16_t*>(out), N * count);
+        }
+    }
+
+    template <unsigned int N>
+    void unpack(const half_vector<N>* in, vector<float, N>* out, size_t count)
+    {
+        if (count != 0)
+        {
+            simd::from_half_bits(reinterpret_cast<const uint16_t*>(in), &out[0][0], N * count);
+        }
+    }
+
+    inline void pack(const float* in, half* out, size_t count)
+    {
+        simd::to_half_bits(in, reinterpret_cast<uint16_t*>(out), count);
+    }
+
+    inline void unpack(const half* in, float* out, size_t count)
+    {
+        simd::from_half_bits(reinterpret_cast<const uint16_t*>(in), out, count);
+    }
+
+    inline void pack(const vector<float, 3>* in, oct_snorm16* out, size_t count)
+    {
+        std::transform(in, in + count, out, [] (const vector<float, 3>& n) { return oct_snorm16(n); });
+    }
+
+    inline void unpack(const oct_snorm16* in, vector<float, 3>* out, size_t count)
+    {
+        std::transform(in, in + count, out, [] (const oct_snorm16& p) { return p.unpack(); });
+    }
+
+    inline void pack(const vector<float, 3>* in, oct_unorm8* out, size_t count)
+    {
+        std::transform(in, in + count, out, [] (const vector<float, 3>& n) { return oct_unorm8(n); });
+    }
+
+    inline void unpack(const oct_unorm8* in, vector<float, 3>* out, size_t count)
+    {
+        std::transform(in, in + count, out, [] (const oct_unorm8& p) { return p.unpack(); });
+    }
+
+    inline void pack(const quaterion<float>* in, quat48* out, size_t count)
+    {
+        std::transform(in, in + count, out, [] (const quaterion<float>& q) { return quat48(q); });
+    }
+
+    inline void unpack(const quat48* in, quaterion<float>* out, size_t count)
+    {
+        std::transform(in, in + count, out, [] (const quat48& p) { return p.unpack(); });
+    }
+}
+
+#endif
@@ -0,0 +1,338 @@
+/*
+    rgm - Rioki's Graphic Math Library
+
+    Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+#ifndef _RGM_PARALLEL_H_
+#define _RGM_PARALLEL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "memory.h"
+
+namespace rgm
+{
+    // Fixed set of worker threads for the batch functions. The calling
+    // thread takes part in the work, so a pool with 0 workers runs
+    // everything on the caller.
+    //
+    // The tasks of a job are split into one contiguous slice per thread.
+    // Each thread works through its own slice in order, which keeps
+    // neighbouring chunks of an array on one core and the threads off each
+    // other's counters, and then steals the remaining tasks of the other
+    // slices, so that uneven tasks or a descheduled thread do not hold up
+    // the job.
+    //
+    // A pool runs one job at a time: when several threads call run, the
+    // jobs take turns. A task that calls run on the pool it belongs to runs
+    // the inner tasks itself, on its own thread, since the other threads
+    // are busy with the outer job anyway.
+    class thread_pool
+    {
+    public:
+
+        thread_pool()
+        {
+            unsigned int n = std::thread::hardware_concurrency();
+            start(n > 1 ? n - 1 : 0);
+        }
+
+        explicit thread_pool(unsigned int workers)
+        {
+            start(workers);
+        }
+
+        ~thread_pool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stop = true;
+            }
+            wake.notify_all();
+            for (size_t i = 0; i < threads.size(); i++)
+            {
+                threads[i].join();
+            }
+        }
+
+        // Number of threads working on a job, including the caller.
+        unsigned int size() const
+        {
+            return static_cast<unsigned int>(threads.size()) + 1;
+        }
+
+        // Calls task(i) for every i in [0, count) and returns when all
+        // calls are done. The first exception thrown by a task is rethrown
+        // here, after the remaining tasks ran.
+        void run(size_t count, const std::function<void (size_t)>& task)
+        {
+            if (current() == this)
+            {
+                run_inline(count, task);
+                return;
+            }
+
+            std::lock_guard<std::mutex> turn(submit);
+            std::unique_lock<std::mutex> lock(mutex);
+            size_t n = size();
+            for (size_t p = 0; p < n; p++)
+            {
+                slices[p].next = count * p / n;
+                slices[p].end  = count * (p + 1) / n;
+            }
+            job       = &task;
+            error     = nullptr;
+            generation++;
+            lock.unlock();
+            wake.notify_all();
+
+            const thread_pool* outer = current();
+            current() = this;
+            work(task, 0);
+            current() = outer;
+
+            lock.lock();
+            done.wait(lock, [this] () { return active == 0; });
+            job = nullptr;
+            std::exception_ptr e = error;
+            error = nullptr;
+            lock.unlock();
+
+            if (e)
+            {
+                std::rethrow_exception(e);
+            }
+        }
+
+    private:
+        // The next task and the end of the slice of a thread, aligned so
+        // that the counters of two threads never share a cache line.
+        struct alignas(64) slice
+        {
+            std::atomic<size_t> next;
+            size_t              end;
+        };
+
+        // new[] ignores the alignment of slice before C++17
+        typedef std::vector<slice, aligned_allocator<slice>> slice_array;
+
+        std::vector<std::thread>                 threads;
+        slice_array                              slices;
+        std::mutex                               submit;
+        std::mutex                               mutex;
+        std::condition_variable                  wake;
+        std::condition_variable                  done;
+        const std::function<void (size_t)>*      job        = nullptr;
+        unsigned int                             generation = 0;
+        unsigned int                             active     = 0;
+        std::exception_ptr                       error;
+        bool                                     stop       = false;
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator = (const thread_pool&) = delete;
+
+        // The pool whose job the calling thread is working on, if any.
+        static const thread_pool*& current()
+        {
+            static thread_local const thread_pool* pool = nullptr;
+            return pool;
+        }
+
+        void run_inline(size_t count, const std::function<void (size_t)>& task)
+        {
+            std::exception_ptr e;
+            for (size_t i = 0; i < count; i++)
+            {
+                try
+                {
+                    task(i);
+                }
+                catch (...)
+                {
+                    if (!e)
+                    {
+                        e = std::current_exception();
+                    }
+                }
+            }
+            if (e)
+            {
+                std::rethrow_exception(e);
+            }
+        }
+
+        void start(unsigned int workers)
+        {
+            // swapped in, since the atomics can not be moved
+            slice_array s(workers + 1);
+            slices.swap(s);
+            for (unsigned int i = 0; i <= workers; i++)
+            {
+                slices[i].next = 0;
+                slices[i].end  = 0;
+            }
+            for (unsigned int i = 0; i < workers; i++)
+            {
+                threads.push_back(std::thread([this, i] () { loop(i + 1); }));
+            }
+        }
+
+        // Runs the tasks of slice p, then those left in the other slices.
+        void work(const std::function<void (size_t)>& task, unsigned int p)
+        {
+            unsigned int n = size();
+            for (unsigned int k = 0; k < n; k++)
+            {
+                slice& s = slices[(p + k) % n];
+                for (size_t i = s.next++; i < s.end; i = s.next++)
+                {
+                    try
+                    {
+                        task(i);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if (!error)
+                        {
+                            error = std::current_exception();
+                        }
+                    }
+                }
+            }
+        }
+
+        void loop(unsigned int p)
+        {
+            current() = this;
+            unsigned int seen = 0;
+            std::unique_lock<std::mutex> lock(mutex);
+            for (;;)
+            {
+                wake.wait(lock, [&] () { return stop || generation != seen; });
+                if (stop)
+                {
+                    return;
+                }
+                seen = generation;
+                if (job == nullptr)
+                {
+                    continue;
+                }
+
+                const std::function<void (size_t)>& task = *job;
+                active++;
+                lock.unlock();
+
+                work(task, p);
+
+                lock.lock();
+                active--;
+                if (active == 0)
+                {
+                    done.notify_all();
+                }
+            }
+        }
+    };
+
+    // Shared pool with a worker per core besides the caller, created on
+    // first use, for code that does not manage its own. Calls from several
+    // threads take turns and calls from within its tasks run on the
+    // calling thread, like with any other pool.
+    inline thread_pool& default_thread_pool()
+    {
+        static thread_pool pool;
+        return pool;
+    }
+
+    // Calls fn(b, e) on consecutive chunks [b, e) of [begin, end) with at
+    // most grain elements each, spread over the threads of the pool. The
+    // chunks only depend on the range and the grain, not on the pool or
+    // on timing, so results computed per chunk are the same for any number
+    // of threads.
+    template <typename F>
+    void parallel_for(thread_pool& pool, size_t begin, size_t end, size_t grain, F fn)
+    {
+        if (end <= begin)
+        {
+            return;
+        }
+        grain = std::max<size_t>(grain, 1);
+        size_t chunks = (end - begin + grain - 1) / grain;
+        if (chunks == 1 || pool.size() == 1)
+        {
+            // the same chunks as on more threads
+            for (size_t c = 0; c < chunks; c++)
+            {
+                size_t b = begin + c * grain;
+                fn(b, std::min(b + grain, end));
+            }
+            return;
+        }
+        pool.run(chunks, [&] (size_t c) {
+            size_t b = begin + c * grain;
+            fn(b, std::min(b + grain, end));
+        });
+    }
+
+    template <typename F>
+    void parallel_for(size_t begin, size_t end, size_t grain, F fn)
+    {
+        parallel_for(default_thread_pool(), begin, end, grain, fn);
+    }
+
+    // Reduces [begin, end) in chunks of grain elements: fn(b, e) returns
+    // the result of a chunk and the results are combined in chunk order,
+    // starting with init, as combine(combine(init, r0), r1) and so on.
+    // Since the chunks and the order are fixed, floating point sums come
+    // out the same, to the bit, for any number of threads.
+    template <typename R, typename F, typename C>
+    R parallel_reduce(thread_pool& pool, size_t begin, size_t end, size_t grain, R init, F fn, C combine)
+    {
+        if (end <= begin)
+        {
+            return init;
+        }
+        grain = std::max<size_t>(grain, 1);
+        std::vector<R> partial((end - begin + grain - 1) / grain, init);
+        parallel_for(pool, begin, end, grain, [&] (size_t b, size_t e) {
+            partial[(b - begin) / grain] = fn(b, e);
+        });
+        R r = init;
+        for (size_t c = 0; c < partial.size(); c++)
+        {
+            r = combine(r, partial[c]);
+        }
+        return r;
+    }
+}
+
+#endif
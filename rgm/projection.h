@@ -0,0 +1,540 @@
+/*
+    rgm - Rioki's Graphic Math Library
+
+    Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+#ifndef _RGM_PROJECTION_H_
+#define _RGM_PROJECTION_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "simd.h"
+#include "vector.h"
+#include "matrix.h"
+#include "stream.h"
+#include "ray.h"
+#include "parallel.h"
+
+namespace rgm
+{
+    namespace simd
+    {
+        // Clip flags of a point in clip space, see projector. Each test is
+        // the sign bit of a difference, the same as in the kernels below.
+        template <typename T>
+        unsigned int clip_flags(T x, T y, T z, T w)
+        {
+            return signmask(x + w)      | signmask(y + w) << 1 | signmask(z + w) << 2 |
+                   signmask(w - x) << 3 | signmask(w - y) << 4 | signmask(w - z) << 5 |
+                   signmask(w) << 6;
+        }
+
+        // Projects count points with the clip matrix m and maps x, y and z
+        // from [-1, 1] to offset + scale * v after the division by w. flags
+        // may be 0; in and out may be the same array.
+        template <typename T>
+        void project_points(const matrix<T, 4>& m, const vector<T, 3>& scale, const vector<T, 3>& offset,
+                            const vector<T, 3>* in, vector<T, 3>* out, unsigned int* flags, size_t count)
+        {
+            const T* a = m.c_array();
+            for (size_t i = 0; i < count; i++)
+            {
+                T x = in[i][0];
+                T y = in[i][1];
+                T z = in[i][2];
+                T cx = a[0] * x + a[4] * y + a[8]  * z + a[12];
+                T cy = a[1] * x + a[5] * y + a[9]  * z + a[13];
+                T cz = a[2] * x + a[6] * y + a[10] * z + a[14];
+                T cw = a[3] * x + a[7] * y + a[11] * z + a[15];
+                T iw = 1 / cw;
+                out[i][0] = cx * iw * scale[0] + offset[0];
+                out[i][1] = cy * iw * scale[1] + offset[1];
+                out[i][2] = cz * iw * scale[2] + offset[2];
+                if (flags != 0)
+                {
+                    flags[i] = clip_flags(cx, cy, cz, cw);
+                }
+            }
+        }
+
+#ifdef RGM_SSE2
+        // One point per register like transform_stride; x + w and w - x
+        // of all lanes give the flags of the low and high planes at once
+        // and lane 3 of x + w, 2w, the sign of w.
+        template <typename T>
+        void project_points_packed(const matrix<T, 4>& m, const vector<T, 3>& scale, const vector<T, 3>& offset,
+                                   const vector<T, 3>* in, vector<T, 3>* out, unsigned int* flags, size_t count)
+        {
+            typedef packed<T, 4> S4;
+            typedef packed<T, 3> S3;
+            typedef typename S4::type P;
+
+            const T* a = m.c_array();
+            P c0 = S4::load(a);
+            P c1 = S4::load(a + 4);
+            P c2 = S4::load(a + 8);
+            P c3 = S4::load(a + 12);
+            P s  = S3::load(scale.c_array());
+            P o  = S3::load(offset.c_array());
+            for (size_t i = 0; i < count; i++)
+            {
+                const T* p = in[i].c_array();
+                P r = madd(c0, S4::splat(p[0]), madd(c1, S4::splat(p[1]), madd(c2, S4::splat(p[2]), c3)));
+
+                T v[4];
+                S4::store(v, r);
+                P w = S4::splat(v[3]);
+                S3::store(&out[i][0], madd(div(r, w), s, o));
+                if (flags != 0)
+                {
+                    unsigned int lo = signmask(add(r, w));
+                    unsigned int hi = signmask(sub(w, r));
+                    flags[i] = (lo & 7) | (hi & 7) << 3 | (lo & 8) << 3;
+                }
+            }
+        }
+
+        inline void project_points(const matrix<float, 4>& m, const vector<float, 3>& scale, const vector<float, 3>& offset,
+                                   const vector<float, 3>* in, vector<float, 3>* out, unsigned int* flags, size_t count)
+        {
+            project_points_packed(m, scale, offset, in, out, flags, count);
+        }
+
+        inline void project_points(const matrix<double, 4>& m, const vector<double, 3>& scale, const vector<double, 3>& offset,
+                                   const vector<double, 3>* in, vector<double, 3>* out, unsigned int* flags, size_t count)
+        {
+            project_points_packed(m, scale, offset, in, out, flags, count);
+        }
+#endif
+
+        // Moves bit j of a mask of up to 8 bits to bit 0 of byte j, so that
+        // the signmask of each test can be added to the flags of all lanes
+        // with one shift.
+        inline const uint64_t* spread_bits()
+        {
+            struct table
+            {
+                uint64_t v[256];
+
+                table()
+                {
+                    for (unsigned int m = 0; m < 256; m++)
+                    {
+                        v[m] = 0;
+                        for (unsigned int j = 0; j < 8; j++)
+                        {
+                            v[m] |= static_cast<uint64_t>((m >> j) & 1) << (8 * j);
+                        }
+                    }
+                }
+            };
+            static const table t;
+            return t.v;
+        }
+
+        // Structure of arrays version, batch<T>::size points at a time.
+        template <typename T>
+        void project_points(const matrix<T, 4>& m, const vector<T, 3>& scale, const vector<T, 3>& offset,
+                            const vector_stream<T, 3>& in, vector_stream<T, 3>& out, unsigned int* flags)
+        {
+            typedef batch<T> B;
+            typedef typename B::type P;
+            static_assert(B::size <= 8, "spread_bits handles up to 8 lanes");
+
+            size_t count = in.size();
+            out.resize(count);
+            const T* px = in.lane(0);
+            const T* py = in.lane(1);
+            const T* pz = in.lane(2);
+            T*       rx = out.lane(0);
+            T*       ry = out.lane(1);
+            T*       rz = out.lane(2);
+
+            const T* a = m.c_array();
+            P a0  = B::splat(a[0]);
+            P a1  = B::splat(a[1]);
+            P a2  = B::splat(a[2]);
+            P a3  = B::splat(a[3]);
+            P a4  = B::splat(a[4]);
+            P a5  = B::splat(a[5]);
+            P a6  = B::splat(a[6]);
+            P a7  = B::splat(a[7]);
+            P a8  = B::splat(a[8]);
+            P a9  = B::splat(a[9]);
+            P a10 = B::splat(a[10]);
+            P a11 = B::splat(a[11]);
+            P a12 = B::splat(a[12]);
+            P a13 = B::splat(a[13]);
+            P a14 = B::splat(a[14]);
+            P a15 = B::splat(a[15]);
+            P sx  = B::splat(scale[0]);
+            P sy  = B::splat(scale[1]);
+            P sz  = B::splat(scale[2]);
+            P ox  = B::splat(offset[0]);
+            P oy  = B::splat(offset[1]);
+            P oz  = B::splat(offset[2]);
+            P one = B::splat(1);
+
+            const uint64_t* spread = spread_bits();
+            for (size_t i = 0; i < out.padded_size(); i += B::size)
+            {
+                P x  = B::load(px + i);
+                P y  = B::load(py + i);
+                P z  = B::load(pz + i);
+                P cx = madd(a0, x, madd(a4, y, madd(a8,  z, a12)));
+                P cy = madd(a1, x, madd(a5, y, madd(a9,  z, a13)));
+                P cz = madd(a2, x, madd(a6, y, madd(a10, z, a14)));
+                P cw = madd(a3, x, madd(a7, y, madd(a11, z, a15)));
+                P iw = div(one, cw);
+                B::store(rx + i, madd(mul(cx, iw), sx, ox));
+                B::store(ry + i, madd(mul(cy, iw), sy, oy));
+                B::store(rz + i, madd(mul(cz, iw), sz, oz));
+
+                if (flags != 0)
+                {
+                    uint64_t f = spread[signmask(add(cx, cw))]      | spread[signmask(add(cy, cw))] << 1 |
+                                 spread[signmask(add(cz, cw))] << 2 | spread[signmask(sub(cw, cx))] << 3 |
+                                 spread[signmask(sub(cw, cy))] << 4 | spread[signmask(sub(cw, cz))] << 5 |
+                                 spread[signmask(cw)] << 6;
+                    for (unsigned int j = 0; j < B::size && i + j < count; j++)
+                    {
+                        flags[i + j] = static_cast<unsigned int>(f >> (8 * j)) & 0xff;
+                    }
+                }
+            }
+        }
+    }
+
+    // Projects points from object or world space to window coordinates,
+    // like project(), with the view-projection matrix and the viewport
+    // mapping computed once. The window coordinates are
+    // (x + w (x' + 1) / 2, y + h (y' + 1) / 2, (z' + 1) / 2) for the
+    // viewport (x, y, w, h) and the normalized device coordinates x', y'
+    // and z', i.e. the clip coordinates divided by their w.
+    //
+    // The clip flags tell which planes of the view volume a point is
+    // outside of, -w <= x, y, z <= w in clip space, plus CLIP_BEHIND if it
+    // is behind the camera (w < 0). The window coordinates of points
+    // behind the camera are not meaningful, and with w < 0 they are also
+    // outside both planes of a pair if |x| < |w|. A point is in the view
+    // volume if its flags are 0.
+    template <typename T>
+    class projector
+    {
+    public:
+        static const unsigned int CLIP_LEFT   = 1;
+        static const unsigned int CLIP_BOTTOM = 2;
+        static const unsigned int CLIP_NEAR   = 4;
+        static const unsigned int CLIP_RIGHT  = 8;
+        static const unsigned int CLIP_TOP    = 16;
+        static const unsigned int CLIP_FAR    = 32;
+        static const unsigned int CLIP_BEHIND = 64;
+
+        projector() {}
+
+        projector(const matrix<T, 4>& projection, const matrix<T, 4>& modelview, const vector<T, 4>& viewport)
+        {
+            set(projection * modelview, viewport);
+        }
+
+        projector(const matrix<T, 4>& viewprojection, const vector<T, 4>& viewport)
+        {
+            set(viewprojection, viewport);
+        }
+
+        const matrix<T, 4>& viewprojection() const
+        {
+            return clip;
+        }
+
+        const vector<T, 4>& viewport() const
+        {
+            return window;
+        }
+
+        vector<T, 3> project(const vector<T, 3>& point) const
+        {
+            vector<T, 3> r;
+            simd::project_points(clip, window_scale, window_offset, &point, &r, 0, 1);
+            return r;
+        }
+
+        unsigned int clip_flags(const vector<T, 3>& point) const
+        {
+            vector<T, 3>  r;
+            unsigned int f;
+            simd::project_points(clip, window_scale, window_offset, &point, &r, &f, 1);
+            return f;
+        }
+
+        // Batch versions; in and out may be the same array or stream. The
+        // flags of point i are written to flags[i].
+        void project_points(const vector<T, 3>* in, vector<T, 3>* out, size_t count) const
+        {
+            simd::project_points(clip, window_scale, window_offset, in, out, 0, count);
+        }
+
+        void project_points(const vector<T, 3>* in, vector<T, 3>* out, unsigned int* flags, size_t count) const
+        {
+            simd::project_points(clip, window_scale, window_offset, in, out, flags, count);
+        }
+
+        void project_points(const vector_stream<T, 3>& in, vector_stream<T, 3>& out) const
+        {
+            simd::project_points(clip, window_scale, window_offset, in, out, 0);
+        }
+
+        void project_points(const vector_stream<T, 3>& in, vector_stream<T, 3>& out, std::vector<unsigned int>& flags) const
+        {
+            flags.resize(in.size());
+            simd::project_points(clip, window_scale, window_offset, in, out, flags.empty() ? 0 : &flags[0]);
+        }
+
+    private:
+        matrix<T, 4> clip;
+        vector<T, 4> window;
+        vector<T, 3> window_scale;
+        vector<T, 3> window_offset;
+
+        void set(const matrix<T, 4>& viewprojection, const vector<T, 4>& viewport)
+        {
+            clip          = viewprojection;
+            window        = viewport;
+            window_scale  = vector3<T>(viewport[2] / 2, viewport[3] / 2, T(0.5));
+            window_offset = vector3<T>(viewport[0] + viewport[2] / 2, viewport[1] + viewport[3] / 2, T(0.5));
+        }
+    };
+
+    template <typename T> const unsigned int projector<T>::CLIP_LEFT;
+    template <typename T> const unsigned int projector<T>::CLIP_BOTTOM;
+    template <typename T> const unsigned int projector<T>::CLIP_NEAR;
+    template <typename T> const unsigned int projector<T>::CLIP_RIGHT;
+    template <typename T> const unsigned int projector<T>::CLIP_TOP;
+    template <typename T> const unsigned int projector<T>::CLIP_FAR;
+    template <typename T> const unsigned int projector<T>::CLIP_BEHIND;
+
+    namespace simd
+    {
+        // Rays through the window positions (x + i, y) for i in [0, count),
+        // with inverse the inverse view-projection matrix. Every
+        // batch<T>::size rays are passed to sink(i, n, o, d), where o[k] and
+        // d[k] hold component k of the origins and directions of the rays
+        // i to i + n. The points on the near and far plane are linear in i
+        // before the division by w, so they are stepped along the row.
+        template <typename T, typename F>
+        void unproject_row(const matrix<T, 4>& inverse, const vector<T, 4>& viewport, T x, T y, size_t count, F sink)
+        {
+            typedef batch<T> B;
+            typedef typename B::type P;
+
+            const T* a  = inverse.c_array();
+            T        nx = 2 * (x - viewport[0]) / viewport[2] - 1;
+            T        ny = 2 * (y - viewport[1]) / viewport[3] - 1;
+            T        dx = 2 / viewport[2];
+
+            // near and far points at i = 0, z = -1 and z = 1
+            T base[4];
+            T step[4];
+            for (unsigned int k = 0; k < 4; k++)
+            {
+                base[k] = a[k] * nx + a[4 + k] * ny + a[12 + k];
+                step[k] = a[k] * dx;
+            }
+            P n0[4];
+            P f0[4];
+            P st[4];
+            for (unsigned int k = 0; k < 4; k++)
+            {
+                n0[k] = B::splat(base[k] - a[8 + k]);
+                f0[k] = B::splat(base[k] + a[8 + k]);
+                st[k] = B::splat(step[k]);
+            }
+
+            alignas(32) T lanes[B::size];
+            for (unsigned int j = 0; j < B::size; j++)
+            {
+                lanes[j] = T(j);
+            }
+            P index = B::load(lanes);
+            P width = B::splat(T(B::size));
+            P one   = B::splat(1);
+
+            alignas(32) T o[3][B::size];
+            alignas(32) T d[3][B::size];
+            for (size_t i = 0; i < count; i += B::size)
+            {
+                P inw = div(one, madd(st[3], index, n0[3]));
+                P ifw = div(one, madd(st[3], index, f0[3]));
+                P on[3];
+                P dn[3];
+                for (unsigned int k = 0; k < 3; k++)
+                {
+                    on[k] = mul(madd(st[k], index, n0[k]), inw);
+                    dn[k] = sub(mul(madd(st[k], index, f0[k]), ifw), on[k]);
+                }
+                P il = div(one, sqrt(madd(dn[2], dn[2], madd(dn[1], dn[1], mul(dn[0], dn[0])))));
+                for (unsigned int k = 0; k < 3; k++)
+                {
+                    B::store(o[k], on[k]);
+                    B::store(d[k], mul(dn[k], il));
+                }
+                sink(i, std::min<size_t>(B::size, count - i), o, d);
+                index = add(index, width);
+            }
+        }
+    }
+
+    // Maps window coordinates back to object or world space, like
+    // unproject(), with the inverse view-projection matrix computed once,
+    // and generates rays through pixels, e.g. for picking or to shoot a
+    // ray per pixel of an image. The rays start on the near plane and
+    // pass through the point on the far plane at the same window position;
+    // their direction is of unit length.
+    template <typename T>
+    class unprojector
+    {
+    public:
+        unprojector() {}
+
+        unprojector(const matrix<T, 4>& projection, const matrix<T, 4>& modelview, const vector<T, 4>& viewport)
+        : inverse_matrix(inv(projection * modelview)), window(viewport) {}
+
+        unprojector(const matrix<T, 4>& viewprojection, const vector<T, 4>& viewport)
+        : inverse_matrix(inv(viewprojection)), window(viewport) {}
+
+        // The inverse view-projection matrix.
+        const matrix<T, 4>& inverse() const
+        {
+            return inverse_matrix;
+        }
+
+        const vector<T, 4>& viewport() const
+        {
+            return window;
+        }
+
+        vector<T, 3> unproject(const vector<T, 3>& point) const
+        {
+            T x = 2 * (point[0] - window[0]) / window[2] - 1;
+            T y = 2 * (point[1] - window[1]) / window[3] - 1;
+            T z = 2 * point[2] - 1;
+            vector<T, 4> v = inverse_matrix * vector4<T>(x, y, z, 1);
+            return vector3<T>(v[0] / v[3], v[1] / v[3], v[2] / v[3]);
+        }
+
+        // Ray through the window position (x, y).
+        ray<T> pick(T x, T y) const
+        {
+            ray<T> r;
+            rays_row(x, y, 1, &r);
+            return r;
+        }
+
+        // Rays through the centers of the pixels of the rectangle (x, y,
+        // width, height) of the window: ray i + j * width passes through
+        // (x + i + 0.5, y + j + 0.5). out must hold width * height rays.
+        void rays(int x, int y, unsigned int width, unsigned int height, ray<T>* out) const
+        {
+            for (unsigned int j = 0; j < height; j++)
+            {
+                rays_row(T(x) + T(0.5), T(y + (int)j) + T(0.5), width, out + size_t(j) * width);
+            }
+        }
+
+        // The same, with the origins and directions written to streams.
+        void rays(int x, int y, unsigned int width, unsigned int height, vector_stream<T, 3>& origins, vector_stream<T, 3>& directions) const
+        {
+            origins.resize(size_t(width) * height);
+            directions.resize(size_t(width) * height);
+            for (unsigned int j = 0; j < height; j++)
+            {
+                rays_row(T(x) + T(0.5), T(y + (int)j) + T(0.5), width, origins, directions, size_t(j) * width);
+            }
+        }
+
+        // The same, with the rows split over the threads of a pool.
+        void rays(thread_pool& pool, int x, int y, unsigned int width, unsigned int height, ray<T>* out) const
+        {
+            parallel_for(pool, 0, height, grain(width), [&] (size_t b, size_t e) {
+                for (size_t j = b; j < e; j++)
+                {
+                    rays_row(T(x) + T(0.5), T(y + (int)j) + T(0.5), width, out + j * width);
+                }
+            });
+        }
+
+        void rays(thread_pool& pool, int x, int y, unsigned int width, unsigned int height, vector_stream<T, 3>& origins, vector_stream<T, 3>& directions) const
+        {
+            origins.resize(size_t(width) * height);
+            directions.resize(size_t(width) * height);
+            parallel_for(pool, 0, height, grain(width), [&] (size_t b, size_t e) {
+                for (size_t j = b; j < e; j++)
+                {
+                    rays_row(T(x) + T(0.5), T(y + (int)j) + T(0.5), width, origins, directions, j * width);
+                }
+            });
+        }
+
+    private:
+        // rays per chunk of rows for the pool
+        static const size_t RAYS_GRAIN = 4096;
+
+        matrix<T, 4> inverse_matrix;
+        vector<T, 4> window;
+
+        static size_t grain(unsigned int width)
+        {
+            return width != 0 && width < RAYS_GRAIN ? RAYS_GRAIN / width : 1;
+        }
+
+        void rays_row(T x, T y, size_t count, ray<T>* out) const
+        {
+            simd::unproject_row(inverse_matrix, window, x, y, count, [&] (size_t i, size_t n, const T (*o)[simd::batch<T>::size], const T (*d)[simd::batch<T>::size]) {
+                for (size_t k = 0; k < n; k++)
+                {
+                    out[i + k].origin    = vector3<T>(o[0][k], o[1][k], o[2][k]);
+                    out[i + k].direction = vector3<T>(d[0][k], d[1][k], d[2][k]);
+                }
+            });
+        }
+
+        void rays_row(T x, T y, size_t count, vector_stream<T, 3>& origins, vector_stream<T, 3>& directions, size_t first) const
+        {
+            simd::unproject_row(inverse_matrix, window, x, y, count, [&] (size_t i, size_t n, const T (*o)[simd::batch<T>::size], const T (*d)[simd::batch<T>::size]) {
+                for (unsigned int k = 0; k < 3; k++)
+                {
+                    std::memcpy(origins.lane(k) + first + i, o[k], n * sizeof(T));
+                    std::memcpy(directions.lane(k) + first + i, d[k], n * sizeof(T));
+                }
+            });
+        }
+    };
+
+    template <typename T> const size_t unprojector<T>::RAYS_GRAIN;
+}
+
+#endif
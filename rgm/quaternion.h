@@ -2,6 +2,10 @@
 #ifndef _RGM_QUATERNION_H_
 #define _RGM_QUATERNION_H_
 
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
 #include "vector.h"
 #include "matrix.h"
 
@@ -11,12 +15,12 @@ namespace rgm
     class quaterion : public vector4<T>
     {
     public:
-        quaterion() {}
+        constexpr quaterion() {}
 
-        explicit quaterion(T v) 
+        constexpr explicit quaterion(T v) 
         : vector4<T>(v) {}          
 
-        quaterion(T x, T y, T z, T m)
+        constexpr quaterion(T x, T y, T z, T m)
         {
             data[0] = x;
             data[1] = y;
@@ -24,7 +28,7 @@ namespace rgm
             data[3] = m;
         }
 
-        quaterion(const vector<T, 3>& v, T w)
+        constexpr quaterion(const vector<T, 3>& v, T w)
         {
             data[0] = v[0];
             data[1] = v[1];
@@ -32,17 +36,17 @@ namespace rgm
             data[3] = w;
         }
 
-        quaterion(const vector<T, 4>& v)
+        constexpr quaterion(const vector<T, 4>& v)
         : vector4<T>(v) {}
 
-        quaterion(const vector4<T>& v)
+        constexpr quaterion(const vector4<T>& v)
         : vector4<T>(v) {}
 
         template <typename T2>
-        explicit quaterion(const vector<T2, 4>& v) 
+        constexpr explicit quaterion(const vector<T2, 4>& v) 
         : vector4<T>(v) {}
 
-        operator vector3<T> () 
+        constexpr operator vector3<T> () 
         {
             return vector3<T>(data[0], data[1], data[2]);
         }
@@ -52,7 +56,7 @@ namespace rgm
     };
 
     template <typename T>
-    quaterion<T> operator * (const quaterion<T>& a, const quaterion<T>& b)
+    constexpr quaterion<T> operator * (const quaterion<T>& a, const quaterion<T>& b)
     {
         T          wa = a[3];
         vector3<T> va = vector3<T>(a);
@@ -67,19 +71,19 @@ namespace rgm
 
     
     template <typename T>
-    quaterion<T> conjugate(const quaterion<T>& q)
+    constexpr quaterion<T> conjugate(const quaterion<T>& q)
     {
         return quaterion<T>(-vector3<T>(q), q[3]);
     }
      
     template <typename T>
-    quaterion<T> inverse(const quaterion<T>& q)
+    constexpr quaterion<T> inverse(const quaterion<T>& q)
     {
         return conjugate(q);
     }
 
     template <typename T>
-    matrix<T, 4> quat2mat4(const quaterion<T>& q)
+    constexpr matrix<T, 4> quat2mat4(const quaterion<T>& q)
     {
         T xx = q[0] * q[0];
         T xy = q[0] * q[1];
@@ -105,19 +109,87 @@ namespace rgm
         return mat;        
     }
 
+    // Rotation part of m as unit quaternion, the inverse of quat2mat4;
+    // the upper 3x3 of m must be a rotation.
+    template <typename T>
+    quaterion<T> mat42quat(const matrix<T, 4>& m)
+    {
+        T trace = m.at(0, 0) + m.at(1, 1) + m.at(2, 2);
+        if (trace > 0)
+        {
+            T s = std::sqrt(trace + 1) * 2;
+            return quaterion<T>((m.at(1, 2) - m.at(2, 1)) / s, (m.at(2, 0) - m.at(0, 2)) / s, (m.at(0, 1) - m.at(1, 0)) / s, s / 4);
+        }
+        else if (m.at(0, 0) > m.at(1, 1) && m.at(0, 0) > m.at(2, 2))
+        {
+            T s = std::sqrt(1 + m.at(0, 0) - m.at(1, 1) - m.at(2, 2)) * 2;
+            return quaterion<T>(s / 4, (m.at(1, 0) + m.at(0, 1)) / s, (m.at(2, 0) + m.at(0, 2)) / s, (m.at(1, 2) - m.at(2, 1)) / s);
+        }
+        else if (m.at(1, 1) > m.at(2, 2))
+        {
+            T s = std::sqrt(1 + m.at(1, 1) - m.at(0, 0) - m.at(2, 2)) * 2;
+            return quaterion<T>((m.at(1, 0) + m.at(0, 1)) / s, s / 4, (m.at(2, 1) + m.at(1, 2)) / s, (m.at(2, 0) - m.at(0, 2)) / s);
+        }
+        else
+        {
+            T s = std::sqrt(1 + m.at(2, 2) - m.at(0, 0) - m.at(1, 1)) * 2;
+            return quaterion<T>((m.at(2, 0) + m.at(0, 2)) / s, (m.at(2, 1) + m.at(1, 2)) / s, s / 4, (m.at(0, 1) - m.at(1, 0)) / s);
+        }
+    }
+
     template <typename T>
     quaterion<T> quatfromvectors(vector<T, 3> u, vector<T, 3> v)
     {
-        vec3 qv = cross(u, v);
-        T    qw = std::sqrt(std::pow(length(u), 2) * std::pow(length(v), 2)) + dot(u, v);
+        vector<T, 3> qv = cross(u, v);
+        T            qw = std::sqrt(dot(u, u) * dot(v, v)) + dot(u, v);
 
         quaterion<T> q(qv, qw);
 
         return normalize(q);
     }
 
+    // Normalized linear interpolation from a (t = 0) to b (t = 1). Like
+    // slerp it takes the shortest path, i.e. b is negated if the two are
+    // more than 180 degrees apart; unlike slerp the angular velocity is
+    // not constant over t.
+    template <typename T>
+    quaterion<T> nlerp(const quaterion<T>& a, const quaterion<T>& b, T t)
+    {
+        quaterion<T> c = dot(a, b) < 0 ? quaterion<T>(-b) : b;
+        return normalize(a * (1 - t) + c * t);
+    }
+
+    // Spherical linear interpolation of unit quaternions from a (t = 0)
+    // to b (t = 1), along the shortest path. For nearly equal quaternions
+    // (1 - cos(theta) below sqrt(epsilon)) it returns nlerp, which differs
+    // from slerp by O(theta^3) there, instead of dividing by sin(theta) ~ 0.
+    template <typename T>
+    quaterion<T> slerp(const quaterion<T>& a, const quaterion<T>& b, T t)
+    {
+        T            d = dot(a, b);
+        quaterion<T> c = b;
+        if (d < 0)
+        {
+            d = -d;
+            c = -b;
+        }
+
+        if (1 - d < std::sqrt(std::numeric_limits<T>::epsilon()))
+        {
+            return normalize(a * (1 - t) + c * t);
+        }
+
+        T theta = std::acos(d);
+        T s     = std::sin(theta);
+        return (a * std::sin((1 - t) * theta) + c * std::sin(t * theta)) / s;
+    }
+
     typedef quaterion<float>  quat;
     typedef quaterion<double> dquat;
+
+    static_assert(std::is_trivially_copyable<quat>::value && std::is_trivially_copyable<dquat>::value, "quaternions must be trivially copyable");
+    static_assert(std::is_standard_layout<quat>::value && std::is_standard_layout<dquat>::value, "quaternions must be standard layout");
+    static_assert(sizeof(quat) == 4 * sizeof(float) && sizeof(dquat) == 4 * sizeof(double), "quaternions must not be padded");
 }
 
 #endif
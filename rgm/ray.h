@@ -0,0 +1,54 @@
+/*
+    rgm - Rioki's Graphic Math Library
+
+    Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+#ifndef _RGM_RAY_H_
+#define _RGM_RAY_H_
+
+#include "vector.h"
+
+namespace rgm
+{
+    // Half line origin + t direction, t >= 0. The direction does not need
+    // to be of unit length; the t of hits is then in units of direction.
+    template <typename T>
+    class ray
+    {
+    public:
+        vector<T, 3> origin;
+        vector<T, 3> direction;
+
+        constexpr ray() {}
+
+        constexpr ray(const vector<T, 3>& origin, const vector<T, 3>& direction)
+        : origin(origin), direction(direction) {}
+    };
+
+    template <typename T>
+    constexpr vector<T, 3> point_at(const ray<T>& r, T t)
+    {
+        return r.origin + r.direction * t;
+    }
+}
+
+#endif
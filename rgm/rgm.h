@@ -30,5 +30,17 @@
 #include "quaternion.h"
 #include "matrix.h"
 #include "gl.h"
+#include "stream.h"
+#include "memory.h"
+#include "packing.h"
+#include "dual_quaternion.h"
+#include "culling.h"
+#include "projection.h"
+#include "ray.h"
+#include "bvh.h"
+#include "intersect.h"
+#include "hierarchy.h"
+#include "expression.h"
+#include "parallel.h"
 
 #endif
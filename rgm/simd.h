@@ -0,0 +1,581 @@
+/*
+    rgm - Rioki's Graphic Math Library
+
+    Copyright (c) 2014-2015 Sean "rioki" Farrell
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in
+    all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+    THE SOFTWARE.
+*/
+
+#ifndef _RGM_SIMD_H_
+#define _RGM_SIMD_H_
+
+// The instruction sets are taken from the compiler settings (-msse2, -mavx,
+// /arch:AVX, ...). Define RGM_NO_SIMD to force the portable scalar code.
+#ifndef RGM_NO_SIMD
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define RGM_SSE2
+    #endif
+    #if defined(RGM_SSE2) && defined(__AVX__)
+        #define RGM_AVX
+    #endif
+    #if defined(RGM_AVX) && (defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__)))
+        #define RGM_FMA
+    #endif
+    #if defined(RGM_AVX) && (defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__)))
+        #define RGM_F16C
+    #endif
+#endif
+
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+// The SIMD overloads can not be evaluated at compile time. If the compiler
+// can tell constant evaluation apart, they fall back to the generic loops
+// there and are constexpr like them; otherwise constant expressions with
+// float and double vectors need RGM_NO_SIMD.
+#if defined(__clang__)
+    #if defined(__has_builtin)
+        #if __has_builtin(__builtin_is_constant_evaluated)
+            #define RGM_HAS_CONSTANT_EVALUATED
+        #endif
+    #endif
+#elif defined(__GNUC__) && __GNUC__ >= 9
+    #define RGM_HAS_CONSTANT_EVALUATED
+#elif defined(_MSC_VER) && _MSC_VER >= 1925
+    #define RGM_HAS_CONSTANT_EVALUATED
+#endif
+
+#ifdef RGM_HAS_CONSTANT_EVALUATED
+    #define RGM_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+    #define RGM_SIMD_CONSTEXPR constexpr
+#else
+    #define RGM_CONSTANT_EVALUATED() false
+    #define RGM_SIMD_CONSTEXPR
+#endif
+
+#ifdef RGM_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef RGM_AVX
+#include <immintrin.h>
+#endif
+
+namespace rgm
+{
+namespace simd
+{
+    // Selects the constructors that leave the elements uninitialized,
+    // for kernels that store all of them right away. The other constructors
+    // zero them first, as constant expressions require.
+    struct no_init {};
+
+#ifdef RGM_SSE2
+    // One register per small vector: float vectors up to 4 elements fit into
+    // one SSE register, double vectors up to 2 into one and up to 4 into one
+    // AVX register or a pair of SSE registers.
+    typedef __m128  float4;
+    typedef __m128d double2;
+
+#ifdef RGM_AVX
+    typedef __m256  float8;
+    typedef __m256d double4;
+#else
+    struct double4
+    {
+        __m128d lo;
+        __m128d hi;
+    };
+#endif
+
+    inline float4 add(float4 a, float4 b) { return _mm_add_ps(a, b); }
+    inline float4 sub(float4 a, float4 b) { return _mm_sub_ps(a, b); }
+    inline float4 mul(float4 a, float4 b) { return _mm_mul_ps(a, b); }
+    inline float4 div(float4 a, float4 b) { return _mm_div_ps(a, b); }
+    inline float4 neg(float4 a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+    inline float4 abs(float4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+    inline float4 flipsign(float4 a, float4 s) { return _mm_xor_ps(a, _mm_and_ps(s, _mm_set1_ps(-0.0f))); }
+    // operands swapped to get the same result as std::min / std::max
+    inline float4 min(float4 a, float4 b) { return _mm_min_ps(b, a); }
+    inline float4 max(float4 a, float4 b) { return _mm_max_ps(b, a); }
+    inline float4 sqrt(float4 a) { return _mm_sqrt_ps(a); }
+    inline unsigned int signmask(float4 a) { return _mm_movemask_ps(a); }
+
+    inline double2 add(double2 a, double2 b) { return _mm_add_pd(a, b); }
+    inline double2 sub(double2 a, double2 b) { return _mm_sub_pd(a, b); }
+    inline double2 mul(double2 a, double2 b) { return _mm_mul_pd(a, b); }
+    inline double2 div(double2 a, double2 b) { return _mm_div_pd(a, b); }
+    inline double2 neg(double2 a) { return _mm_xor_pd(a, _mm_set1_pd(-0.0)); }
+    inline double2 abs(double2 a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+    inline double2 flipsign(double2 a, double2 s) { return _mm_xor_pd(a, _mm_and_pd(s, _mm_set1_pd(-0.0))); }
+    inline double2 min(double2 a, double2 b) { return _mm_min_pd(b, a); }
+    inline double2 max(double2 a, double2 b) { return _mm_max_pd(b, a); }
+    inline double2 sqrt(double2 a) { return _mm_sqrt_pd(a); }
+    inline unsigned int signmask(double2 a) { return _mm_movemask_pd(a); }
+
+#ifdef RGM_AVX
+    inline double4 add(double4 a, double4 b) { return _mm256_add_pd(a, b); }
+    inline double4 sub(double4 a, double4 b) { return _mm256_sub_pd(a, b); }
+    inline double4 mul(double4 a, double4 b) { return _mm256_mul_pd(a, b); }
+    inline double4 div(double4 a, double4 b) { return _mm256_div_pd(a, b); }
+    inline double4 neg(double4 a) { return _mm256_xor_pd(a, _mm256_set1_pd(-0.0)); }
+    inline double4 abs(double4 a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+    inline double4 flipsign(double4 a, double4 s) { return _mm256_xor_pd(a, _mm256_and_pd(s, _mm256_set1_pd(-0.0))); }
+    inline double4 min(double4 a, double4 b) { return _mm256_min_pd(b, a); }
+    inline double4 max(double4 a, double4 b) { return _mm256_max_pd(b, a); }
+    inline double4 sqrt(double4 a) { return _mm256_sqrt_pd(a); }
+    inline unsigned int signmask(double4 a) { return _mm256_movemask_pd(a); }
+
+    inline float8 add(float8 a, float8 b) { return _mm256_add_ps(a, b); }
+    inline float8 sub(float8 a, float8 b) { return _mm256_sub_ps(a, b); }
+    inline float8 mul(float8 a, float8 b) { return _mm256_mul_ps(a, b); }
+    inline float8 div(float8 a, float8 b) { return _mm256_div_ps(a, b); }
+    inline float8 neg(float8 a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+    inline float8 abs(float8 a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    inline float8 flipsign(float8 a, float8 s) { return _mm256_xor_ps(a, _mm256_and_ps(s, _mm256_set1_ps(-0.0f))); }
+    inline float8 min(float8 a, float8 b) { return _mm256_min_ps(b, a); }
+    inline float8 max(float8 a, float8 b) { return _mm256_max_ps(b, a); }
+    inline float8 sqrt(float8 a) { return _mm256_sqrt_ps(a); }
+    inline unsigned int signmask(float8 a) { return _mm256_movemask_ps(a); }
+#endif
+
+    // a * b + c; rounded once with FMA, so the result can differ in the
+    // last bit from the separate multiply and add.
+#ifdef RGM_FMA
+    inline float4  madd(float4 a, float4 b, float4 c)    { return _mm_fmadd_ps(a, b, c); }
+    inline double2 madd(double2 a, double2 b, double2 c) { return _mm_fmadd_pd(a, b, c); }
+    inline double4 madd(double4 a, double4 b, double4 c) { return _mm256_fmadd_pd(a, b, c); }
+    inline float8  madd(float8 a, float8 b, float8 c)    { return _mm256_fmadd_ps(a, b, c); }
+#else
+    inline float4  madd(float4 a, float4 b, float4 c)    { return add(mul(a, b), c); }
+    inline double2 madd(double2 a, double2 b, double2 c) { return add(mul(a, b), c); }
+#ifdef RGM_AVX
+    inline double4 madd(double4 a, double4 b, double4 c) { return add(mul(a, b), c); }
+    inline float8  madd(float8 a, float8 b, float8 c)    { return add(mul(a, b), c); }
+#endif
+#endif
+
+#ifndef RGM_AVX
+    inline double4 make_double4(double2 lo, double2 hi)
+    {
+        double4 r;
+        r.lo = lo;
+        r.hi = hi;
+        return r;
+    }
+
+    inline double4 add(double4 a, double4 b) { return make_double4(add(a.lo, b.lo), add(a.hi, b.hi)); }
+    inline double4 sub(double4 a, double4 b) { return make_double4(sub(a.lo, b.lo), sub(a.hi, b.hi)); }
+    inline double4 mul(double4 a, double4 b) { return make_double4(mul(a.lo, b.lo), mul(a.hi, b.hi)); }
+    inline double4 div(double4 a, double4 b) { return make_double4(div(a.lo, b.lo), div(a.hi, b.hi)); }
+    inline double4 neg(double4 a) { return make_double4(neg(a.lo), neg(a.hi)); }
+    inline double4 abs(double4 a) { return make_double4(abs(a.lo), abs(a.hi)); }
+    inline double4 flipsign(double4 a, double4 s) { return make_double4(flipsign(a.lo, s.lo), flipsign(a.hi, s.hi)); }
+    inline double4 min(double4 a, double4 b) { return make_double4(min(a.lo, b.lo), min(a.hi, b.hi)); }
+    inline double4 max(double4 a, double4 b) { return make_double4(max(a.lo, b.lo), max(a.hi, b.hi)); }
+    inline double4 madd(double4 a, double4 b, double4 c) { return make_double4(madd(a.lo, b.lo, c.lo), madd(a.hi, b.hi, c.hi)); }
+    inline double4 sqrt(double4 a) { return make_double4(sqrt(a.lo), sqrt(a.hi)); }
+    inline unsigned int signmask(double4 a) { return signmask(a.lo) | signmask(a.hi) << 2; }
+#endif
+
+    // a in the lanes where the sign bit of s is set, b in the others, e.g.
+    // to pick the result of the lanes that passed a test computed as a
+    // difference, the same way as signmask.
+    inline float4 select(float4 s, float4 a, float4 b)
+    {
+        float4 m = _mm_castsi128_ps(_mm_srai_epi32(_mm_castps_si128(s), 31));
+        return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+    }
+
+    inline double2 select(double2 s, double2 a, double2 b)
+    {
+        // no 64 bit arithmetic shift before AVX-512, spread the upper half
+        double2 m = _mm_castsi128_pd(_mm_shuffle_epi32(_mm_srai_epi32(_mm_castpd_si128(s), 31), _MM_SHUFFLE(3, 3, 1, 1)));
+        return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b));
+    }
+
+#ifdef RGM_AVX
+    inline float8 select(float8 s, float8 a, float8 b) { return _mm256_blendv_ps(b, a, s); }
+    inline double4 select(double4 s, double4 a, double4 b) { return _mm256_blendv_pd(b, a, s); }
+#else
+    inline double4 select(double4 s, double4 a, double4 b) { return make_double4(select(s.lo, a.lo, b.lo), select(s.hi, a.hi, b.hi)); }
+#endif
+
+    // Reciprocal square root and reciprocal. The float versions refine the
+    // hardware estimate (relative error up to 1.5 * 2^-12) with one
+    // Newton-Raphson step, which leaves about 22 of 24 bits, and give NaN
+    // for zero. There is no double precision estimate, so the double
+    // versions divide.
+    inline float4 rsqrt(float4 a)
+    {
+        float4 y = _mm_rsqrt_ps(a);
+        return mul(mul(_mm_set1_ps(0.5f), y), sub(_mm_set1_ps(3.0f), mul(mul(a, y), y)));
+    }
+
+    inline float4 rcp(float4 a)
+    {
+        float4 y = _mm_rcp_ps(a);
+        return mul(y, sub(_mm_set1_ps(2.0f), mul(a, y)));
+    }
+
+    inline double2 rsqrt(double2 a) { return _mm_div_pd(_mm_set1_pd(1.0), _mm_sqrt_pd(a)); }
+    inline double2 rcp(double2 a) { return _mm_div_pd(_mm_set1_pd(1.0), a); }
+
+#ifdef RGM_AVX
+    inline float8 rsqrt(float8 a)
+    {
+        float8 y = _mm256_rsqrt_ps(a);
+        return mul(mul(_mm256_set1_ps(0.5f), y), sub(_mm256_set1_ps(3.0f), mul(mul(a, y), y)));
+    }
+
+    inline float8 rcp(float8 a)
+    {
+        float8 y = _mm256_rcp_ps(a);
+        return mul(y, sub(_mm256_set1_ps(2.0f), mul(a, y)));
+    }
+
+    inline double4 rsqrt(double4 a) { return _mm256_div_pd(_mm256_set1_pd(1.0), _mm256_sqrt_pd(a)); }
+    inline double4 rcp(double4 a) { return _mm256_div_pd(_mm256_set1_pd(1.0), a); }
+#else
+    inline double4 rsqrt(double4 a) { return make_double4(rsqrt(a.lo), rsqrt(a.hi)); }
+    inline double4 rcp(double4 a) { return make_double4(rcp(a.lo), rcp(a.hi)); }
+#endif
+
+    // Sum of the first n lanes, added left to right like the scalar loops,
+    // so that dot and length give the same results as the portable code.
+    inline float sum(float4 a, unsigned int n)
+    {
+        float4 r = a;
+        if (n > 1)
+        {
+            r = _mm_add_ss(r, _mm_shuffle_ps(a, a, _MM_SHUFFLE(1, 1, 1, 1)));
+        }
+        if (n > 2)
+        {
+            r = _mm_add_ss(r, _mm_movehl_ps(a, a));
+        }
+        if (n > 3)
+        {
+            r = _mm_add_ss(r, _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 3, 3, 3)));
+        }
+        return _mm_cvtss_f32(r);
+    }
+
+    inline double sum(double2 a, unsigned int n)
+    {
+        double2 r = a;
+        if (n > 1)
+        {
+            r = _mm_add_sd(r, _mm_unpackhi_pd(a, a));
+        }
+        return _mm_cvtsd_f64(r);
+    }
+
+    inline double sum(double4 a, unsigned int n)
+    {
+#ifdef RGM_AVX
+        double2 lo = _mm256_castpd256_pd128(a);
+        double2 hi = _mm256_extractf128_pd(a, 1);
+#else
+        double2 lo = a.lo;
+        double2 hi = a.hi;
+#endif
+        double2 r = lo;
+        if (n > 1)
+        {
+            r = _mm_add_sd(r, _mm_unpackhi_pd(lo, lo));
+        }
+        if (n > 2)
+        {
+            r = _mm_add_sd(r, hi);
+        }
+        if (n > 3)
+        {
+            r = _mm_add_sd(r, _mm_unpackhi_pd(hi, hi));
+        }
+        return _mm_cvtsd_f64(r);
+    }
+
+    // Register type and load / store for vector<T, N>; only defined for the
+    // combinations that have a SIMD implementation. Vectors shorter than the
+    // register are loaded padded with zeros and stored without touching the
+    // memory behind them.
+    template <typename T, unsigned int N>
+    struct packed {};
+
+    template <>
+    struct packed<float, 2>
+    {
+        typedef float4 type;
+        // Through __m128i, which may alias the floats; a double would not.
+        static type load(const float* p) { return _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p))); }
+        static void store(float* p, type v) { _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_castps_si128(v)); }
+        static type splat(float v) { return _mm_set1_ps(v); }
+    };
+
+    template <>
+    struct packed<float, 3>
+    {
+        typedef float4 type;
+        static type load(const float* p) { return _mm_movelh_ps(packed<float, 2>::load(p), _mm_load_ss(p + 2)); }
+        static void store(float* p, type v) { packed<float, 2>::store(p, v); _mm_store_ss(p + 2, _mm_movehl_ps(v, v)); }
+        static type splat(float v) { return _mm_set1_ps(v); }
+    };
+
+    template <>
+    struct packed<float, 4>
+    {
+        typedef float4 type;
+        static type load(const float* p) { return _mm_loadu_ps(p); }
+        static void store(float* p, type v) { _mm_storeu_ps(p, v); }
+        static type splat(float v) { return _mm_set1_ps(v); }
+    };
+
+    template <>
+    struct packed<double, 2>
+    {
+        typedef double2 type;
+        static type load(const double* p) { return _mm_loadu_pd(p); }
+        static void store(double* p, type v) { _mm_storeu_pd(p, v); }
+        static type splat(double v) { return _mm_set1_pd(v); }
+    };
+
+#ifdef RGM_AVX
+    template <>
+    struct packed<double, 3>
+    {
+        typedef double4 type;
+        static type load(const double* p) { return _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_loadu_pd(p)), _mm_load_sd(p + 2), 1); }
+        static void store(double* p, type v) { _mm_storeu_pd(p, _mm256_castpd256_pd128(v)); _mm_store_sd(p + 2, _mm256_extractf128_pd(v, 1)); }
+        static type splat(double v) { return _mm256_set1_pd(v); }
+    };
+
+    template <>
+    struct packed<double, 4>
+    {
+        typedef double4 type;
+        static type load(const double* p) { return _mm256_loadu_pd(p); }
+        static void store(double* p, type v) { _mm256_storeu_pd(p, v); }
+        static type splat(double v) { return _mm256_set1_pd(v); }
+    };
+#else
+    template <>
+    struct packed<double, 3>
+    {
+        typedef double4 type;
+        static type load(const double* p) { return make_double4(_mm_loadu_pd(p), _mm_load_sd(p + 2)); }
+        static void store(double* p, type v) { _mm_storeu_pd(p, v.lo); _mm_store_sd(p + 2, v.hi); }
+        static type splat(double v) { return make_double4(_mm_set1_pd(v), _mm_set1_pd(v)); }
+    };
+
+    template <>
+    struct packed<double, 4>
+    {
+        typedef double4 type;
+        static type load(const double* p) { return make_double4(_mm_loadu_pd(p), _mm_loadu_pd(p + 2)); }
+        static void store(double* p, type v) { _mm_storeu_pd(p, v.lo); _mm_storeu_pd(p + 2, v.hi); }
+        static type splat(double v) { return make_double4(_mm_set1_pd(v), _mm_set1_pd(v)); }
+    };
+#endif
+#endif
+
+    // The same operations on plain values, so that code written against
+    // batch<T> below also works for a single element.
+    template <typename T> T add(T a, T b) { return a + b; }
+    template <typename T> T sub(T a, T b) { return a - b; }
+    template <typename T> T mul(T a, T b) { return a * b; }
+    template <typename T> T div(T a, T b) { return a / b; }
+    template <typename T> T neg(T a) { return -a; }
+    template <typename T> T abs(T a) { return std::abs(a); }
+    template <typename T> T flipsign(T a, T s) { return a * std::copysign(T(1), s); }
+    template <typename T> T min(T a, T b) { return std::min(a, b); }
+    template <typename T> T max(T a, T b) { return std::max(a, b); }
+    template <typename T> T sqrt(T a) { return std::sqrt(a); }
+    template <typename T> T madd(T a, T b, T c) { return a * b + c; }
+    template <typename T> unsigned int signmask(T a) { return std::signbit(a) ? 1 : 0; }
+    template <typename T> T select(T s, T a, T b) { return std::signbit(s) ? a : b; }
+    template <typename T> T rsqrt(T a) { return T(1) / std::sqrt(a); }
+    template <typename T> T rcp(T a) { return T(1) / a; }
+
+    // Widest register for element wise work on arrays of T, e.g. the lanes
+    // of a vector_stream. The pointers passed to load and store must be
+    // aligned to the register size; types without a SIMD implementation
+    // are processed one element at a time.
+    // load_transposed4 loads size rows of 4 elements from anywhere in
+    // memory and returns element j of every row in columns[j], e.g. to
+    // gather one quaternion per element.
+    template <typename T>
+    struct batch
+    {
+        typedef T type;
+        static const unsigned int size = 1;
+        static type load(const T* p) { return *p; }
+        static void store(T* p, type v) { *p = v; }
+        static type splat(T v) { return v; }
+
+        static void load_transposed4(const T* const* rows, type* columns)
+        {
+            for (unsigned int j = 0; j < 4; j++)
+            {
+                columns[j] = rows[0][j];
+            }
+        }
+    };
+
+#if defined(RGM_AVX)
+    template <>
+    struct batch<float>
+    {
+        typedef float8 type;
+        static const unsigned int size = 8;
+        static type load(const float* p) { return _mm256_load_ps(p); }
+        static void store(float* p, type v) { _mm256_store_ps(p, v); }
+        static type splat(float v) { return _mm256_set1_ps(v); }
+
+        static void load_transposed4(const float* const* rows, type* columns)
+        {
+            // rows l and l + 4 share a register, one per 128 bit lane
+            float8 r0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(rows[0])), _mm_loadu_ps(rows[4]), 1);
+            float8 r1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(rows[1])), _mm_loadu_ps(rows[5]), 1);
+            float8 r2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(rows[2])), _mm_loadu_ps(rows[6]), 1);
+            float8 r3 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(rows[3])), _mm_loadu_ps(rows[7]), 1);
+            float8 t0 = _mm256_unpacklo_ps(r0, r1);
+            float8 t1 = _mm256_unpackhi_ps(r0, r1);
+            float8 t2 = _mm256_unpacklo_ps(r2, r3);
+            float8 t3 = _mm256_unpackhi_ps(r2, r3);
+            columns[0] = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+            columns[1] = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+            columns[2] = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            columns[3] = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+        }
+    };
+
+    template <>
+    struct batch<double>
+    {
+        typedef double4 type;
+        static const unsigned int size = 4;
+        static type load(const double* p) { return _mm256_load_pd(p); }
+        static void store(double* p, type v) { _mm256_store_pd(p, v); }
+        static type splat(double v) { return _mm256_set1_pd(v); }
+
+        static void load_transposed4(const double* const* rows, type* columns)
+        {
+            double4 r0 = _mm256_loadu_pd(rows[0]);
+            double4 r1 = _mm256_loadu_pd(rows[1]);
+            double4 r2 = _mm256_loadu_pd(rows[2]);
+            double4 r3 = _mm256_loadu_pd(rows[3]);
+            double4 t0 = _mm256_unpacklo_pd(r0, r1);
+            double4 t1 = _mm256_unpackhi_pd(r0, r1);
+            double4 t2 = _mm256_unpacklo_pd(r2, r3);
+            double4 t3 = _mm256_unpackhi_pd(r2, r3);
+            columns[0] = _mm256_permute2f128_pd(t0, t2, 0x20);
+            columns[1] = _mm256_permute2f128_pd(t1, t3, 0x20);
+            columns[2] = _mm256_permute2f128_pd(t0, t2, 0x31);
+            columns[3] = _mm256_permute2f128_pd(t1, t3, 0x31);
+        }
+    };
+#elif defined(RGM_SSE2)
+    template <>
+    struct batch<float>
+    {
+        typedef float4 type;
+        static const unsigned int size = 4;
+        static type load(const float* p) { return _mm_load_ps(p); }
+        static void store(float* p, type v) { _mm_store_ps(p, v); }
+        static type splat(float v) { return _mm_set1_ps(v); }
+
+        static void load_transposed4(const float* const* rows, type* columns)
+        {
+            float4 r0 = _mm_loadu_ps(rows[0]);
+            float4 r1 = _mm_loadu_ps(rows[1]);
+            float4 r2 = _mm_loadu_ps(rows[2]);
+            float4 r3 = _mm_loadu_ps(rows[3]);
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            columns[0] = r0;
+            columns[1] = r1;
+            columns[2] = r2;
+            columns[3] = r3;
+        }
+    };
+
+    template <>
+    struct batch<double>
+    {
+        typedef double2 type;
+        static const unsigned int size = 2;
+        static type load(const double* p) { return _mm_load_pd(p); }
+        static void store(double* p, type v) { _mm_store_pd(p, v); }
+        static type splat(double v) { return _mm_set1_pd(v); }
+
+        static void load_transposed4(const double* const* rows, type* columns)
+        {
+            load_transposed2(rows, 0, columns);
+            load_transposed2(rows, 2, columns + 2);
+        }
+
+        static void load_transposed2(const double* const* rows, unsigned int offset, type* columns)
+        {
+            double2 r0 = _mm_loadu_pd(rows[0] + offset);
+            double2 r1 = _mm_loadu_pd(rows[1] + offset);
+            columns[0] = _mm_unpacklo_pd(r0, r1);
+            columns[1] = _mm_unpackhi_pd(r0, r1);
+        }
+    };
+#endif
+
+    // Polynomial approximations of the math functions, for batch code that
+    // can not call the <cmath> ones per element. They are written against
+    // batch<T>, so they work on registers and plain values alike.
+
+    // acos(x) for x in [0, 1], absolute error below 2e-8 plus rounding
+    // (Abramowitz and Stegun 4.4.46). The polynomials are evaluated with
+    // Estrin's scheme rather than Horner's, which halves the dependency
+    // chain at the cost of two multiplications.
+    template <typename T>
+    typename batch<T>::type acos_unit(typename batch<T>::type x)
+    {
+        typedef batch<T> B;
+        typename B::type x2  = mul(x, x);
+        typename B::type x4  = mul(x2, x2);
+        typename B::type p01 = madd(B::splat((T)-0.2145988016), x, B::splat((T)1.5707963050));
+        typename B::type p23 = madd(B::splat((T)-0.0501743046), x, B::splat((T)0.0889789874));
+        typename B::type p45 = madd(B::splat((T)-0.0170881256), x, B::splat((T)0.0308918810));
+        typename B::type p67 = madd(B::splat((T)-0.0012624911), x, B::splat((T)0.0066700901));
+        typename B::type p   = madd(madd(p67, x2, p45), x4, madd(p23, x2, p01));
+        return mul(p, sqrt(sub(B::splat(1), x)));
+    }
+
+    // sin(x) / x for x in [-pi/2, pi/2], 1 at 0; relative error below
+    // 4e-8 plus rounding (Taylor series up to x^10).
+    template <typename T>
+    typename batch<T>::type sinc(typename batch<T>::type x)
+    {
+        typedef batch<T> B;
+        typename B::type x2  = mul(x, x);
+        typename B::type x4  = mul(x2, x2);
+        typename B::type p01 = madd(B::splat((T)(-1.0 / 6.0)), x2, B::splat(1));
+        typename B::type p23 = madd(B::splat((T)(-1.0 / 5040.0)), x2, B::splat((T)(1.0 / 120.0)));
+        typename B::type p45 = madd(B::splat((T)(-1.0 / 39916800.0)), x2, B::splat((T)(1.0 / 362880.0)));
+        return madd(madd(p45, x4, p23), x4, p01);
+    }
+}
+}
+
+#endif
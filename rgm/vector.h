@@ -28,6 +28,10 @@
 #include <cassert>
 #include <cmath>
 #include <iostream>
+#include <limits>
+#include <type_traits>
+
+#include "simd.h"
 
 #undef min
 #undef max
@@ -39,9 +43,13 @@ namespace rgm
     {
     public:
 
-        vector() {}
+        constexpr vector()
+        : data() {}
+
+        explicit vector(simd::no_init) {}
 
-        explicit vector(T v) 
+        constexpr explicit vector(T v)
+        : data()
         {
             for (unsigned int i = 0; i < N; i++)
             {
@@ -49,17 +57,13 @@ namespace rgm
             }
         }
 
-        vector(const vector<T, N>& v) 
-        {
-            // use assignement, since vector could be complex
-            for (unsigned int i = 0; i < N; i++)
-            {
-                data[i] = v.data[i];
-            }
-        }
+        // Defaulted, so that vectors are trivially copyable and arrays of
+        // them are copied with memcpy.
+        vector(const vector<T, N>&) = default;
 
         template <typename T2>
-        explicit vector(const vector<T2, N>& v) 
+        constexpr explicit vector(const vector<T2, N>& v)
+        : data()
         {
             for (unsigned int i = 0; i < N; i++)
             {
@@ -67,16 +71,9 @@ namespace rgm
             }
         }
 
-        vector<T, N>& operator = (const vector<T, N>& v)
-        {
-            for (unsigned int i = 0; i < N; i++)
-            {
-                data[i] = v.data[i];
-            }
-            return *this;
-        }
+        vector<T, N>& operator = (const vector<T, N>&) = default;
 
-        vector<T, N>& operator += (const vector<T, N>& v)
+        constexpr vector<T, N>& operator += (const vector<T, N>& v)
         {
             for (unsigned int i = 0; i < N; i++)
             {
@@ -85,7 +82,7 @@ namespace rgm
             return *this;
         }
 
-        vector<T, N>& operator -= (const vector<T, N>& v)
+        constexpr vector<T, N>& operator -= (const vector<T, N>& v)
         {
             for (unsigned int i = 0; i < N; i++)
             {
@@ -94,19 +91,19 @@ namespace rgm
             return *this;
         }
 
-        T& operator [] (unsigned int i)
+        constexpr T& operator [] (unsigned int i)
         {
             assert(i < N);
             return data[i];
         }
 
-        const T& operator [] (unsigned int i) const
+        constexpr const T& operator [] (unsigned int i) const
         {
             assert(i < N);
             return data[i];
         }
 
-        const T* c_array() const 
+        constexpr const T* c_array() const
         {
             return data;
         }
@@ -120,34 +117,34 @@ namespace rgm
     {
     public:
         
-        vector2() {}
+        constexpr vector2() {}
 
-        explicit vector2(T v) 
+        constexpr explicit vector2(T v)
         : vector<T, 2>(v) {}          
 
-        vector2(T x, T y)
+        constexpr vector2(T x, T y)
         {
             data[0] = x;
             data[1] = y;
         }
 
-        explicit vector2(const vector<T, 3>& v)
+        constexpr explicit vector2(const vector<T, 3>& v)
         {
             data[0] = v[0];
             data[1] = v[1];
         }
 
-        explicit vector2(const vector<T, 4>& v)
+        constexpr explicit vector2(const vector<T, 4>& v)
         {
             data[0] = v[0];
             data[1] = v[1];
         }
 
-        vector2(const vector<T, 2>& v)
+        constexpr vector2(const vector<T, 2>& v)
         : vector<T, 2>(v) {}       
         
         template <typename T2>
-        explicit vector2(const vector<T2, 2>& v) 
+        constexpr explicit vector2(const vector<T2, 2>& v)
         : vector<T, 2>(v) {} 
 
     protected:
@@ -159,37 +156,37 @@ namespace rgm
     {
     public:
         
-        vector3() {}
+        constexpr vector3() {}
 
-        explicit vector3(T v) 
+        constexpr explicit vector3(T v)
         : vector<T, 3>(v) {}          
 
-        explicit vector3(T x, T y, T z)
+        constexpr explicit vector3(T x, T y, T z)
         {
             data[0] = x;
             data[1] = y;
             data[2] = z;
         }
         
-        explicit vector3(const vector<T, 2>& v, T z = (T)0)
+        constexpr explicit vector3(const vector<T, 2>& v, T z = (T)0)
         {
             data[0] = v[0];
             data[1] = v[1];
             data[2] = z;
         }
 
-        explicit vector3(const vector<T, 4>& v)
+        constexpr explicit vector3(const vector<T, 4>& v)
         {
             data[0] = v[0];
             data[1] = v[1];
             data[2] = v[2];
         }
 
-        vector3(const vector<T, 3>& v)
+        constexpr vector3(const vector<T, 3>& v)
         : vector<T, 3>(v) {}
 
         template <typename T2>
-        explicit vector3(const vector<T2, 3>& v) 
+        constexpr explicit vector3(const vector<T2, 3>& v)
         : vector<T, 3>(v) {}
 
     protected:
@@ -201,12 +198,12 @@ namespace rgm
     {
     public:
         
-        vector4() {}
+        constexpr vector4() {}
 
-        explicit vector4(T v) 
+        constexpr explicit vector4(T v)
         : vector<T, 4>(v) {}          
 
-        vector4(T x, T y, T z, T w)
+        constexpr vector4(T x, T y, T z, T w)
         {
             data[0] = x;
             data[1] = y;
@@ -214,7 +211,7 @@ namespace rgm
             data[3] = w;
         }
 
-        explicit vector4(const vector<T, 2>& v, T z = (T)0, T w = (T)0)
+        constexpr explicit vector4(const vector<T, 2>& v, T z = (T)0, T w = (T)0)
         {
             data[0] = v[0];
             data[1] = v[1];
@@ -222,7 +219,7 @@ namespace rgm
             data[3] = w;
         }
 
-        explicit vector4(const vector<T, 3>& v, T w = (T)0)
+        constexpr explicit vector4(const vector<T, 3>& v, T w = (T)0)
         {
             data[0] = v[0];
             data[1] = v[1];
@@ -230,11 +227,11 @@ namespace rgm
             data[3] = w;
         }
 
-        vector4(const vector<T, 4>& v)
+        constexpr vector4(const vector<T, 4>& v)
         : vector<T, 4>(v) {}
 
         template <typename T2>
-        explicit vector4(const vector<T2, 4>& v) 
+        constexpr explicit vector4(const vector<T2, 4>& v)
         : vector<T, 4>(v) {}
 
     protected:
@@ -242,7 +239,7 @@ namespace rgm
     };
 
     template <typename T, unsigned int N>
-    bool operator == (const vector<T, N>& a, const vector<T, N>& b)
+    constexpr bool operator == (const vector<T, N>& a, const vector<T, N>& b)
     {
         for (unsigned int i = 0; i < N; i++)
         {                
@@ -255,19 +252,19 @@ namespace rgm
     }
 
     template <typename T, unsigned int N>
-    bool operator != (const vector<T, N>& a, const vector<T, N>& b)
+    constexpr bool operator != (const vector<T, N>& a, const vector<T, N>& b)
     {
         return !(a == b);
     }
 
     template <typename T, unsigned int N>
-    vector<T, N> operator + (const vector<T, N>& v)
+    constexpr vector<T, N> operator + (const vector<T, N>& v)
     {
         return v;
     }
     
     template <typename T, unsigned int N>
-    vector<T, N> operator - (const vector<T, N>& v)
+    constexpr vector<T, N> operator - (const vector<T, N>& v)
     {
         vector<T, N> r;
         for (unsigned int i = 0; i < N; i++)
@@ -278,7 +275,7 @@ namespace rgm
     }
 
     template <typename T, unsigned int N>
-    vector<T, N> operator + (const vector<T, N>& a, const vector<T, N>& b)
+    constexpr vector<T, N> operator + (const vector<T, N>& a, const vector<T, N>& b)
     {
         vector<T, N> r;
         for (unsigned int i = 0; i < N; i++)
@@ -289,7 +286,7 @@ namespace rgm
     }
     
     template <typename T, unsigned int N>
-    vector<T, N> operator - (const vector<T, N>& a, const vector<T, N>& b)
+    constexpr vector<T, N> operator - (const vector<T, N>& a, const vector<T, N>& b)
     {
         vector<T, N> r;
         for (unsigned int i = 0; i < N; i++)
@@ -299,8 +296,10 @@ namespace rgm
         return r;
     }
 
-    template <typename T, unsigned int N, typename S>
-    vector<T, N> operator * (const vector<T, N>& v, S s)
+    // Only for scalars, so that vectors and expressions get their own
+    // overloads.
+    template <typename T, unsigned int N, typename S, typename = typename std::enable_if<std::is_convertible<S, T>::value>::type>
+    constexpr vector<T, N> operator * (const vector<T, N>& v, S s)
     {
         vector<T, N> r;
         for (unsigned int i = 0; i < N; i++)
@@ -310,8 +309,8 @@ namespace rgm
         return r;
     }
 
-    template <typename T, unsigned int N, typename S>
-    vector<T, N> operator / (const vector<T, N>& v, S s)
+    template <typename T, unsigned int N, typename S, typename = typename std::enable_if<std::is_convertible<S, T>::value>::type>
+    constexpr vector<T, N> operator / (const vector<T, N>& v, S s)
     {
         vector<T, N> r;
         for (unsigned int i = 0; i < N; i++)
@@ -322,7 +321,7 @@ namespace rgm
     }
 
     template <typename T, unsigned int N>
-    vector<T, N> operator * (const vector<T, N>& a, const vector<T, N>& b)
+    constexpr vector<T, N> operator * (const vector<T, N>& a, const vector<T, N>& b)
     {
         vector<T, N> r;
         for (unsigned int i = 0; i < N; i++)
@@ -333,7 +332,7 @@ namespace rgm
     }
 
     template <typename T, unsigned int N>
-    vector<T, N> operator / (const vector<T, N>& a, const vector<T, N>& b)
+    constexpr vector<T, N> operator / (const vector<T, N>& a, const vector<T, N>& b)
     {
         vector<T, N> r;
         for (unsigned int i = 0; i < N; i++)
@@ -344,7 +343,7 @@ namespace rgm
     }
 
     template <typename T, unsigned int N>
-    vector<T, N> operator % (const vector<T, N>& a, const vector<T, N>& b)
+    constexpr vector<T, N> operator % (const vector<T, N>& a, const vector<T, N>& b)
     {
         vector<T, N> r;
         for (unsigned int i = 0; i < N; i++)
@@ -355,7 +354,7 @@ namespace rgm
     }
 
     template <typename T, unsigned int N>
-    T dot(const vector<T, N>& a, const vector<T, N>& b)
+    constexpr T dot(const vector<T, N>& a, const vector<T, N>& b)
     {
         T r = 0;
         
@@ -368,7 +367,7 @@ namespace rgm
     }
     
     template <typename T>
-    vector<T, 3> cross(const vector<T, 3>& a, const vector<T, 3>& b)
+    constexpr vector<T, 3> cross(const vector<T, 3>& a, const vector<T, 3>& b)
     {
         return vector3<T>  ((a[1] * b[2]) - (a[2] * b[1]),
                             (a[2] * b[0]) - (a[0] * b[2]),
@@ -393,8 +392,45 @@ namespace rgm
         return v / length(v);
     }
 
+    // Counterparts of the fast batch functions in stream.h, so that code
+    // can be written the same way for single vectors and streams. A single
+    // vector gains nothing from the hardware estimates: the horizontal sum
+    // dominates and current CPUs take as long for rsqrtss and its
+    // Newton-Raphson step as for sqrtss and divps. These are therefore
+    // exact; like the batch functions and unlike normalize they map the
+    // zero vector to zero.
+    template <typename T>
+    T rcp(T x)
+    {
+        return T(1) / x;
+    }
+
+    template <typename T, unsigned int N>
+    vector<T, N> rcp(const vector<T, N>& v)
+    {
+        return vector<T, N>(T(1)) / v;
+    }
+
     template <typename T, unsigned int N>
-    vector<T, N> min(const vector<T, N>& a, const vector<T, N>& b)
+    T inv_length(const vector<T, N>& v)
+    {
+        return T(1) / std::sqrt(std::max(dot(v, v), std::numeric_limits<T>::min()));
+    }
+
+    template <typename T, unsigned int N>
+    T length_fast(const vector<T, N>& v)
+    {
+        return length(v);
+    }
+
+    template <typename T, unsigned int N>
+    vector<T, N> normalize_fast(const vector<T, N>& v)
+    {
+        return v / std::sqrt(std::max(dot(v, v), std::numeric_limits<T>::min()));
+    }
+
+    template <typename T, unsigned int N>
+    constexpr vector<T, N> min(const vector<T, N>& a, const vector<T, N>& b)
     {
         vector<T, N> r;
 
@@ -407,7 +443,7 @@ namespace rgm
     }
     
     template <typename T, unsigned int N>
-    vector<T, N> min(const vector<T, N>& a, T b)
+    constexpr vector<T, N> min(const vector<T, N>& a, T b)
     {
         vector<T, N> r;
 
@@ -420,7 +456,7 @@ namespace rgm
     }
 
     template <typename T, unsigned int N>
-    T min(const vector<T, N>& v)
+    constexpr T min(const vector<T, N>& v)
     {
         T r = v[0];
 
@@ -433,7 +469,7 @@ namespace rgm
     }
     
     template <typename T, unsigned int N>
-    vector<T, N> max(const vector<T, N>& a, const vector<T, N>& b)
+    constexpr vector<T, N> max(const vector<T, N>& a, const vector<T, N>& b)
     {
         vector<T, N> r;
 
@@ -446,20 +482,20 @@ namespace rgm
     }
     
     template <typename T, unsigned int N>
-    vector<T, N> max(const vector<T, N>& a, float b)
+    constexpr vector<T, N> max(const vector<T, N>& a, float b)
     {
         vector<T, N> r;
 
         for (unsigned int i = 0; i < N; i++)
         {                
-            r[i] = std::max(a[i], b);
+            r[i] = std::max(a[i], static_cast<T>(b));
         } 
         
         return r;
     }
 
     template <typename T, unsigned int N>
-    T max(const vector<T, N>& v)
+    constexpr T max(const vector<T, N>& v)
     {
         T r = v[0];
 
@@ -485,25 +521,25 @@ namespace rgm
     }
     
     template <typename T, unsigned int N>
-    vector<T, N> clamp(const vector<T, N>& a, const vector<T, N>& minVal, const vector<T, N>& maxVal)
+    constexpr vector<T, N> clamp(const vector<T, N>& a, const vector<T, N>& minVal, const vector<T, N>& maxVal)
     {
         return min(max(a, minVal), maxVal);
     }
     
     template <typename T, unsigned int N>
-    vector<T, N> clamp(const vector<T, N>& a, float minVal, float maxVal)
+    constexpr vector<T, N> clamp(const vector<T, N>& a, float minVal, float maxVal)
     {
-        return min(max(a, minVal), maxVal);
+        return min(max(a, minVal), static_cast<T>(maxVal));
     }
     
     template <typename T, unsigned int N>
-    vector<T, N> mix(const vector<T, N>& a, const vector<T, N>& b, const vector<T, N>& wb)
+    constexpr vector<T, N> mix(const vector<T, N>& a, const vector<T, N>& b, const vector<T, N>& wb)
     {
         return a * (vector<T, N>(1.0) - wb) + b * wb;
     }
     
     template <typename T, unsigned int N>
-    vector<T, N> mix(const vector<T, N>& a, const vector<T, N>& b, float wb)
+    constexpr vector<T, N> mix(const vector<T, N>& a, const vector<T, N>& b, float wb)
     {
         return a * vector<T, N>(1.0 - wb) + b * vector<T, N>(wb);
     }
@@ -535,7 +571,7 @@ namespace rgm
     }
     
     template <typename T>
-    T limit(T v, T vmin, T vmax)
+    constexpr T limit(T v, T vmin, T vmax)
     {
         assert(vmin < vmax);
         
@@ -554,7 +590,7 @@ namespace rgm
     }
     
     template <typename T, unsigned int N>
-    vector<T, N> limit(const vector<T, N>& v, T vmin, T vmax)
+    constexpr vector<T, N> limit(const vector<T, N>& v, T vmin, T vmax)
     {
         vector<T, N> r;
 
@@ -607,6 +643,476 @@ namespace rgm
         return true;
     }
 
+#ifdef RGM_SSE2
+    // SIMD versions of the arithmetic for float and double vectors with 2 to
+    // 4 elements. They are picked over the generic loops above, since they
+    // are more specialized, and give the same results; calling the generic
+    // function explicitly, e.g. dot<float, 4>(a, b), still gets the loop.
+    // In constant expressions they defer to the loops (see simd.h).
+
+    template <unsigned int N, typename P = typename simd::packed<float, N>::type>
+    RGM_SIMD_CONSTEXPR vector<float, N> operator - (const vector<float, N>& v)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return operator - <float, N>(v);
+        }
+        typedef simd::packed<float, N> S;
+        vector<float, N> r;
+        S::store(&r[0], simd::neg(S::load(v.c_array())));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<float, N>::type>
+    RGM_SIMD_CONSTEXPR vector<float, N> operator + (const vector<float, N>& a, const vector<float, N>& b)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return operator + <float, N>(a, b);
+        }
+        typedef simd::packed<float, N> S;
+        vector<float, N> r;
+        S::store(&r[0], simd::add(S::load(a.c_array()), S::load(b.c_array())));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<float, N>::type>
+    RGM_SIMD_CONSTEXPR vector<float, N> operator - (const vector<float, N>& a, const vector<float, N>& b)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return operator - <float, N>(a, b);
+        }
+        typedef simd::packed<float, N> S;
+        vector<float, N> r;
+        S::store(&r[0], simd::sub(S::load(a.c_array()), S::load(b.c_array())));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<float, N>::type>
+    RGM_SIMD_CONSTEXPR vector<float, N> operator * (const vector<float, N>& v, float s)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return operator * <float, N, float>(v, s);
+        }
+        typedef simd::packed<float, N> S;
+        vector<float, N> r;
+        S::store(&r[0], simd::mul(S::load(v.c_array()), S::splat(s)));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<float, N>::type>
+    RGM_SIMD_CONSTEXPR vector<float, N> operator / (const vector<float, N>& v, float s)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return operator / <float, N, float>(v, s);
+        }
+        typedef simd::packed<float, N> S;
+        vector<float, N> r;
+        S::store(&r[0], simd::div(S::load(v.c_array()), S::splat(s)));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<float, N>::type>
+    RGM_SIMD_CONSTEXPR vector<float, N> operator * (const vector<float, N>& a, const vector<float, N>& b)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return operator * <float, N>(a, b);
+        }
+        typedef simd::packed<float, N> S;
+        vector<float, N> r;
+        S::store(&r[0], simd::mul(S::load(a.c_array()), S::load(b.c_array())));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<float, N>::type>
+    RGM_SIMD_CONSTEXPR vector<float, N> operator / (const vector<float, N>& a, const vector<float, N>& b)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return operator / <float, N>(a, b);
+        }
+        typedef simd::packed<float, N> S;
+        vector<float, N> r;
+        S::store(&r[0], simd::div(S::load(a.c_array()), S::load(b.c_array())));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<float, N>::type>
+    RGM_SIMD_CONSTEXPR float dot(const vector<float, N>& a, const vector<float, N>& b)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return dot<float, N>(a, b);
+        }
+        typedef simd::packed<float, N> S;
+        return simd::sum(simd::mul(S::load(a.c_array()), S::load(b.c_array())), N);
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<float, N>::type>
+    vector<float, N> normalize(const vector<float, N>& v)
+    {
+        typedef simd::packed<float, N> S;
+        P x = S::load(v.c_array());
+        float l = std::sqrt(simd::sum(simd::mul(x, x), N));
+        vector<float, N> r;
+        S::store(&r[0], simd::div(x, S::splat(l)));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<float, N>::type>
+    RGM_SIMD_CONSTEXPR vector<float, N> min(const vector<float, N>& a, const vector<float, N>& b)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return min<float, N>(a, b);
+        }
+        typedef simd::packed<float, N> S;
+        vector<float, N> r;
+        S::store(&r[0], simd::min(S::load(a.c_array()), S::load(b.c_array())));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<float, N>::type>
+    RGM_SIMD_CONSTEXPR vector<float, N> min(const vector<float, N>& a, float b)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return min<float, N>(a, b);
+        }
+        typedef simd::packed<float, N> S;
+        vector<float, N> r;
+        S::store(&r[0], simd::min(S::load(a.c_array()), S::splat(b)));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<float, N>::type>
+    RGM_SIMD_CONSTEXPR vector<float, N> max(const vector<float, N>& a, const vector<float, N>& b)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return max<float, N>(a, b);
+        }
+        typedef simd::packed<float, N> S;
+        vector<float, N> r;
+        S::store(&r[0], simd::max(S::load(a.c_array()), S::load(b.c_array())));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<float, N>::type>
+    RGM_SIMD_CONSTEXPR vector<float, N> max(const vector<float, N>& a, float b)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return max<float, N>(a, vector<float, N>(b));
+        }
+        typedef simd::packed<float, N> S;
+        vector<float, N> r;
+        S::store(&r[0], simd::max(S::load(a.c_array()), S::splat(b)));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<float, N>::type>
+    RGM_SIMD_CONSTEXPR vector<float, N> clamp(const vector<float, N>& a, const vector<float, N>& minVal, const vector<float, N>& maxVal)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return clamp<float, N>(a, minVal, maxVal);
+        }
+        typedef simd::packed<float, N> S;
+        vector<float, N> r;
+        S::store(&r[0], simd::min(simd::max(S::load(a.c_array()), S::load(minVal.c_array())), S::load(maxVal.c_array())));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<float, N>::type>
+    RGM_SIMD_CONSTEXPR vector<float, N> clamp(const vector<float, N>& a, float minVal, float maxVal)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return clamp<float, N>(a, vector<float, N>(minVal), vector<float, N>(maxVal));
+        }
+        typedef simd::packed<float, N> S;
+        vector<float, N> r;
+        S::store(&r[0], simd::min(simd::max(S::load(a.c_array()), S::splat(minVal)), S::splat(maxVal)));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<float, N>::type>
+    RGM_SIMD_CONSTEXPR vector<float, N> mix(const vector<float, N>& a, const vector<float, N>& b, const vector<float, N>& wb)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return mix<float, N>(a, b, wb);
+        }
+        typedef simd::packed<float, N> S;
+        P w = S::load(wb.c_array());
+        P x = simd::mul(S::load(a.c_array()), simd::sub(S::splat(1), w));
+        P y = simd::mul(S::load(b.c_array()), w);
+        vector<float, N> r;
+        S::store(&r[0], simd::add(x, y));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<float, N>::type>
+    RGM_SIMD_CONSTEXPR vector<float, N> mix(const vector<float, N>& a, const vector<float, N>& b, float wb)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return mix<float, N>(a, b, vector<float, N>(wb));
+        }
+        typedef simd::packed<float, N> S;
+        P x = simd::mul(S::load(a.c_array()), S::splat(1 - wb));
+        P y = simd::mul(S::load(b.c_array()), S::splat(wb));
+        vector<float, N> r;
+        S::store(&r[0], simd::add(x, y));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<float, N>::type>
+    vector<float, N> abs(const vector<float, N>& v)
+    {
+        typedef simd::packed<float, N> S;
+        vector<float, N> r;
+        S::store(&r[0], simd::abs(S::load(v.c_array())));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<double, N>::type>
+    RGM_SIMD_CONSTEXPR vector<double, N> operator - (const vector<double, N>& v)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return operator - <double, N>(v);
+        }
+        typedef simd::packed<double, N> S;
+        vector<double, N> r;
+        S::store(&r[0], simd::neg(S::load(v.c_array())));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<double, N>::type>
+    RGM_SIMD_CONSTEXPR vector<double, N> operator + (const vector<double, N>& a, const vector<double, N>& b)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return operator + <double, N>(a, b);
+        }
+        typedef simd::packed<double, N> S;
+        vector<double, N> r;
+        S::store(&r[0], simd::add(S::load(a.c_array()), S::load(b.c_array())));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<double, N>::type>
+    RGM_SIMD_CONSTEXPR vector<double, N> operator - (const vector<double, N>& a, const vector<double, N>& b)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return operator - <double, N>(a, b);
+        }
+        typedef simd::packed<double, N> S;
+        vector<double, N> r;
+        S::store(&r[0], simd::sub(S::load(a.c_array()), S::load(b.c_array())));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<double, N>::type>
+    RGM_SIMD_CONSTEXPR vector<double, N> operator * (const vector<double, N>& v, double s)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return operator * <double, N, double>(v, s);
+        }
+        typedef simd::packed<double, N> S;
+        vector<double, N> r;
+        S::store(&r[0], simd::mul(S::load(v.c_array()), S::splat(s)));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<double, N>::type>
+    RGM_SIMD_CONSTEXPR vector<double, N> operator / (const vector<double, N>& v, double s)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return operator / <double, N, double>(v, s);
+        }
+        typedef simd::packed<double, N> S;
+        vector<double, N> r;
+        S::store(&r[0], simd::div(S::load(v.c_array()), S::splat(s)));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<double, N>::type>
+    RGM_SIMD_CONSTEXPR vector<double, N> operator * (const vector<double, N>& a, const vector<double, N>& b)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return operator * <double, N>(a, b);
+        }
+        typedef simd::packed<double, N> S;
+        vector<double, N> r;
+        S::store(&r[0], simd::mul(S::load(a.c_array()), S::load(b.c_array())));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<double, N>::type>
+    RGM_SIMD_CONSTEXPR vector<double, N> operator / (const vector<double, N>& a, const vector<double, N>& b)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return operator / <double, N>(a, b);
+        }
+        typedef simd::packed<double, N> S;
+        vector<double, N> r;
+        S::store(&r[0], simd::div(S::load(a.c_array()), S::load(b.c_array())));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<double, N>::type>
+    RGM_SIMD_CONSTEXPR double dot(const vector<double, N>& a, const vector<double, N>& b)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return dot<double, N>(a, b);
+        }
+        typedef simd::packed<double, N> S;
+        return simd::sum(simd::mul(S::load(a.c_array()), S::load(b.c_array())), N);
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<double, N>::type>
+    vector<double, N> normalize(const vector<double, N>& v)
+    {
+        typedef simd::packed<double, N> S;
+        P x = S::load(v.c_array());
+        double l = std::sqrt(simd::sum(simd::mul(x, x), N));
+        vector<double, N> r;
+        S::store(&r[0], simd::div(x, S::splat(l)));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<double, N>::type>
+    RGM_SIMD_CONSTEXPR vector<double, N> min(const vector<double, N>& a, const vector<double, N>& b)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return min<double, N>(a, b);
+        }
+        typedef simd::packed<double, N> S;
+        vector<double, N> r;
+        S::store(&r[0], simd::min(S::load(a.c_array()), S::load(b.c_array())));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<double, N>::type>
+    RGM_SIMD_CONSTEXPR vector<double, N> min(const vector<double, N>& a, double b)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return min<double, N>(a, b);
+        }
+        typedef simd::packed<double, N> S;
+        vector<double, N> r;
+        S::store(&r[0], simd::min(S::load(a.c_array()), S::splat(b)));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<double, N>::type>
+    RGM_SIMD_CONSTEXPR vector<double, N> max(const vector<double, N>& a, const vector<double, N>& b)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return max<double, N>(a, b);
+        }
+        typedef simd::packed<double, N> S;
+        vector<double, N> r;
+        S::store(&r[0], simd::max(S::load(a.c_array()), S::load(b.c_array())));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<double, N>::type>
+    RGM_SIMD_CONSTEXPR vector<double, N> max(const vector<double, N>& a, double b)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return max<double, N>(a, vector<double, N>(b));
+        }
+        typedef simd::packed<double, N> S;
+        vector<double, N> r;
+        S::store(&r[0], simd::max(S::load(a.c_array()), S::splat(b)));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<double, N>::type>
+    RGM_SIMD_CONSTEXPR vector<double, N> clamp(const vector<double, N>& a, const vector<double, N>& minVal, const vector<double, N>& maxVal)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return clamp<double, N>(a, minVal, maxVal);
+        }
+        typedef simd::packed<double, N> S;
+        vector<double, N> r;
+        S::store(&r[0], simd::min(simd::max(S::load(a.c_array()), S::load(minVal.c_array())), S::load(maxVal.c_array())));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<double, N>::type>
+    RGM_SIMD_CONSTEXPR vector<double, N> clamp(const vector<double, N>& a, double minVal, double maxVal)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return clamp<double, N>(a, vector<double, N>(minVal), vector<double, N>(maxVal));
+        }
+        typedef simd::packed<double, N> S;
+        vector<double, N> r;
+        S::store(&r[0], simd::min(simd::max(S::load(a.c_array()), S::splat(minVal)), S::splat(maxVal)));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<double, N>::type>
+    RGM_SIMD_CONSTEXPR vector<double, N> mix(const vector<double, N>& a, const vector<double, N>& b, const vector<double, N>& wb)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return mix<double, N>(a, b, wb);
+        }
+        typedef simd::packed<double, N> S;
+        P w = S::load(wb.c_array());
+        P x = simd::mul(S::load(a.c_array()), simd::sub(S::splat(1), w));
+        P y = simd::mul(S::load(b.c_array()), w);
+        vector<double, N> r;
+        S::store(&r[0], simd::add(x, y));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<double, N>::type>
+    RGM_SIMD_CONSTEXPR vector<double, N> mix(const vector<double, N>& a, const vector<double, N>& b, double wb)
+    {
+        if (RGM_CONSTANT_EVALUATED())
+        {
+            return mix<double, N>(a, b, vector<double, N>(wb));
+        }
+        typedef simd::packed<double, N> S;
+        P x = simd::mul(S::load(a.c_array()), S::splat(1 - wb));
+        P y = simd::mul(S::load(b.c_array()), S::splat(wb));
+        vector<double, N> r;
+        S::store(&r[0], simd::add(x, y));
+        return r;
+    }
+
+    template <unsigned int N, typename P = typename simd::packed<double, N>::type>
+    vector<double, N> abs(const vector<double, N>& v)
+    {
+        typedef simd::packed<double, N> S;
+        vector<double, N> r;
+        S::store(&r[0], simd::abs(S::load(v.c_array())));
+        return r;
+    }
+#endif
+
     template <typename T, unsigned int N>
     std::ostream& operator << (std::ostream& os, const vector<T, N>& v)
     {
@@ -642,6 +1148,11 @@ namespace rgm
     typedef vector2<double> dvec2;
     typedef vector3<double> dvec3;
     typedef vector4<double> dvec4;
+
+    // Arrays of vectors can be copied with memcpy and passed to C APIs.
+    static_assert(std::is_trivially_copyable<vec3>::value && std::is_trivially_copyable<dvec4>::value, "vectors must be trivially copyable");
+    static_assert(std::is_standard_layout<vec3>::value && std::is_standard_layout<dvec4>::value, "vectors must be standard layout");
+    static_assert(sizeof(vec3) == 3 * sizeof(float) && sizeof(dvec4) == 4 * sizeof(double), "vectors must not be padded");
 }
 
 #endif